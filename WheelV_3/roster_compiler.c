@@ -0,0 +1,441 @@
+/**********************************************************************/
+/*                                                                    */
+/* Program Name: Roster Compiler - Build step for the Wheel           */
+/* Author:       Dudwen                                               */
+/* Date Written: October 19, 2026                                     */
+/*                                                                    */
+/**********************************************************************/
+
+/**********************************************************************/
+/*                                                                    */
+/* This program compiles the published spreadsheet (saved as a CSV)   */
+/* into a header of const tables, so the Wheel's offline fallback     */
+/* roster loads without parsing anything and always matches the       */
+/* sheet. The cells are read by wheel_csv.h, the same tokenizer the   */
+/* Wheel reads its downloads with. Run it before building the Wheel   */
+/* whenever the sheet changes:                                        */
+/*                                                                    */
+/*    gcc -o roster_compiler roster_compiler.c                        */
+/*    roster_compiler wheel_csv.txt wheel_roster.h                    */
+/*                                                                    */
+/* With --check first it writes nothing, and fails with STALE_ERR if  */
+/* the header is not what the sheet compiles to, so a build can stop  */
+/* on a stale roster instead of shipping it:                          */
+/*                                                                    */
+/*    roster_compiler --check wheel_csv.txt wheel_roster.h            */
+/*                                                                    */
+/**********************************************************************/
+
+#include <stdio.h>  /* Printf and File stuff                          */
+#include <stdlib.h> /* Malloc and free                                */
+#include <ctype.h>  /* Is print                                       */
+#include <string.h> /* For strlen                                     */
+#include "wheel_csv.h" /* Sheet tokenizer shared with the Wheel       */
+
+/**********************************************************************/
+/*                         Symbolic Constants                         */
+/**********************************************************************/
+#define PROGRAM_NAME      "Roster Compiler"
+                                   /* The program's name              */
+#define MAX_GAMES         1000000  /* Max amount of games in a list   */
+#define MAX_PLAYERS       1024     /* Max amount of players in a list */
+#define MAX_GAME_NAME     25       /* Max length of a game's name     */
+#define MAX_PLAYER_NAME   20       /* Max length of a players's name  */
+#define TABLE_COLUMNS     72       /* Width a table line wraps at     */
+#define USAGE_ERR         1        /* Wrong arguments error           */
+#define SHEET_ERR         2        /* Sheet cannot be read error      */
+#define OUTPUT_ERR        3        /* Header cannot be written error  */
+#define STALE_ERR         4        /* Header does not match the sheet */
+
+/**********************************************************************/
+/*                         Program Structures                         */
+/**********************************************************************/
+/* Roster read from the sheet                                         */
+struct compiled_roster
+{
+   int  player_count,                  /* Players in the roster       */
+        game_count,                    /* Games in the roster         */
+        *p_limits;                     /* Each game's player limit    */
+   char (*p_player_names)[MAX_PLAYER_NAME]; /* Each player's name     */
+   char (*p_game_names)[MAX_GAME_NAME];     /* Each game's name       */
+   char *p_status_rows;                /* One y/n/d row per game      */
+};
+typedef struct compiled_roster COMPILED_ROSTER;
+
+/**********************************************************************/
+/*                        Function Prototypes                         */
+/**********************************************************************/
+int  compile_sheet(CSV_INDEX *p_csv, COMPILED_ROSTER *p_roster);
+   /* Read the sheet's players and games                              */
+int  write_header(COMPILED_ROSTER *p_roster, const char *sheet_name,
+                  FILE *p_output);
+   /* Write the roster as const tables                                */
+int  same_contents(FILE *p_first, FILE *p_second);
+   /* Check if two files hold the same text, whatever line endings    */
+int  write_string(FILE *p_output, const char *p_text, int length,
+                  int column);
+   /* Write a C string literal, returns the column after it           */
+void free_compiled(COMPILED_ROSTER *p_roster);
+   /* Free a compiled roster                                          */
+
+/**********************************************************************/
+/*                           Main Function                            */
+/**********************************************************************/
+int main(int argc, char *argv[])
+{
+   COMPILED_ROSTER roster; /* Roster read from the sheet              */
+   CSV_INDEX       csv;    /* Sheet and its structural index          */
+   FILE            *p_output,   /* Header being written               */
+                   *p_existing; /* Header already on disk             */
+   char            *p_data, /* Sheet's bytes                          */
+                   *sheet_name,  /* Sheet to compile                  */
+                   *header_name; /* Header to write or check          */
+   size_t          length; /* Bytes in the sheet                      */
+   int             compiled_ok, /* The sheet held a roster            */
+                   check,       /* Only compare with the header       */
+                   same;        /* Header matches the sheet           */
+
+   check = argc == 4 && strcmp(argv[1], "--check") == 0;
+   if (argc != 3 && !check)
+   {
+      fprintf(stderr, "Usage: %s [--check] <sheet.csv> <roster.h>\n",
+              argv[0]);
+      return USAGE_ERR;
+   }
+   sheet_name  = argv[argc - 2];
+   header_name = argv[argc - 1];
+
+   p_data = read_whole_file(sheet_name, &length);
+   if (p_data == NULL || !build_csv_index(&csv, p_data, length))
+   {
+      fprintf(stderr, "%s: Cannot read %s\n", PROGRAM_NAME, sheet_name);
+      free(p_data);
+      return SHEET_ERR;
+   }
+   compiled_ok = compile_sheet(&csv, &roster);
+   free(csv.p_structurals);
+   free(p_data);
+   if (!compiled_ok)
+   {
+      fprintf(stderr, "%s: %s has no players or games\n", PROGRAM_NAME,
+              sheet_name);
+      return SHEET_ERR;
+   }
+
+   /* A check compiles into a scratch file and compares it with the   */
+   /* header, so it fails on any change the header would have had     */
+   p_output = check ? tmpfile() : fopen(header_name, "w");
+   if (p_output == NULL || !write_header(&roster, sheet_name, p_output))
+   {
+      fprintf(stderr, "%s: Cannot write %s\n", PROGRAM_NAME,
+              check ? "a scratch file" : header_name);
+      if (p_output != NULL)
+         fclose(p_output);
+      free_compiled(&roster);
+      return OUTPUT_ERR;
+   }
+
+   if (check)
+   {
+      p_existing = fopen(header_name, "r");
+      rewind(p_output);
+      same = p_existing != NULL && same_contents(p_output, p_existing);
+      fclose(p_output);
+      if (p_existing != NULL)
+         fclose(p_existing);
+      free_compiled(&roster);
+      if (!same)
+      {
+         fprintf(stderr, "%s: %s is stale, run %s %s %s\n",
+                 PROGRAM_NAME, header_name, argv[0], sheet_name,
+                 header_name);
+         return STALE_ERR;
+      }
+      printf("%s: %s matches %s\n", PROGRAM_NAME, header_name,
+             sheet_name);
+      return 0;
+   }
+
+   if (fclose(p_output) != 0)
+   {
+      fprintf(stderr, "%s: Cannot write %s\n", PROGRAM_NAME, header_name);
+      free_compiled(&roster);
+      return OUTPUT_ERR;
+   }
+   printf("%s: %d players and %d games written to %s\n", PROGRAM_NAME,
+          roster.player_count, roster.game_count, header_name);
+   free_compiled(&roster);
+
+   return 0;
+}
+
+/**********************************************************************/
+/*                  Read the sheet's players and games                */
+/**********************************************************************/
+int compile_sheet(CSV_INDEX *p_csv, COMPILED_ROSTER *p_roster)
+{
+   CSV_FIELD field;        /* Cell being read                          */
+   char *p_row;            /* Status row being written                 */
+   int  player_count,      /* Players the header promises              */
+        game_count,        /* Games the header promises                */
+        player_counter,    /* Count through players                    */
+        game_counter = 0,  /* Games read so far                        */
+        terminator;        /* What ended the last cell                 */
+
+   memset(p_roster, 0, sizeof(COMPILED_ROSTER));
+
+   /* Skip first line (headers: "Player Count,Game Count,,,," )       */
+   csv_skip_line(p_csv, ',');
+
+   /* Read second line with counts                                    */
+   terminator = csv_next_field(p_csv, &field);
+   if (terminator != ',' || !csv_field_number(&field, &player_count) ||
+       (terminator = csv_next_field(p_csv, &field)) == 0 ||
+       !csv_field_number(&field, &game_count) ||
+       player_count < 1 || player_count > MAX_PLAYERS ||
+       game_count   < 1 || game_count   > MAX_GAMES)
+      return 0;
+   csv_skip_line(p_csv, terminator);
+
+   p_roster->p_player_names = calloc(player_count, MAX_PLAYER_NAME);
+   p_roster->p_game_names   = calloc(game_count, MAX_GAME_NAME);
+   p_roster->p_limits       = calloc(game_count, sizeof(int));
+   p_roster->p_status_rows  = malloc((size_t) game_count *
+                                     (player_count + 1));
+   if (p_roster->p_player_names == NULL ||
+       p_roster->p_game_names   == NULL ||
+       p_roster->p_limits       == NULL ||
+       p_roster->p_status_rows  == NULL)
+   {
+      free_compiled(p_roster);
+      return 0;
+   }
+
+   /* Read third line and extract player names                        */
+   terminator = csv_next_field(p_csv, &field); /* "Player Limit"  */
+   if (terminator == ',')
+      terminator = csv_next_field(p_csv, &field); /* "Game"       */
+   for (player_counter = 0;
+        player_counter < player_count;
+        player_counter++)
+   {
+      if (terminator == ',')
+         terminator = csv_next_field(p_csv, &field);
+      else
+         field.length = 0;
+      if (csv_copy_field(&field,
+                         p_roster->p_player_names[player_counter],
+                         MAX_PLAYER_NAME) == 0)
+         snprintf(p_roster->p_player_names[player_counter],
+                  MAX_PLAYER_NAME, "Player%d", player_counter + 1);
+   }
+   csv_skip_line(p_csv, terminator);
+
+   /* Read each game row, skipping blank lines, until the header's    */
+   /* game count is reached                                           */
+   while (p_csv->cursor < p_csv->length && game_counter < game_count)
+   {
+      terminator = csv_next_field(p_csv, &field);
+      if (terminator != ',' && field.length == 0)
+         continue;
+      if (!csv_field_number(&field, &p_roster->p_limits[game_counter]))
+         p_roster->p_limits[game_counter] = 0;
+      if (terminator == ',')
+         terminator = csv_next_field(p_csv, &field);
+      else
+         field.length = 0;
+      if (csv_copy_field(&field, p_roster->p_game_names[game_counter],
+                         MAX_GAME_NAME) == 0)
+         strcpy(p_roster->p_game_names[game_counter], "Unnamed");
+
+      /* Each player's status is the first letter of their cell, and  */
+      /* a missing cell means they don't have the game                */
+      p_row = p_roster->p_status_rows +
+              (size_t) game_counter * (player_count + 1);
+      for (player_counter = 0;
+           player_counter < player_count;
+           player_counter++)
+      {
+         if (terminator == ',')
+            terminator = csv_next_field(p_csv, &field);
+         else
+            field.length = 0;
+         p_row[player_counter] = field.length > 0 ? field.p_start[0] :
+                                                    'n';
+      }
+      p_row[player_count] = '\0';
+      game_counter++;
+
+      csv_skip_line(p_csv, terminator);
+   }
+
+   p_roster->player_count = player_count;
+   p_roster->game_count   = game_counter;
+   if (game_counter == 0)
+   {
+      free_compiled(p_roster);
+      return 0;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                   Write the roster as const tables                 */
+/**********************************************************************/
+int write_header(COMPILED_ROSTER *p_roster, const char *sheet_name,
+                 FILE *p_output)
+{
+   int  player_counter,  /* Count through players                      */
+        game_counter,    /* Count through games                        */
+        column;          /* Column the next table entry starts at      */
+
+   fprintf(p_output,
+   "/****************************************************************"
+   "******/\n"
+   "/*                                                               "
+   "     */\n"
+   "/* Generated by roster_compiler from %-32s */\n"
+   "/* Do not edit, rebuild it from the sheet instead.               "
+   "     */\n"
+   "/*                                                               "
+   "     */\n"
+   "/****************************************************************"
+   "******/\n", sheet_name);
+   fprintf(p_output, "#define ROSTER_PLAYERS    %-8d "
+                     "/* Players in the fallback roster  */\n",
+           p_roster->player_count);
+   fprintf(p_output, "#define ROSTER_GAMES      %-8d "
+                     "/* Games in the fallback roster    */\n\n",
+           p_roster->game_count);
+
+   /* Names are padded out to the Wheel's own name fields             */
+   fprintf(p_output, "static const char roster_player_names"
+                     "[ROSTER_PLAYERS][MAX_PLAYER_NAME] =\n{\n");
+   for (player_counter = 0;
+        player_counter < p_roster->player_count;
+        player_counter++)
+   {
+      fprintf(p_output, "   ");
+      write_string(p_output, p_roster->p_player_names[player_counter],
+                   (int) strlen(p_roster->p_player_names[player_counter]),
+                   3);
+      fprintf(p_output, ",\n");
+   }
+   fprintf(p_output, "};\n\n");
+
+   fprintf(p_output, "static const char roster_game_names"
+                     "[ROSTER_GAMES][MAX_GAME_NAME] =\n{\n");
+   for (game_counter = 0;
+        game_counter < p_roster->game_count;
+        game_counter++)
+   {
+      fprintf(p_output, "   ");
+      write_string(p_output, p_roster->p_game_names[game_counter],
+                   (int) strlen(p_roster->p_game_names[game_counter]), 3);
+      fprintf(p_output, ",\n");
+   }
+   fprintf(p_output, "};\n\n");
+
+   fprintf(p_output, "static const int roster_player_limits"
+                     "[ROSTER_GAMES] =\n{\n  ");
+   column = 2;
+   for (game_counter = 0;
+        game_counter < p_roster->game_count;
+        game_counter++)
+   {
+      if (column > TABLE_COLUMNS)
+      {
+         fprintf(p_output, "\n  ");
+         column = 2;
+      }
+      column += fprintf(p_output, " %d,",
+                        p_roster->p_limits[game_counter]);
+   }
+   fprintf(p_output, "\n};\n\n");
+
+   /* Each status row ends in a zero byte, so the Wheel hands it to   */
+   /* set_owner_bits just like a row read from the game file          */
+   fprintf(p_output, "static const char roster_status_rows"
+                     "[ROSTER_GAMES * (ROSTER_PLAYERS + 1) + 1] =\n");
+   for (game_counter = 0;
+        game_counter < p_roster->game_count;
+        game_counter++)
+   {
+      fprintf(p_output, "   ");
+      write_string(p_output, p_roster->p_status_rows +
+                   (size_t) game_counter * (p_roster->player_count + 1),
+                   p_roster->player_count + 1, 3);
+      fprintf(p_output, game_counter + 1 < p_roster->game_count ?
+                        "\n" : ";\n");
+   }
+
+   fflush(p_output);
+
+   return !ferror(p_output);
+}
+
+/**********************************************************************/
+/*       Check if two files hold the same text, whatever line endings */
+/**********************************************************************/
+int same_contents(FILE *p_first, FILE *p_second)
+{
+   int first,  /* Character read from the first file                  */
+       second; /* Character read from the second file                 */
+
+   /* Carriage returns are skipped, so a header checked out with      */
+   /* Windows line endings still matches what the compiler writes     */
+   do
+   {
+      do
+         first = fgetc(p_first);
+      while (first == '\r');
+      do
+         second = fgetc(p_second);
+      while (second == '\r');
+      if (first != second)
+         return 0;
+   } while (first != EOF);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*          Write a C string literal, returns the column after it     */
+/**********************************************************************/
+int write_string(FILE *p_output, const char *p_text, int length,
+                 int column)
+{
+   int byte; /* Count through each byte of the text                   */
+
+   column += fprintf(p_output, "\"");
+   for (byte = 0; byte < length; byte++)
+   {
+      /* Long rows are split into literals the compiler joins back    */
+      if (column > TABLE_COLUMNS)
+         column = fprintf(p_output, "\"\n   \"");
+      if (p_text[byte] == '"' || p_text[byte] == '\\')
+         column += fprintf(p_output, "\\%c", p_text[byte]);
+      else if (isprint((unsigned char) p_text[byte]))
+         column += fprintf(p_output, "%c", p_text[byte]);
+      else
+         column += fprintf(p_output, "\\%03o", (unsigned char) p_text[byte]);
+   }
+   column += fprintf(p_output, "\"");
+
+   return column;
+}
+
+/**********************************************************************/
+/*                       Free a compiled roster                       */
+/**********************************************************************/
+void free_compiled(COMPILED_ROSTER *p_roster)
+{
+   free(p_roster->p_player_names);
+   free(p_roster->p_game_names);
+   free(p_roster->p_limits);
+   free(p_roster->p_status_rows);
+   memset(p_roster, 0, sizeof(COMPILED_ROSTER));
+
+   return;
+}
@@ -0,0 +1,448 @@
+/**********************************************************************/
+/*                                                                    */
+/* CSV tokenizer shared by the Wheel and the Roster Compiler          */
+/*                                                                    */
+/**********************************************************************/
+
+/**********************************************************************/
+/*                                                                    */
+/* Both programs read the published sheet with these routines, so a  */
+/* cell means the same thing to the compiled fallback roster as it    */
+/* does to a live download. The functions are defined here, so each   */
+/* program includes this header once and builds from its one file.    */
+/* They are all static, so each program gets its own private copy and */
+/* none of their names can clash with the program's own.              */
+/*                                                                    */
+/**********************************************************************/
+
+#ifndef WHEEL_CSV_H
+#define WHEEL_CSV_H
+
+#include <stdio.h>  /* File stuff and sscanf                          */
+#include <stdlib.h> /* Malloc and free                                */
+#include <ctype.h>  /* Is space                                       */
+#include <string.h> /* For memcpy                                     */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h> /* SSE2 and AVX2 for the CSV tokenizer         */
+#define CSV_SIMD          1        /* Vector CSV scanning is built in */
+#endif
+
+/**********************************************************************/
+/*                         Symbolic Constants                         */
+/**********************************************************************/
+#define CSV_PADDING       64       /* Zero bytes after a loaded sheet */
+                                   /* so vector loads never overrun   */
+#define MAX_NUMBER_FIELD  16       /* Max digits read from a cell     */
+#ifdef __GNUC__
+#define CSV_FUNCTION      static __attribute__((unused))
+                                   /* Private to the program, and not */
+                                   /* every program calls every one   */
+#else
+#define CSV_FUNCTION      static   /* Private to the program          */
+#endif
+
+/**********************************************************************/
+/*                         Program Structures                         */
+/**********************************************************************/
+/* Sheet in memory with the position of every comma, quote and newline*/
+struct csv_index
+{
+   const char   *p_data;              /* Whole sheet, zero padded     */
+   size_t       length,               /* Bytes in the sheet           */
+                structural_count,     /* Positions found              */
+                next_structural,      /* First position not yet used  */
+                cursor;               /* Start of the next field      */
+   unsigned int *p_structurals;       /* Comma, quote and newline     */
+                                      /* positions, in order          */
+};
+typedef struct csv_index CSV_INDEX;
+
+/* One cell of the sheet, still pointing into the sheet's bytes       */
+struct csv_field
+{
+   const char *p_start;               /* First byte of the cell       */
+   int        length,                 /* Bytes in the cell            */
+              quoted;                 /* Cell was in quotes, so ""    */
+                                      /* stands for one quote         */
+};
+typedef struct csv_field CSV_FIELD;
+
+/**********************************************************************/
+/*                        Function Prototypes                         */
+/**********************************************************************/
+CSV_FUNCTION
+char *read_whole_file(const char *file_name, size_t *p_length);
+   /* Read a file into memory with CSV_PADDING zero bytes after it    */
+CSV_FUNCTION
+int  build_csv_index(CSV_INDEX *p_index, const char *p_data, size_t length);
+   /* Find every comma, quote and newline in a sheet                  */
+CSV_FUNCTION
+size_t csv_index_scalar(const char   *p_data,
+                        size_t       start,
+                        size_t       length,
+                        unsigned int *p_structurals);
+   /* Find structural characters a byte at a time                     */
+#ifdef CSV_SIMD
+CSV_FUNCTION
+__attribute__((target("sse2")))
+size_t csv_index_sse2(const char   *p_data,
+                      size_t       length,
+                      unsigned int *p_structurals);
+   /* Find structural characters 32 bytes at a time                   */
+CSV_FUNCTION
+__attribute__((target("avx2")))
+size_t csv_index_avx2(const char   *p_data,
+                      size_t       length,
+                      unsigned int *p_structurals);
+   /* Find structural characters 64 bytes at a time                   */
+#endif
+CSV_FUNCTION
+int  csv_next_field(CSV_INDEX *p_index, CSV_FIELD *p_field);
+   /* Get the next cell, returns what ended it: ',', '\n' or 0 at end */
+CSV_FUNCTION
+int  csv_skip_line(CSV_INDEX *p_index, int terminator);
+   /* Skip the rest of the line the last cell was on                  */
+CSV_FUNCTION
+int  csv_copy_field(CSV_FIELD *p_field, char *p_text, int text_size);
+   /* Copy a cell as one word, returns its length                     */
+CSV_FUNCTION
+int  csv_field_number(CSV_FIELD *p_field, int *p_number);
+   /* Read a cell as a whole number, returns 1 if it was one          */
+CSV_FUNCTION
+size_t csv_skip_rows(const char *p_data,
+                     size_t     start,
+                     size_t     length,
+                     int        rows,
+                     int        in_quotes);
+   /* Find where a row ends, counting only newlines outside quotes    */
+
+/**********************************************************************/
+/*       Read a file into memory with CSV_PADDING zero bytes after it */
+/**********************************************************************/
+CSV_FUNCTION
+char *read_whole_file(const char *file_name, size_t *p_length)
+{
+   FILE *p_file;   /* File being read                                 */
+   char *p_data;   /* File's bytes                                    */
+   long length;    /* Size of the file                                */
+
+   p_file = fopen(file_name, "rb");
+   if (p_file == NULL)
+      return NULL;
+   if (fseek(p_file, 0, SEEK_END) != 0 || (length = ftell(p_file)) < 0 ||
+       fseek(p_file, 0, SEEK_SET) != 0 ||
+       (unsigned long) length >= 0xFFFFFFFFUL - CSV_PADDING)
+   {
+      fclose(p_file);
+      return NULL;
+   }
+
+   p_data = (char *) malloc((size_t) length + CSV_PADDING);
+   if (p_data != NULL)
+   {
+      *p_length = fread(p_data, 1, (size_t) length, p_file);
+      memset(p_data + *p_length, 0, CSV_PADDING);
+   }
+   fclose(p_file);
+
+   return p_data;
+}
+
+/**********************************************************************/
+/*               Find every comma, quote and newline in a sheet       */
+/**********************************************************************/
+CSV_FUNCTION
+int build_csv_index(CSV_INDEX *p_index, const char *p_data, size_t length)
+{
+   p_index->p_data           = p_data;
+   p_index->length           = length;
+   p_index->structural_count = 0;
+   p_index->next_structural  = 0;
+   p_index->cursor           = 0;
+
+   /* Every byte could be a separator, plus one for the end mark      */
+   p_index->p_structurals = (unsigned int *) malloc(sizeof(unsigned int) *
+                                                    (length + 1));
+   if (p_index->p_structurals == NULL)
+      return 0;
+
+   /* Use the widest vectors this processor has                       */
+#ifdef CSV_SIMD
+   if (__builtin_cpu_supports("avx2"))
+      p_index->structural_count = csv_index_avx2(p_data, length,
+                                                 p_index->p_structurals);
+   else if (__builtin_cpu_supports("sse2"))
+      p_index->structural_count = csv_index_sse2(p_data, length,
+                                                 p_index->p_structurals);
+   else
+#endif
+      p_index->structural_count = csv_index_scalar(p_data, 0, length,
+                                                   p_index->p_structurals);
+
+   /* The end of the sheet ends the last cell like a newline would    */
+   p_index->p_structurals[p_index->structural_count] = (unsigned int) length;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                Find structural characters a byte at a time         */
+/**********************************************************************/
+CSV_FUNCTION
+size_t csv_index_scalar(const char   *p_data,
+                        size_t       start,
+                        size_t       length,
+                        unsigned int *p_structurals)
+{
+   size_t count = 0, /* Positions found                               */
+          byte;      /* Count through each byte                       */
+
+   for (byte = start; byte < length; byte++)
+      if (p_data[byte] == ',' || p_data[byte] == '\n' || p_data[byte] == '"')
+         p_structurals[count++] = (unsigned int) byte;
+
+   return count;
+}
+
+#ifdef CSV_SIMD
+/**********************************************************************/
+/*               Find structural characters 32 bytes at a time        */
+/**********************************************************************/
+CSV_FUNCTION
+__attribute__((target("sse2")))
+size_t csv_index_sse2(const char   *p_data,
+                      size_t       length,
+                      unsigned int *p_structurals)
+{
+   __m128i   commas   = _mm_set1_epi8(','),  /* Compared 16 at a time */
+             newlines = _mm_set1_epi8('\n'),
+             quotes   = _mm_set1_epi8('"'),
+             low,                            /* First 16 bytes        */
+             high;                           /* Second 16 bytes       */
+   unsigned int mask;                        /* Bit set per separator */
+   size_t    count = 0,                      /* Positions found       */
+             block;                          /* Start of each 32 bytes*/
+
+   for (block = 0; block + 32 <= length; block += 32)
+   {
+      low  = _mm_loadu_si128((const __m128i *) (p_data + block));
+      high = _mm_loadu_si128((const __m128i *) (p_data + block + 16));
+      mask = (unsigned int) _mm_movemask_epi8(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(low, commas),
+                                          _mm_cmpeq_epi8(low, newlines)),
+                             _mm_cmpeq_epi8(low, quotes))) |
+             (unsigned int) _mm_movemask_epi8(
+                _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(high, commas),
+                                          _mm_cmpeq_epi8(high, newlines)),
+                             _mm_cmpeq_epi8(high, quotes))) << 16;
+
+      /* Turn each set bit into a position, lowest first              */
+      while (mask != 0)
+      {
+         p_structurals[count++] = (unsigned int) (block +
+                                                  __builtin_ctz(mask));
+         mask &= mask - 1;
+      }
+   }
+
+   return count + csv_index_scalar(p_data, block, length,
+                                   p_structurals + count);
+}
+
+/**********************************************************************/
+/*               Find structural characters 64 bytes at a time        */
+/**********************************************************************/
+CSV_FUNCTION
+__attribute__((target("avx2")))
+size_t csv_index_avx2(const char   *p_data,
+                      size_t       length,
+                      unsigned int *p_structurals)
+{
+   __m256i   commas   = _mm256_set1_epi8(','), /* Compared 32 at once */
+             newlines = _mm256_set1_epi8('\n'),
+             quotes   = _mm256_set1_epi8('"'),
+             low,                              /* First 32 bytes      */
+             high;                             /* Second 32 bytes     */
+   unsigned long long mask;                    /* Bit per separator   */
+   size_t    count = 0,                        /* Positions found     */
+             block;                            /* Start of 64 bytes   */
+
+   for (block = 0; block + 64 <= length; block += 64)
+   {
+      low  = _mm256_loadu_si256((const __m256i *) (p_data + block));
+      high = _mm256_loadu_si256((const __m256i *) (p_data + block + 32));
+      mask = (unsigned int) _mm256_movemask_epi8(
+                _mm256_or_si256(
+                   _mm256_or_si256(_mm256_cmpeq_epi8(low, commas),
+                                   _mm256_cmpeq_epi8(low, newlines)),
+                   _mm256_cmpeq_epi8(low, quotes))) |
+             (unsigned long long) (unsigned int) _mm256_movemask_epi8(
+                _mm256_or_si256(
+                   _mm256_or_si256(_mm256_cmpeq_epi8(high, commas),
+                                   _mm256_cmpeq_epi8(high, newlines)),
+                   _mm256_cmpeq_epi8(high, quotes))) << 32;
+
+      /* Turn each set bit into a position, lowest first              */
+      while (mask != 0)
+      {
+         p_structurals[count++] = (unsigned int) (block +
+                                                  __builtin_ctzll(mask));
+         mask &= mask - 1;
+      }
+   }
+
+   return count + csv_index_scalar(p_data, block, length,
+                                   p_structurals + count);
+}
+#endif
+
+/**********************************************************************/
+/*   Get the next cell, returns what ended it: ',', '\n' or 0 at end  */
+/**********************************************************************/
+CSV_FUNCTION
+int csv_next_field(CSV_INDEX *p_index, CSV_FIELD *p_field)
+{
+   const char *p_data = p_index->p_data; /* Sheet being read          */
+   size_t     start   = p_index->cursor, /* First byte of the cell    */
+              end,                       /* Separator after the cell  */
+              position;                  /* Structural being looked at*/
+
+   p_field->p_start = p_data + start;
+   p_field->length  = 0;
+   p_field->quoted  = 0;
+   if (start >= p_index->length)
+      return 0;
+
+   /* Jump over separators already behind the cursor                  */
+   while (p_index->next_structural < p_index->structural_count &&
+          p_index->p_structurals[p_index->next_structural] < start)
+      p_index->next_structural++;
+
+   /* A quoted cell runs to the quote that isn't doubled, and commas  */
+   /* and newlines inside it belong to the cell                       */
+   if (p_data[start] == '"')
+   {
+      p_field->quoted  = 1;
+      p_field->p_start = p_data + start + 1;
+      p_index->next_structural++;
+      p_field->length  = -1;
+      while (p_index->next_structural < p_index->structural_count)
+      {
+         position = p_index->p_structurals[p_index->next_structural++];
+         if (p_data[position] != '"')
+            continue;
+         if (p_data[position + 1] == '"')
+         {
+            p_index->next_structural++;
+            continue;
+         }
+         p_field->length = (int) (position - start - 1);
+         break;
+      }
+      if (p_field->length < 0)
+      {
+         p_field->length = (int) (p_index->length - start - 1);
+         p_index->cursor = p_index->length;
+         return 0;
+      }
+   }
+
+   /* The cell ends at the next comma or newline, a stray quote in an */
+   /* unquoted cell is just a character                               */
+   while (p_index->next_structural < p_index->structural_count &&
+          p_data[p_index->p_structurals[p_index->next_structural]] == '"')
+      p_index->next_structural++;
+   end = p_index->p_structurals[p_index->next_structural];
+   if (p_index->next_structural < p_index->structural_count)
+      p_index->next_structural++;
+
+   if (!p_field->quoted)
+   {
+      p_field->length = (int) (end - start);
+      if (p_field->length > 0 && p_data[end - 1] == '\r')
+         p_field->length--;
+   }
+   p_index->cursor = end + 1;
+   if (end >= p_index->length)
+      return 0;
+
+   return p_data[end];
+}
+
+/**********************************************************************/
+/*              Skip the rest of the line the last cell was on        */
+/**********************************************************************/
+CSV_FUNCTION
+int csv_skip_line(CSV_INDEX *p_index, int terminator)
+{
+   CSV_FIELD field; /* Cell being skipped                             */
+
+   while (terminator == ',')
+      terminator = csv_next_field(p_index, &field);
+
+   return terminator;
+}
+
+/**********************************************************************/
+/*                 Copy a cell as one word, returns its length        */
+/**********************************************************************/
+CSV_FUNCTION
+int csv_copy_field(CSV_FIELD *p_field, char *p_text, int text_size)
+{
+   int byte,       /* Count through each byte of the cell              */
+       length = 0; /* Bytes copied so far                              */
+
+   /* Spaces become '_' so the name stays one word in the game file   */
+   for (byte = 0; byte < p_field->length && length < text_size - 1; byte++)
+   {
+      if (p_field->quoted && p_field->p_start[byte] == '"')
+         byte++;
+      if (isspace((unsigned char) p_field->p_start[byte]))
+         p_text[length++] = '_';
+      else
+         p_text[length++] = p_field->p_start[byte];
+   }
+   p_text[length] = '\0';
+
+   return length;
+}
+
+/**********************************************************************/
+/*           Read a cell as a whole number, returns 1 if it was one   */
+/**********************************************************************/
+CSV_FUNCTION
+int csv_field_number(CSV_FIELD *p_field, int *p_number)
+{
+   char digits[MAX_NUMBER_FIELD + 1]; /* Cell as a string for atoi   */
+   int  length = p_field->length;     /* Bytes of the cell used       */
+
+   if (length > MAX_NUMBER_FIELD)
+      length = MAX_NUMBER_FIELD;
+   memcpy(digits, p_field->p_start, length);
+   digits[length] = '\0';
+
+   return sscanf(digits, "%d", p_number) == 1;
+}
+
+/**********************************************************************/
+/*       Find where a row ends, counting only newlines outside quotes */
+/**********************************************************************/
+CSV_FUNCTION
+size_t csv_skip_rows(const char *p_data,
+                     size_t     start,
+                     size_t     length,
+                     int        rows,
+                     int        in_quotes)
+{
+   size_t byte; /* Count through each byte                            */
+
+   for (byte = start; byte < length && rows > 0; byte++)
+      if (p_data[byte] == '"')
+         in_quotes = !in_quotes;
+      else if (p_data[byte] == '\n' && !in_quotes)
+         rows--;
+
+   return byte;
+}
+
+#endif
@@ -0,0 +1,124 @@
+/**********************************************************************/
+/*                                                                    */
+/* Generated by roster_compiler from wheel_csv.txt                    */
+/* Do not edit, rebuild it from the sheet instead.                    */
+/*                                                                    */
+/**********************************************************************/
+#define ROSTER_PLAYERS    4        /* Players in the fallback roster  */
+#define ROSTER_GAMES      48       /* Games in the fallback roster    */
+
+static const char roster_player_names[ROSTER_PLAYERS][MAX_PLAYER_NAME] =
+{
+   "Cavey",
+   "Deeswa",
+   "Dudwen",
+   "Goater",
+};
+
+static const char roster_game_names[ROSTER_GAMES][MAX_GAME_NAME] =
+{
+   "Abort",
+   "Among_Us",
+   "Apex",
+   "Ark",
+   "Astroneer",
+   "Bluelock",
+   "Bluestacks",
+   "Brawlhalla",
+   "Business_Tour",
+   "Crab_Gey",
+   "Cuminme",
+   "Darza",
+   "Destiny_2",
+   "Diep",
+   "Drunk_Wrest_2",
+   "E_Od_Oder",
+   "FPS_Chess",
+   "Garrys_Mod",
+   "Godspeed",
+   "Grabity",
+   "Ight",
+   "Itchi",
+   "Leg",
+   "Lethal",
+   "Mivals",
+   "Maunt",
+   "Meager",
+   "Mince",
+   "Moomoo",
+   "Mope",
+   "Muck",
+   "One_Arm_Robber",
+   "Osu",
+   "Overwatch",
+   "Party_Games",
+   "Peak",
+   "Pixel_Gun",
+   "PP",
+   "R6",
+   "Rain_world",
+   "Ranch",
+   "Roblox",
+   "Rounds",
+   "Shellshock",
+   "Spacewar",
+   "Splitgate",
+   "Terererer",
+   "UCH",
+};
+
+static const int roster_player_limits[ROSTER_GAMES] =
+{
+   0, 0, 4, 0, 4, 5, 0, 4, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 4, 4, 5, 0, 0, 0,
+   0, 0, 0, 0, 0, 0, 0, 0, 0, 6, 0, 0, 0, 4, 0, 4, 0, 0, 0, 0, 0, 0, 0, 4,
+};
+
+static const char roster_status_rows[ROSTER_GAMES * (ROSTER_PLAYERS + 1) + 1] =
+   "yyyy\000"
+   "nnyy\000"
+   "dndy\000"
+   "dndn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "ynyn\000"
+   "nnyn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yynn\000"
+   "yyyn\000"
+   "nnnn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yynn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "dyyn\000"
+   "ynyn\000"
+   "ynyn\000"
+   "nnyn\000"
+   "yyyn\000"
+   "nnnn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yynn\000"
+   "yynn\000"
+   "yyyn\000"
+   "ynyn\000"
+   "yyyn\000"
+   "dnnn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "ynyn\000"
+   "dddn\000"
+   "ynyn\000"
+   "ynyn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "yyyn\000"
+   "ynyn\000"
+   "yydn\000"
+   "ynyn\000"
+   "yyyn\000"
+   "yyyn\000";
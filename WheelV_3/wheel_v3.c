@@ -21,22 +21,34 @@
 #include <unistd.h> /* Sleep (Pauses program)                         */
 #include <time.h>   /* Random number using time                       */
 #include <string.h> /* For strcpy, strtok                             */
+#include <stddef.h> /* For offsetof                                   */
+#include <stdarg.h> /* For status messages with format arguments      */
+#include <pthread.h> /* For the background load thread                */
 #include <curl/curl.h> /* For curl functions                          */
 #include <ncurses/ncurses.h>  /* For ncurses functions */
 #include <windows.h> /* For Windows console control                   */
+#ifndef _WIN32
+#include <poll.h>   /* Wait on the terminal and the wake pipe         */
+#include <signal.h> /* Keep SIGWINCH off the worker threads           */
+#include <fcntl.h>  /* Non-blocking wake pipe                         */
+#include <sys/mman.h> /* Map the spin journal to query it             */
+#include <sys/stat.h> /* Size of a file being mapped                  */
+#endif
+#include "wheel_csv.h" /* Sheet tokenizer shared with roster_compiler */
 
 /**********************************************************************/
 /*                         Symbolic Constants                         */
 /**********************************************************************/
 #define PROGRAM_NAME      "Wheel"  /* The program's name              */
 #define PROGRAMER_NAME    "Dudwen" /* The programers's name           */
-#define MAX_GAMES         75       /* Max amount of games in a list   */
-#define MAX_PLAYERS       10       /* Max amount of players in a list */
+#define MAX_GAMES         1000000  /* Max amount of games in a list   */
+#define MAX_PLAYERS       1024     /* Max amount of players in a list */
 #define MAX_GAME_NAME     25       /* Max length of a game's name     */
 #define MAX_PLAYER_NAME   20       /* Max length of a players's name  */
-#define INSERT_ALLOC_ERR  1        /* Data memory allocation error    */
-                                   /* inserting a new game            */
 #define NO_LIST_ERR       2        /* No list for the wheel error     */
+#define SESSION_ERR       3        /* Session file cannot be used, or */
+                                   /* its replay went off course      */
+#define REPLAY_DIFF_ERR   4        /* Replay picked different games   */
 #define HEADER_ROWS       15
 #define QUIT              0        /* Party select exit value         */
 #define CSV_FILE          "wheel_csv.txt"  
@@ -45,6 +57,125 @@
                                    /* Local game file to save to      */
 #define WHEEL_URL         "https://docs.google.com/spreadsheets/d/e/2PACX-1vQfm6we569iWy17cQ2V8JaFNLG-u7P7RO8nx5fH5X_HNfHgr_36yVNE47z27HFvUYiUp1QT5kS92Wzv/pub?gid=0&single=true&output=csv"
                                    /* Google Sheet CSV URL            */
+#define EVENT_QUEUE_SIZE  256      /* Max events waiting to be handled*/
+#define STATUS_MSG_LEN    80       /* Max length of a status message  */
+#define MAX_TIMERS        4        /* Max timers in the event loop    */
+#define ANIMATION_DELAY   50       /* Milliseconds between wheel frame*/
+#define MAX_NUMBER_DIGITS 9        /* Max digits typed for a number   */
+#define FORMAT_LEN        32       /* Max length of a built format    */
+#define MAX_QUERY_LEN     24       /* Max length of a search query    */
+#define MAX_FUZZY_RESULTS 100      /* Max near matches for a search   */
+#define MAX_EXPRESSION_LEN 60     /* Max length of a game query      */
+#define POSTING_BITS_RATIO 32      /* Lists with over one game in this*/
+                                   /* many are kept as bits           */
+#define GALLOP_RATIO      16       /* A list this many times longer   */
+                                   /* is galloped through, not merged */
+#define TRIE_DEPTH        8        /* Letters indexed by the trie     */
+#define SEARCH_SYMBOLS    37       /* a-z, 0-9 and '_' in search keys */
+#define TRIGRAM_COUNT     (SEARCH_SYMBOLS * SEARCH_SYMBOLS * SEARCH_SYMBOLS)
+                                   /* Possible three letter grams     */
+#define TRACE_ENV         "WHEEL_TRACE"
+                                   /* Environment variable naming the */
+                                   /* trace file to write             */
+#define TRACE_FLAG        "--trace"/* Command line flag to trace      */
+#define TRACE_FILE        "wheel_trace.json"
+                                   /* Trace file when none is named   */
+#define MAX_TRACE_SPANS   65536    /* Max spans kept for one session  */
+#define MAX_TRACE_THREADS 64       /* Max threads given their own     */
+                                   /* track in the trace              */
+#define METRICS_ENV       "WHEEL_METRICS"
+                                   /* Environment variable naming the */
+                                   /* Prometheus textfile to write    */
+#define METRICS_FLAG      "--metrics"
+                                   /* Command line flag for metrics   */
+#define METRICS_PERIOD    60000    /* Milliseconds between rewrites   */
+#define HISTOGRAM_SUB_BITS 3       /* Linear steps per power of two   */
+                                   /* are 2^bits, ~12% precision      */
+#define HISTOGRAM_BUCKETS 320      /* Buckets for up to 2^40 us       */
+#define MAX_FILE_NAME     260      /* Max length of a file path       */
+#define STAGE_COUNT       4        /* Stages with a latency histogram */
+#define COUNTER_COUNT     5        /* Counters kept by the metrics    */
+#define MAX_PARSE_THREADS 16       /* Max threads parsing game rows   */
+#define PARSE_CHUNK_MIN   (1 << 20)/* Min bytes of rows for a thread  */
+#define SOURCES_FILE      "wheel_sources.txt"
+                                   /* Sheet URLs to fetch, one a line */
+#define SOURCE_FLAG       "--source"
+                                   /* Command line flag adding a URL  */
+#define CSV_COPY_FORMAT   "wheel_csv_%d.txt"
+                                   /* Copy of each sheet after the    */
+                                   /* first, numbered from 2          */
+#define MAX_SOURCES       16       /* Max sheets merged into a roster */
+#define MAX_URL_LEN       2048     /* Max length of a sheet URL       */
+#define POLL_INTERVAL     100      /* Max ms waiting on the downloads */
+#define ROW_HASH_BASIS    14695981039346656037ULL
+                                   /* FNV-1a 64 bit offset basis      */
+#define ROW_HASH_PRIME    1099511628211ULL
+                                   /* FNV-1a 64 bit prime             */
+#define HISTORY_FILE      "wheel_history.bin"
+                                   /* Journal of every spin           */
+#define HISTORY_MAGIC     "WheelHistory1"
+                                   /* Names the journal's format      */
+#define HISTORY_CHECKPOINT 64      /* Spins between two checkpoints   */
+#define MAX_TOP_GAMES     5        /* Most picked games to show       */
+#define COOLDOWN_FLAG     "--cooldown"
+                                   /* Command line flag for sessions  */
+                                   /* before a game can come back     */
+#define MAX_COOLDOWN      64       /* Max sessions a game sits out    */
+#define COOLDOWN_SLOTS    128      /* Hash slots for the recent games,*/
+                                   /* a power of 2 over MAX_COOLDOWN  */
+#define TOURNAMENT_HIGHLIGHTS 3   /* Last rounds of a tournament     */
+                                   /* that are spun                   */
+#define TOURNAMENT_PAUSE  1500     /* Milliseconds showing who is out */
+#define SPLIT_MAX_PLAYERS 64       /* Max party a split can search,   */
+                                   /* one bit per member              */
+#define MAX_SPLIT_THREADS 16       /* Max threads searching a split   */
+#define SPLIT_TIME_LIMIT  250      /* Max ms searching for a split    */
+#define SPLIT_NODE_LIMIT  4000000  /* Max placements tried instead, in */
+                                   /* a recorded or replayed session  */
+#define SPLIT_TASK_DEPTH  6        /* Members placed before the search*/
+                                   /* is shared out between threads   */
+#define SPLIT_CHECK_NODES 4096     /* Placements between clock checks */
+#define PARTIES_FLAG      "--parties"
+                                   /* Command line flag checking each */
+                                   /* party in a file, then quitting  */
+#define PARTY_GAMES_FLAG  "--party-games"
+                                   /* Command line flag listing each  */
+                                   /* party's games too               */
+#define PARTY_BLOCK_GAMES 512      /* Games checked while in cache    */
+#define PARTY_THREAD_MIN  64       /* Min parties worth a thread      */
+#define MAX_PARTY_THREADS 16       /* Max threads checking parties    */
+#define MAX_SUBSET_MEMBERS 16      /* Max names a '*' line splits up  */
+#define MAX_BATCH_PARTIES (1 << 20)/* Max parties checked at once     */
+#define ARENA_BLOCK_SIZE  65536    /* Bytes in a session's first block*/
+#define ARENA_ALIGN       16       /* Alignment of arena allocations  */
+#define ATTRIBUTE_FILE    "wheel_attributes.txt"
+                                   /* Sheet's extra columns, by game  */
+#define MAX_ATTRIBUTES    8        /* Max extra columns kept          */
+#define MAX_ATTRIBUTE_NAME 16      /* Max length of a column's name   */
+#define MAX_ATTRIBUTE_VALUE 16     /* Max length of a column's value  */
+#define MAX_ATTRIBUTE_NUMBER 999999999
+                                   /* Largest number a column holds   */
+#define ATTRIBUTE_MISSING (-2147483647 - 1)
+                                   /* Value of an empty cell          */
+#define MAX_FILTER_LEN    60       /* Max length of a typed filter    */
+#define MAX_FILTER_STEPS  32       /* Max tests and joins in a filter */
+#define FILTER_SHOWN_VALUES 4      /* Text values listed for a column */
+#define RECORD_FLAG       "--record"
+                                   /* Command line flag to record the */
+                                   /* session to a file               */
+#define REPLAY_FLAG       "--replay"
+                                   /* Command line flag to replay a   */
+                                   /* recorded session headless       */
+#define SESSION_MAGIC     "WheelSession1"
+                                   /* Names the session file's format */
+#define REPLAY_TERM       "vt100"  /* Terminal a replay draws for     */
+                                   /* when TERM names none            */
+#ifdef _WIN32
+#define NULL_DEVICE       "NUL"    /* Where a replay draws the screen */
+#else
+#define NULL_DEVICE       "/dev/null"
+                                   /* Where a replay draws the screen */
+#endif
 
 /**********************************************************************/
 /*                         Program Structures                         */
@@ -54,8 +185,7 @@ struct game
 {
    int  player_limit,
         wheel_approved;
-   char game_name[MAX_GAME_NAME];     
-   char game_status[MAX_GAMES];  
+   char game_name[MAX_GAME_NAME];
 };
 typedef struct game GAME;
 
@@ -76,6 +206,572 @@ struct wheel
 };
 typedef struct wheel WHEEL;
 
+/* Game taken off the wheel, kept so it can go back where it was      */
+struct removal
+{
+   WHEEL *p_before,                   /* Game the removed one followed*/
+         *p_game;                     /* Game taken off the wheel     */
+};
+typedef struct removal REMOVAL;
+
+/* Games taken off the wheel, oldest first                            */
+struct wheel_undo
+{
+   REMOVAL *p_removals;               /* Removals still in effect,    */
+                                      /* then the ones undone         */
+   int     applied_count,             /* Removals still in effect     */
+           removal_count,             /* Removals kept, undone ones   */
+                                      /* included                     */
+           capacity;                  /* Removals there is room for   */
+};
+typedef struct wheel_undo WHEEL_UNDO;
+
+/* One block of memory an arena hands out from                        */
+struct arena_block
+{
+   struct arena_block *p_next;        /* Block filled before this one */
+   size_t             size,           /* Bytes the block holds        */
+                      used;           /* Bytes handed out from it     */
+};
+typedef struct arena_block ARENA_BLOCK;
+
+/* Memory for one session, handed out in order and given back at once */
+struct arena
+{
+   ARENA_BLOCK *p_blocks;             /* Newest block first           */
+   size_t      block_size,            /* Bytes the next block holds   */
+               bytes_used,            /* Bytes handed out this session*/
+               bytes_reserved,        /* Bytes in every block         */
+               peak_bytes;            /* Most bytes a session used    */
+   long long   allocation_count;      /* Allocations this session     */
+};
+typedef struct arena ARENA;
+
+/* One letter of the search trie                                     */
+struct trie_node
+{
+   char letter;                       /* Letter leading to this node  */
+   int  first_child,                  /* First longer prefix, or -1   */
+        last_child,                   /* Last longer prefix, or -1    */
+        next_sibling,                 /* Next letter at this depth    */
+        range_start,                  /* First sorted key with prefix */
+        range_count;                  /* Amount of keys with prefix   */
+};
+typedef struct trie_node TRIE_NODE;
+
+/* Type-ahead search over a list of names                             */
+struct search_index
+{
+   int       ready,                   /* Index was built successfully */
+             item_count,              /* Amount of names indexed      */
+             key_size,                /* Bytes for each search key    */
+             node_count,              /* Nodes used in the trie       */
+             node_capacity;           /* Nodes allocated for the trie */
+   char      *keys;                   /* Lower-cased name of each item*/
+   int       *sorted_items,           /* Items in order of their keys */
+             *item_rank,              /* Position in sorted_items     */
+             *gram_start,             /* Where each trigram's items   */
+                                      /* start in gram_items          */
+             *gram_items,             /* Items holding each trigram   */
+             *scores,                 /* Trigrams matched, per item   */
+             *touched;                /* Items with a non-zero score  */
+   TRIE_NODE *nodes;                  /* Prefix trie over the keys    */
+};
+typedef struct search_index SEARCH_INDEX;
+
+/* Items found by a search                                            */
+struct search_result
+{
+   int prefix_start,                  /* First sorted key matched     */
+       prefix_count,                  /* Keys starting with the query */
+       fuzzy_count,                   /* Near matches found           */
+       fuzzy_items[MAX_FUZZY_RESULTS],/* Near matches, best first     */
+       fuzzy_scores[MAX_FUZZY_RESULTS];
+};
+typedef struct search_result SEARCH_RESULT;
+
+/* Search box in front of a list of players or games                  */
+struct search_view
+{
+   SEARCH_INDEX  *p_index;            /* Index over the list's names  */
+   void          *p_items;            /* Players or games searched    */
+   int           item_count;          /* Amount of players or games   */
+   char          query[MAX_QUERY_LEN + 1]; /* What has been typed     */
+   int           query_length;        /* Amount of letters typed      */
+   SEARCH_RESULT result;              /* Matches for the query        */
+};
+typedef struct search_view SEARCH_VIEW;
+
+/* Games one player has, or has to download, in order                 */
+struct posting
+{
+   int                count,          /* Games in the list            */
+                      shared;         /* Belongs to the roster, so it */
+                                      /* is never freed by a query    */
+   int                *p_games;       /* Game numbers in order, or    */
+                                      /* NULL when kept as bits       */
+   unsigned long long *p_bits;        /* A bit per game, for lists    */
+                                      /* too long to keep as numbers  */
+};
+typedef struct posting POSTING;
+
+/* One extra column of the sheet, a value for every game              */
+struct attribute
+{
+   char         name[MAX_ATTRIBUTE_NAME]; /* Column's header          */
+   int          is_number,            /* Every value is a number      */
+                text_count,           /* Distinct text values         */
+                text_capacity,        /* Text values there is room for*/
+                *p_values,            /* Each game's number, or its   */
+                                      /* text's code, or              */
+                                      /* ATTRIBUTE_MISSING            */
+                *p_text_slots;        /* Hash table of text codes + 1,*/
+                                      /* only while loading           */
+   unsigned int text_mask;            /* Hash table size less one     */
+   char         (*p_texts)[MAX_ATTRIBUTE_VALUE]; /* Each text by code */
+};
+typedef struct attribute ATTRIBUTE;
+
+/* Every extra column of the sheet, kept a column at a time           */
+struct attributes
+{
+   int       count;                   /* Columns kept                 */
+   ATTRIBUTE columns[MAX_ATTRIBUTES]; /* Each column                  */
+};
+typedef struct attributes ATTRIBUTES;
+
+/* Everything loaded from the sheet                                   */
+struct roster
+{
+   GAME         *game_list;           /* Games from the sheet         */
+   PLAYER       *player_list;         /* Players from the sheet       */
+   int          amount_of_games,
+                amount_of_players;
+   SEARCH_INDEX game_index,           /* Type-ahead over game names   */
+                player_index;         /* Type-ahead over player names */
+   unsigned long long *row_hashes,    /* Content hash of each game row*/
+                      *p_have_bits,   /* Who has each game, a bit per */
+                                      /* player, player_words a game  */
+                      *p_download_bits; /* Who has to download it     */
+   int          player_words;         /* Words of bits for each game  */
+   POSTING      *p_postings;          /* Games each player has, then  */
+                                      /* has to download, two a player*/
+   ATTRIBUTES   attributes;           /* Sheet's extra columns        */
+};
+typedef struct roster ROSTER;
+
+/* One step of a compiled filter, run over a whole column at once     */
+struct filter_step
+{
+   int op,                            /* FILTER_TEST, _AND, _OR, _NOT */
+       column,                        /* Column a test reads          */
+       outside,                       /* Test keeps values outside    */
+                                      /* the range instead of in it   */
+       low,                           /* Lowest value of the range    */
+       high;                          /* Highest value of the range   */
+};
+typedef struct filter_step FILTER_STEP;
+
+/* Filter over the extra columns, compiled to steps that work on a    */
+/* stack of bitsets, a bit per game                                   */
+struct game_filter
+{
+   ROSTER      *p_roster;             /* Roster being filtered        */
+   const char  *p_text;               /* Filter being read            */
+   int         position,              /* Next character to read       */
+               step_count,            /* Steps compiled               */
+               depth,                 /* Results stacked so far       */
+               max_depth,             /* Most results ever stacked    */
+               stack_depth,           /* Bitsets there is room for    */
+               words,                 /* Words of bits for the games  */
+               ready;                 /* First bitset is the games    */
+                                      /* the steps keep               */
+   FILTER_STEP steps[MAX_FILTER_STEPS]; /* Filter in postfix order    */
+   unsigned long long *p_stack;       /* Bitsets, in the session arena*/
+   char        error[STATUS_MSG_LEN]; /* Why it couldn't be read      */
+};
+typedef struct game_filter GAME_FILTER;
+
+/* Set expression of players being read to query the games            */
+struct game_query
+{
+   ROSTER     *p_roster;              /* Roster being queried         */
+   const char *p_text;                /* Expression being read        */
+   int        position;               /* Next character to read       */
+   char       error[STATUS_MSG_LEN];  /* Why it couldn't be read      */
+   POSTING    result;                 /* Games it picks, as numbers   */
+};
+typedef struct game_query GAME_QUERY;
+
+/* Games ranked by how many of the party can play them                */
+struct ranking
+{
+   ROSTER *p_roster;                  /* Roster the games are from    */
+   int    *p_games,                   /* Games, most players first    */
+          *p_ready,                   /* Members who can play each    */
+                                      /* game now, by game            */
+          *p_waiting,                 /* Members who'd have to        */
+                                      /* download it first            */
+          game_count,                 /* Games anyone could play      */
+          party_count;                /* Members ranked for           */
+};
+typedef struct ranking RANKING;
+
+/* One game row that changed since the roster in use was loaded       */
+struct row_change
+{
+   int                game,           /* Game in the roster in use    */
+                      player_limit;   /* Its new player limit         */
+   unsigned long long hash;           /* Its new content hash         */
+};
+typedef struct row_change ROW_CHANGE;
+
+/* Refresh of a roster, as either just the rows that changed or a     */
+/* whole new roster that may still share a search index               */
+struct roster_delta
+{
+   int        ready,                  /* Only the changes below apply */
+              change_count,           /* Rows that changed            */
+              capacity,               /* Changes there is room for    */
+              keep_game_index,        /* Game names are as they were  */
+              keep_player_index;      /* Player names are as they were*/
+   ROW_CHANGE *p_changes;             /* Each changed row             */
+   unsigned long long *p_bits;        /* New have then download bits  */
+                                      /* of each changed row          */
+};
+typedef struct roster_delta ROSTER_DELTA;
+
+/* Scrollable window onto a list that only draws what is visible    */
+struct list_view
+{
+   int top_row,                       /* Screen row of the first item */
+       height,                        /* Rows the list can use        */
+       item_count,                    /* Amount of items in the list  */
+       first_item,                    /* Item shown on the top row    */
+       cursor;                        /* Highlighted item             */
+};
+typedef struct list_view LIST_VIEW;
+
+/* Something the event loop has to handle                              */
+struct event
+{
+   int  type,                         /* EV_KEY, EV_TIMER, ...        */
+        value;                        /* Key code or timer id         */
+   void *p_data;                      /* Finished background job      */
+   char message[STATUS_MSG_LEN];      /* Status text from a worker    */
+};
+typedef struct event EVENT;
+
+/* Timer driven by the event loop                                     */
+struct timer
+{
+   int       active;                  /* Timer is counting down       */
+   long long deadline,                /* When it fires (monotonic ms) */
+             period;                  /* Repeat interval, 0 = one shot*/
+};
+typedef struct timer TIMER;
+
+/* The event loop multiplexing input, resizes, timers and workers     */
+struct event_loop
+{
+   EVENT           queue[EVENT_QUEUE_SIZE]; /* Events not yet handled */
+   int             queue_head,        /* Oldest event in the queue    */
+                   queue_count;       /* Amount of queued events      */
+   pthread_mutex_t queue_lock;        /* Guards the queue from workers*/
+   int             stopping;          /* Background work should quit  */
+   TIMER           timers[MAX_TIMERS];
+   int             message_row;       /* Row of the transient message */
+#ifdef _WIN32
+   HANDLE          wake_event;        /* Signalled when a worker posts*/
+#else
+   int             wake_pipe[2];      /* Written when a worker posts  */
+#endif
+};
+typedef struct event_loop EVENT_LOOP;
+
+/* Game and player lists loaded in the background                     */
+struct load_job
+{
+   pthread_t thread;                  /* Thread running the load      */
+   int       running,                 /* Thread started, not joined   */
+             finished,                /* Worker posted EV_WORK_DONE   */
+             early,                   /* Players are wanted, or in    */
+                                      /* use, before the games        */
+             players_ready,           /* Worker posted the players    */
+             player_count;            /* Players handed over early    */
+   PLAYER    *p_players;              /* Sheet's players, handed over */
+                                      /* before its games, or NULL    */
+   ROSTER    roster,                  /* Loaded lists, owned by job   */
+             *p_base;                 /* Roster in use, only read     */
+   ROSTER_DELTA delta;                /* How the fresh lists differ   */
+                                      /* from the ones in use         */
+};
+typedef struct load_job LOAD_JOB;
+
+/* One timed stage of the program                                     */
+struct trace_span
+{
+   const char *p_name,                /* Stage that was timed         */
+              *p_category;            /* Group of stages it belongs to*/
+   long long  start,                  /* Microseconds from trace start*/
+              duration;               /* Microseconds the stage took  */
+   int        thread;                 /* 1 for the UI, then one per   */
+                                      /* worker in the order seen     */
+};
+typedef struct trace_span TRACE_SPAN;
+
+/* Spans recorded for a Chrome trace-event file                       */
+struct tracer
+{
+   int             enabled,           /* Tracing was asked for        */
+                   span_count,        /* Spans recorded so far        */
+                   dropped;           /* Spans lost to a full buffer  */
+   long long       origin;            /* When tracing started, in us  */
+   char            *p_file_name;      /* Where the trace is written   */
+   TRACE_SPAN      *spans;            /* Spans recorded so far        */
+   pthread_t       threads[MAX_TRACE_THREADS]; /* Each thread seen,   */
+                                      /* the screens' thread first    */
+   int             thread_count;      /* Threads seen so far          */
+   pthread_mutex_t lock;              /* Guards everything above      */
+};
+typedef struct tracer TRACER;
+
+/* Log-linear latency histogram, HDR style, in microseconds           */
+struct histogram
+{
+   long long counts[HISTOGRAM_BUCKETS], /* Samples in each bucket     */
+             count,                     /* Samples recorded           */
+             sum,                       /* Total of every sample      */
+             max;                       /* Largest sample             */
+};
+typedef struct histogram HISTOGRAM;
+
+/* Latencies and counters exported for Prometheus                     */
+struct metrics
+{
+   int             enabled;           /* Metrics were asked for       */
+   char            *p_file_name;      /* Textfile the collector reads */
+   HISTOGRAM       stages[STAGE_COUNT]; /* Fetch, parse, filter, spin */
+   long long       counters[COUNTER_COUNT]; /* One per COUNT_ value   */
+   long long       arena_peak_bytes,  /* Most one session's arena held*/
+                   arena_allocations; /* Allocations from the arenas  */
+   pthread_mutex_t lock;              /* Guards everything above      */
+};
+typedef struct metrics METRICS;
+
+/* Slice of the game rows parsed by one thread                        */
+struct parse_chunk
+{
+   pthread_t  thread;                 /* Thread parsing the slice     */
+   int        running,                /* Thread started, not joined   */
+              quote_parity,           /* Slice has an odd number of " */
+              player_count,           /* Status cells in each row     */
+              attribute_count,        /* Extra cells after them       */
+              max_rows,               /* Most rows the sheet can use  */
+              row_count;              /* Rows decoded from the slice  */
+   const char *p_data;                /* Whole sheet                  */
+   size_t     start,                  /* First byte of the slice      */
+              end,                    /* One past its last byte       */
+              output_length,          /* Bytes of game file lines     */
+              attribute_length;       /* Bytes of extra column lines  */
+   char       *p_output,              /* Slice's rows as game file    */
+                                      /* lines, in sheet order        */
+              *p_attributes;          /* Each row's name and extra    */
+                                      /* cells, a line a row          */
+};
+typedef struct parse_chunk PARSE_CHUNK;
+
+/* Downloaded sheet, already decompressed, waiting to be parsed       */
+struct sheet_buffer
+{
+   char   *p_data;                    /* Sheet's bytes                */
+   size_t length,                     /* Bytes received so far        */
+          capacity;                   /* Bytes allocated              */
+};
+typedef struct sheet_buffer SHEET_BUFFER;
+
+/* Sheet parsed into game file lines, waiting to be merged            */
+struct parsed_sheet
+{
+   int         ready,                 /* Sheet was parsed successfully*/
+               player_count,          /* Players in the sheet         */
+               game_count,            /* Game rows kept               */
+               chunk_count,           /* Slices the rows were cut into*/
+               attribute_count;       /* Extra columns after players  */
+   char        (*player_names)[MAX_PLAYER_NAME]; /* Sheet's players   */
+   char        attribute_names[MAX_ATTRIBUTES][MAX_ATTRIBUTE_NAME];
+                                      /* Header of each extra column  */
+   PARSE_CHUNK chunks[MAX_PARSE_THREADS]; /* Each slice's rows        */
+};
+typedef struct parsed_sheet PARSED_SHEET;
+
+/* Sheets a roster is fetched from and merged out of                  */
+struct sources
+{
+   int  count;                        /* Sheets to fetch              */
+   char urls[MAX_SOURCES][MAX_URL_LEN]; /* Where each sheet is found  */
+};
+typedef struct sources SOURCES;
+
+/* One fixed size record of the spin journal, 56 bytes                */
+struct spin_record
+{
+   long long          spin_time;      /* Seconds since 1970           */
+   unsigned long long party,          /* Sum of the party's name      */
+                                      /* hashes, any order alike      */
+                      game;           /* Hash of the game's name      */
+   int                eligible_count; /* Games that were on the wheel */
+   unsigned short     party_size;     /* Players in the party         */
+   unsigned char      type,           /* Which RECORD_ this is        */
+                      rerolled;       /* Game was removed to respin   */
+   char               game_name[MAX_GAME_NAME - 1];
+                                      /* Not zero ended when full     */
+};
+typedef struct spin_record SPIN_RECORD;
+
+/* Append-only journal of every spin                                  */
+struct history
+{
+   FILE               *p_file;        /* Journal, or NULL if unusable */
+   long long          record_count;   /* Good records, header included*/
+   unsigned long long block_hash;     /* Checksum of the spins since  */
+                                      /* the last checkpoint          */
+   int                block_count,    /* Spins since that checkpoint  */
+                      cooldown;       /* Sessions a kept game sits out*/
+};
+typedef struct history HISTORY;
+
+/* Game a sub-party could play, as a bitset of party members          */
+struct split_game
+{
+   unsigned long long players;        /* Members able to play it      */
+   int                limit,          /* Most of them that can play   */
+                      game;           /* Game in the roster's list    */
+};
+typedef struct split_game SPLIT_GAME;
+
+/* Search for the sub-parties letting the most members play           */
+struct split_search
+{
+   SPLIT_GAME         *p_games;       /* Games no other game covers,  */
+                                      /* biggest first                */
+   int                game_count,     /* Games to search              */
+                      member_count,   /* Members sharing a game       */
+                      members[SPLIT_MAX_PLAYERS], /* Bit of each one  */
+                      thread_count,   /* Threads sharing the search   */
+                      timed_out,      /* Gave up before finishing     */
+                      best_covered,   /* Members playing in the best  */
+                                      /* split found so far           */
+                      best_group_count, /* Sub-parties it has         */
+                      best_task,      /* Task that found it, ties go  */
+                                      /* to the first so runs agree   */
+                      best_games[SPLIT_MAX_PLAYERS]; /* Game for each */
+   unsigned long long best_groups[SPLIT_MAX_PLAYERS]; /* Each one's   */
+                                      /* members                      */
+   long long          deadline,       /* When to give up searching    */
+                      node_limit;     /* Placements to give up after  */
+                                      /* instead, 0 to use the clock  */
+   pthread_mutex_t    lock;           /* Guards the best split        */
+};
+typedef struct split_search SPLIT_SEARCH;
+
+/* One thread's part of the split search                              */
+struct split_worker
+{
+   pthread_t          thread;         /* Thread doing this part       */
+   int                running,        /* Thread started, not joined   */
+                      thread_id,      /* Takes every thread_count'th  */
+                                      /* task, starting with this one */
+                      task,           /* Task being searched          */
+                      task_counter,   /* Tasks reached so far         */
+                      stopped,        /* Out of time                  */
+                      best_covered,   /* Copy of the best split's     */
+                      best_group_count, /* score, to prune without    */
+                      best_task,      /* taking the lock              */
+                      witnesses[SPLIT_MAX_PLAYERS]; /* First game     */
+                                      /* each sub-party fits          */
+   unsigned long long groups[SPLIT_MAX_PLAYERS]; /* Sub-parties being */
+                                      /* built                        */
+   long long          node_count;     /* Placements tried             */
+   SPLIT_SEARCH       *p_search;      /* Search being shared          */
+};
+typedef struct split_worker SPLIT_WORKER;
+
+/* Many parties checked against every game at once                    */
+struct party_batch
+{
+   ROSTER             *p_roster;      /* Roster the parties are from  */
+   unsigned long long *p_parties,     /* Each party's members, a bit  */
+                                      /* each, player_words a party   */
+                      *p_sets;        /* Games each party can play    */
+                                      /* now, then after downloads, a */
+                                      /* bit each, or NULL            */
+   int                party_count,    /* Parties to check             */
+                      game_words,     /* Words of bits for the games  */
+                      *p_limits,      /* Each game's player limit,    */
+                                      /* MAX_PLAYERS for none         */
+                      *p_sizes,       /* Members in each party        */
+                      *p_ready,       /* Games each can play now      */
+                      *p_waiting;     /* Games each can play after    */
+                                      /* downloads                    */
+};
+typedef struct party_batch PARTY_BATCH;
+
+/* One thread's run of the parties in a batch                         */
+struct batch_worker
+{
+   pthread_t   thread;                /* Thread checking the run      */
+   int         running,               /* Thread started, not joined   */
+               first_party,           /* First party of the run       */
+               end_party;             /* One past its last party      */
+   PARTY_BATCH *p_batch;              /* Batch being shared           */
+};
+typedef struct batch_worker BATCH_WORKER;
+
+/* Games a party kept in its last few sessions                        */
+struct recent_picks
+{
+   unsigned long long games[COOLDOWN_SLOTS]; /* Game hashes, 0 empty  */
+   int                session_count;  /* Sessions found in the journal*/
+};
+typedef struct recent_picks RECENT_PICKS;
+
+/* Session being recorded or replayed                                 */
+struct session
+{
+   int       mode,                    /* SESSION_OFF, _RECORD or      */
+                                      /* _REPLAY                      */
+             pick_count,              /* Games picked so far          */
+             mismatch_count;          /* Picks the replay got wrong   */
+   const char *p_file_name;           /* Session file                 */
+   FILE      *p_file,                 /* Session file, open           */
+             *p_screen;               /* Where a replay draws         */
+   long long start;                   /* When the session started     */
+};
+typedef struct session SESSION;
+
+/* Game picked often in the spin journal                              */
+struct history_top
+{
+   char game_name[MAX_GAME_NAME];     /* Game that was picked         */
+   int  picks;                        /* Times it was kept            */
+};
+typedef struct history_top HISTORY_TOP;
+
+/* File mapped into memory to be read                                 */
+struct mapped_file
+{
+   const void *p_data;                /* File's bytes                 */
+   size_t     length;                 /* Bytes mapped                 */
+#ifdef _WIN32
+   HANDLE     file,                   /* File being mapped            */
+              mapping;                /* Mapping of the file          */
+#else
+   int        file;                   /* File being mapped            */
+#endif
+};
+typedef struct mapped_file MAPPED_FILE;
+
 /**********************************************************************/
 /*                        Function Prototypes                         */
 /**********************************************************************/
@@ -83,31 +779,324 @@ void print_heading();
    /* Print the program heading                                       */
 void print_instructions();
    /* Print the instructions                                          */
-void load_data_file(GAME   game_list[MAX_GAMES],
-                    PLAYER player_list[MAX_PLAYERS],  
-                    int    *p_amount_of_games, 
-                    int    *p_amount_of_players);
+void load_data_file(ROSTER *p_roster);
    /* Read in the data from the game file                             */
-int  download_csv(const char *url, const char *filename);
+int  read_lists(FILE *p_game_file, ROSTER *p_roster);
+   /* Read the lists written out like the game file                   */
+int  allocate_lists(GAME   **p_game_list,
+                    PLAYER **p_player_list,
+                    int    amount_of_games,
+                    int    amount_of_players);
+   /* Allocate game and player lists for the given amounts            */
+int  allocate_roster(ROSTER *p_roster,
+                     int    amount_of_games,
+                     int    amount_of_players);
+   /* Allocate a roster's lists and bits for the given amounts        */
+void free_lists(GAME *game_list, PLAYER *player_list);
+   /* Free game and player lists                                      */
+void load_roster(ROSTER       *p_roster,
+                 ROSTER       *p_base,
+                 ROSTER_DELTA *p_delta,
+                 LOAD_JOB     *p_early);
+   /* Load the lists, or just what changed since the roster in use    */
+void free_roster(ROSTER *p_roster);
+   /* Free everything loaded from the sheet                           */
+void hash_roster(ROSTER *p_roster);
+   /* Hash the content of every game row                              */
+void set_owner_bits(ROSTER *p_roster, int game, const char *p_status);
+   /* Pack one game's statuses into its bits                          */
+char roster_status(const ROSTER *p_roster, int game, int player);
+   /* Read one player's status for a game from its bits               */
+int  party_can_play(const ROSTER             *p_roster,
+                    int                      game,
+                    const unsigned long long *p_party,
+                    char                     willing_to_wait);
+   /* Check every member of a party has a game, or can download it    */
+void build_postings(ROSTER *p_roster);
+   /* List the games each player has and has to download              */
+void free_postings(ROSTER *p_roster);
+   /* Free every player's lists of games                              */
+int  posting_set(POSTING *p_posting, int game, int present);
+   /* Put a game in one of a player's lists, or take it out           */
+unsigned long long row_hash(int                      player_limit,
+                            const char               *p_name,
+                            int                      name_length,
+                            const unsigned long long *p_have,
+                            const unsigned long long *p_download,
+                            int                      word_count);
+   /* Hash a game row's limit, name and bits                          */
+unsigned long long hash_bytes(unsigned long long hash,
+                              const void         *p_bytes,
+                              size_t             length);
+   /* Add bytes to an FNV-1a hash                                     */
+int  names_match(const char *p_first_name,
+                 const char *p_second_name,
+                 size_t     item_size,
+                 int        item_count);
+   /* Check if two lists have the same names in the same order        */
+int  diff_rosters(ROSTER       *p_base,
+                 ROSTER       *p_roster,
+                 ROSTER_DELTA *p_delta);
+   /* Find the rows that changed, if the games and players didn't     */
+int  add_row_change(ROSTER_DELTA             *p_delta,
+                    int                      game,
+                    int                      player_limit,
+                    const unsigned long long *p_have,
+                    const unsigned long long *p_download,
+                    int                      word_count,
+                    unsigned long long       hash);
+   /* Add a changed row to a delta                                    */
+void apply_roster_delta(ROSTER *p_roster, ROSTER_DELTA *p_delta);
+   /* Patch the changed rows into the lists in use                    */
+void free_roster_delta(ROSTER_DELTA *p_delta);
+   /* Free the changes of a delta                                     */
+void sources_init(int argc, char *argv[]);
+   /* Read the sheet URLs from the flags, the sources file or default */
+void source_copy_name(int source, char *p_file_name);
+   /* Name of the file keeping a source's last good sheet             */
+void fetch_sheets(PARSED_SHEET parsed[], LOAD_JOB *p_early);
+   /* Download every source at once and parse each as it arrives      */
+void post_early_players(PARSED_SHEET parsed[],
+                        SHEET_BUFFER sheets[],
+                        LOAD_JOB     *p_job);
+   /* Hand the players to the party screen before the games are in    */
+CURL *start_download(CURLM        *multi_handle,
+                     const char   *url,
+                     SHEET_BUFFER *p_sheet);
+   /* Add a sheet's transfer to the ones in flight                    */
+int  finish_download(CURL         *curl_handle,
+                     CURLcode     result,
+                     int          source,
+                     SHEET_BUFFER *p_sheet,
+                     long long    start);
+   /* Check a finished transfer and keep a copy of its sheet          */
+size_t download_write(char *p_bytes, size_t size, size_t count,
+                      void *p_data);
+   /* Add downloaded bytes to the sheet buffer                        */
 
-void file_converter(const char *input_file, const char *output_file);
+int  download_progress(void *p_data, curl_off_t download_total,
+                       curl_off_t download_now, curl_off_t upload_total,
+                       curl_off_t upload_now);
+   /* Abort the download when background work is stopping            */
 
+int  parse_saved_sheet(const char *input_file, PARSED_SHEET *p_parsed);
+   /* Parse the last good copy of a sheet                             */
+int  parse_sheet(char *p_sheet, size_t sheet_length, PARSED_SHEET *p_parsed);
+   /* Parse a sheet in memory into game file lines                    */
+size_t parse_sheet_header(char         *p_sheet,
+                          size_t       sheet_length,
+                          PARSED_SHEET *p_parsed,
+                          int          *p_game_count);
+   /* Read a sheet's counts, players and extra column names           */
+void free_parsed_sheet(PARSED_SHEET *p_parsed);
+   /* Free a sheet's parsed game file lines                           */
+int  sheets_to_lists(PARSED_SHEET parsed[],
+                     int          sheet_count,
+                     ROSTER       *p_roster);
+   /* Build the game and player lists straight from the parsed sheets */
+void write_game_file(const ROSTER *p_roster, const char *output_file);
+   /* Keep the lists as the space-separated file, for when offline    */
+void write_lists(FILE *p_file, const ROSTER *p_roster);
+   /* Write the lists the way read_lists reads them                   */
+int  merge_sheets(PARSED_SHEET parsed[],
+                  int          sheet_count,
+                  ROSTER       *p_roster);
+   /* Union players by name and games by name across the sheets       */
+void write_attribute_file(PARSED_SHEET parsed[], int sheet_count,
+                          const char *output_file);
+   /* Write the sheets' extra columns, unioned by name, a game a line */
+void load_attributes(GAME       game_list[],
+                     int        game_count,
+                     ATTRIBUTES *p_attributes);
+   /* Load the extra columns saved for the games, if there are any    */
+int  read_attributes(FILE       *p_file,
+                     GAME       game_list[],
+                     int        game_count,
+                     ATTRIBUTES *p_attributes);
+   /* Read extra columns into a column of values each                 */
+int  attribute_code(ATTRIBUTE *p_column, const char *p_text);
+   /* Code of a text value in a column, adding it if it is new        */
+void write_attributes(FILE       *p_file,
+                      GAME       game_list[],
+                      int        game_count,
+                      ATTRIBUTES *p_attributes);
+   /* Write extra columns the way read_attributes reads them          */
+void free_attributes(ATTRIBUTES *p_attributes);
+   /* Free every extra column                                         */
+unsigned int name_hash(const char *p_name);
+   /* Hash a name the same whatever its case                          */
+int  same_name(const char *p_first, const char *p_second);
+   /* Check if two names match, ignoring case                         */
+int  cpu_count();
+   /* Amount of processors this machine has                           */
+void run_parse_threads(PARSE_CHUNK *p_chunks,
+                       int         chunk_count,
+                       void        *(*worker)(void *p_data));
+   /* Run a worker on every slice and wait for them                   */
+void *count_quotes_worker(void *p_data);
+   /* Count whether a slice has an odd number of quotes               */
+void *parse_chunk_worker(void *p_data);
+   /* Index and decode the game rows in one slice                     */
+int  decode_game_rows(CSV_INDEX *p_csv,
+                      int       player_count,
+                      int       attribute_count,
+                      int       max_rows,
+                      char      *p_output,
+                      size_t    *p_output_length,
+                      char      *p_attributes,
+                      size_t    *p_attribute_length);
+   /* Decode game rows into game file lines, returns the rows         */
+size_t row_bytes(const char *p_lines, size_t length, int row_count);
+   /* Bytes taken by the first rows of some lines                     */
 char get_response(int response);
    /* Get a yes or no response                                        */
-void print_players(PLAYER player_list[MAX_PLAYERS], 
-                   int    amount_of_players);
-   /* Print the list of players                                       */
-void party_control(PLAYER player_list[MAX_PLAYERS], 
+void print_players(SEARCH_VIEW *p_player_search,
+                   LIST_VIEW   *p_player_view);
+   /* Print the visible part of the list of players                   */
+void print_party(PLAYER player_list[],
+                 int    amount_of_players,
+                 int    party_count);
+   /* Print who is in the party on one line                           */
+void party_select(ROSTER   *p_roster,
+                  LOAD_JOB *p_load,
+                  int      *p_party_count);
+   /* Let the user pick the party from the list of players            */
+void game_lookup(ROSTER *p_roster);
+   /* Look up a game by name to see who has it                        */
+void print_game_owners(ROSTER *p_roster,
+                       int    game,
+                       int    row,
+                       char   status,
+                       int    party_only,
+                       const char *label);
+   /* Print the players with one status for a game on one line        */
+void rank_games(ROSTER *p_roster);
+   /* Rank games by how many of the party can play them now or after  */
+   /* a download, with who is missing                                 */
+int  build_ranking(ROSTER *p_roster, RANKING *p_ranking);
+   /* Count each game's players with popcounts and sort them, best    */
+   /* first                                                           */
+void draw_ranked_item(void *p_items, int item);
+   /* Draw one row of the ranked games                                */
+void query_games(ROSTER *p_roster);
+   /* Find the games a set expression of players picks                */
+void draw_query_item(void *p_items, int item);
+   /* Draw one row of the games a query found                         */
+int  run_game_query(GAME_QUERY *p_query, const char *p_text);
+   /* Read and run a query, returns 0 with the reason if it can't     */
+int  parse_query_union(GAME_QUERY *p_query, POSTING *p_result);
+   /* Read terms joined by |                                          */
+int  parse_query_meet(GAME_QUERY *p_query, POSTING *p_result);
+   /* Read terms joined by &, - or nothing                            */
+int  parse_query_term(GAME_QUERY *p_query, POSTING *p_result);
+   /* Read a name, d:name, party, !term or (expression)               */
+int  query_player_list(GAME_QUERY *p_query,
+                       const char *p_name,
+                       int        name_length,
+                       int        download,
+                       POSTING    *p_result);
+   /* List the games a player, or anyone in the party, has or needs   */
+int  posting_combine(POSTING *p_first,
+                     POSTING *p_second,
+                     int     operation,
+                     int     game_count,
+                     POSTING *p_result);
+   /* Intersect, join or subtract two lists of games                  */
+int  posting_invert(POSTING *p_posting, int game_count, POSTING *p_result);
+   /* List the games missing from a list                              */
+int  posting_unpack(POSTING *p_posting, int game_count);
+   /* Turn a list kept as bits into game numbers                      */
+int  gallop_to(const int *p_games, int count, int start, int game);
+   /* Find the first place from start holding game or a later one     */
+void free_posting(POSTING *p_posting);
+   /* Free a list of games a query made                               */
+void filter_games(ROSTER *p_roster, GAME_FILTER *p_filter);
+   /* Let the user filter the games on the sheet's extra columns      */
+void print_filter_columns(ROSTER *p_roster, int row);
+   /* List the extra columns a filter can use                         */
+int  compile_game_filter(GAME_FILTER *p_filter, const char *p_text);
+   /* Compile a filter to steps, returns 0 with the reason if it can't*/
+int  parse_filter_any(GAME_FILTER *p_filter);
+   /* Read tests joined by or                                         */
+int  parse_filter_all(GAME_FILTER *p_filter);
+   /* Read tests joined by and, or nothing                            */
+int  parse_filter_test(GAME_FILTER *p_filter);
+   /* Read column op value, not test or (filter)                      */
+int  filter_keyword(GAME_FILTER *p_filter, const char *p_word);
+   /* Skip a keyword if it is next, returns 1 if it was               */
+int  add_filter_step(GAME_FILTER *p_filter, int op);
+   /* Add a step to the filter, returns 0 if there is no room         */
+int  run_game_filter(GAME_FILTER *p_filter, int game_count);
+   /* Run a compiled filter, returns the games kept or -1             */
+void filter_column(const int          *p_values,
+                   int                game_count,
+                   FILTER_STEP        *p_step,
+                   unsigned long long *p_bits);
+   /* Test every value of a column, a word of games at a time         */
+int  filter_allows(GAME_FILTER *p_filter, int game);
+   /* Check if a filter keeps a game                                  */
+void party_control(PLAYER player_list[], 
                    int    amount_of_players, 
                    int    player_id, 
                    int    *p_party_count);
    /* Add, drop, and count members in the party                       */
-WHEEL *filter_list(GAME   game_list[MAX_GAMES], 
-                   PLAYER player_list[MAX_PLAYERS], 
-                   int    amount_of_games, 
-                   int    amount_of_players, 
-                   int    party_count);
+WHEEL *filter_list(ROSTER       *p_roster,
+                   int          party_count,
+                   char         willing_to_wait,
+                   GAME_FILTER  *p_filter,
+                   RECENT_PICKS *p_recent);
    /* Filter the list to games members in the party want to play      */
+int  split_party(ROSTER      *p_roster,
+                 char        willing_to_wait,
+                 GAME_FILTER *p_filter,
+                 int         *p_party_count);
+   /* Split a party no game fits into sub-parties that each have one, */
+   /* returns 1 if one of them became the party                       */
+int  count_bits(unsigned long long bits);
+   /* Amount of bits set                                              */
+int  lowest_bit(unsigned long long bits);
+   /* Place of the lowest bit set, bits can't be 0                    */
+int  compare_split_games(const void *p_first, const void *p_second);
+   /* Order games with the most members able to play them first       */
+int  build_split_games(SPLIT_GAME *p_games, int game_count);
+   /* Keep just the games no other game covers, returns how many      */
+void solve_split(SPLIT_SEARCH *p_search);
+   /* Search every core for the split letting the most members play   */
+void *split_search_worker(void *p_data);
+   /* Search the tasks that fall to one thread                        */
+void split_place(SPLIT_WORKER *p_worker,
+                 int          member,
+                 int          group_count,
+                 int          placed,
+                 int          single_count);
+   /* Try every sub-party for a member, then the members after it     */
+int  split_beats(int covered, int group_count, int task,
+                 int best_covered, int best_group_count, int best_task);
+   /* Check if a split scores better than the best one                */
+void print_split_names(ROSTER             *p_roster,
+                       unsigned long long group,
+                       int                row,
+                       int                col);
+   /* Print the names of a sub-party's members on one line            */
+int  party_file_main(int argc, char *argv[]);
+   /* Check the parties in a file against the games, then quit        */
+int  add_party_line(PARTY_BATCH *p_batch,
+                    int         *p_capacity,
+                    char        *p_line,
+                    int         line_number);
+   /* Add the party on a line, or every sub-party of a '*' line       */
+int  check_parties(PARTY_BATCH *p_batch, int keep_sets);
+   /* Count the games each party can play, sharing out the parties    */
+void *check_parties_worker(void *p_data);
+   /* Check one thread's run of parties                               */
+void free_party_batch(PARTY_BATCH *p_batch);
+   /* Free the parties of a batch and its answers                     */
+void  *arena_alloc(ARENA *p_arena, size_t size);
+   /* Hand out memory that lasts until the arena is reset             */
+void  arena_reset(ARENA *p_arena);
+   /* Give back everything the session allocated at once              */
+void  arena_free(ARENA *p_arena);
+   /* Free the arena's blocks for good                                */
 WHEEL *create_game_node(char game_name[MAX_GAME_NAME]);
    /* Create a new game into the wheel list                           */
 WHEEL *insert_game(WHEEL *p_insert_game, char game_name[MAX_GAME_NAME]);
@@ -116,6 +1105,8 @@ int   get_game_count(WHEEL *p_wheel_list);
    /* Get the amount of games in the wheel list                       */
 void  wheel(WHEEL **p_current_game, int amount_of_games);
    /* Spin the wheel and pick a game                                  */
+void  spin_wheel(WHEEL **p_current_game, int spin_amount);
+   /* Animate the wheel turning a given amount of games               */
 void selected_game(char previous_game[MAX_GAME_NAME],
                    char selected_game[MAX_GAME_NAME],
                    char next_game[MAX_GAME_NAME],
@@ -123,23 +1114,26 @@ void selected_game(char previous_game[MAX_GAME_NAME],
    /* Display the selected game from the wheel                        */
 void clear_screen();
 
-void  remove_game(WHEEL *p_wheel_list);
-   /* Remove a game from the wheel list                               */
-void  reset(PLAYER player_list[MAX_PLAYERS], 
+void  remove_game(WHEEL_UNDO *p_undo, WHEEL *p_wheel_list);
+   /* Remove a game from the wheel list, keeping it to undo           */
+int   undo_removal(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list);
+   /* Put the last game removed back where it was                     */
+int   redo_removal(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list);
+   /* Remove the last game put back again                             */
+void  restore_wheel(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list);
+   /* Put every removed game back on the wheel                        */
+void  free_wheel_undo(WHEEL_UNDO *p_undo);
+   /* Forget the removed games                                        */
+void  reset(PLAYER player_list[], 
             WHEEL  **p_wheel_list, 
             int    amount_of_games, 
             int    amount_of_players, 
             int    *p_party_count,
             char   *p_remove_game_check);
    /* Reset all data except the game file                             */
-void  load_data_manual(GAME   game_list[MAX_GAMES],
-                       PLAYER player_list[MAX_PLAYERS],  
-                       int    *p_amount_of_games, 
-                       int    *p_amount_of_players);
+void  load_data_manual(ROSTER *p_roster);
    /* Load a presaved version of the wheelfile if there is none       */
 
-void clear_csv();
-   /* Clear the data in CSV file                                      */
 void clear_game_file();
    /* Clear the data in game file                                     */
 void ncurses_setup();
@@ -148,6 +1142,203 @@ void check_term_size();
 
 int  get_menu_input(int *highlighted_choice, int option_count);
 
+void event_loop_init();
+   /* Set up the event loop and its wake channel                      */
+void event_loop_close();
+   /* Tear down the event loop                                        */
+long long monotonic_ms();
+   /* Milliseconds from a clock that never jumps                      */
+void queue_event(int type, int value, void *p_data, const char *message);
+   /* Add an event to the end of the queue                            */
+void requeue_events(EVENT held[], int held_count);
+   /* Put events set aside back at the front of the queue             */
+void wake_event_loop();
+   /* Wake the event loop from another thread                         */
+void post_event(int type, int value, void *p_data);
+   /* Queue an event from any thread and wake the event loop          */
+void post_status(const char *format, ...);
+   /* Queue a status line message from any thread                     */
+int  background_stopping();
+   /* Check if background work has been told to quit                  */
+void start_timer(int timer_id, int delay, int period);
+   /* Start a one shot or repeating timer                             */
+void stop_timer(int timer_id);
+   /* Stop a timer                                                    */
+int  check_timers();
+   /* Queue due timers and get the wait until the next one            */
+void wait_for_wakeup(int timeout);
+   /* Block until the terminal, a worker or the timeout wakes us      */
+int  next_event(EVENT *p_event);
+   /* Wait for the next event the screen has to handle                */
+int  wait_key();
+   /* Wait for the next key press, handling other events meanwhile    */
+void wait_ms(int delay);
+   /* Pause without blocking resizes and background messages          */
+int  read_number();
+   /* Read a number typed at the cursor                               */
+void show_message(int row, const char *message, int duration);
+   /* Show a message that clears itself after a while                 */
+void *load_worker(void *p_data);
+   /* Load the game and player lists on the worker thread             */
+void start_load(LOAD_JOB *p_job, ROSTER *p_base);
+   /* Start loading the game and player lists in the background       */
+void finish_load(LOAD_JOB *p_job, ROSTER *p_roster);
+   /* Wait for the background load and take its lists                 */
+int  wait_for_players(LOAD_JOB *p_job, ROSTER *p_roster);
+   /* Wait until the party can be picked, taking the players early    */
+void carry_party(ROSTER *p_from, ROSTER *p_to);
+   /* Keep the party picked from one roster's players in another's    */
+void cancel_load(LOAD_JOB *p_job);
+   /* Stop a background load that is no longer needed                 */
+void list_view_init(LIST_VIEW *p_view, int item_count);
+   /* Start a list view at the top of a list                          */
+void list_view_place(LIST_VIEW *p_view, int top_row, int height);
+   /* Put a list view on the screen, e.g. after a resize              */
+void list_view_move(LIST_VIEW *p_view, int cursor);
+   /* Move the highlight, scrolling only as far as needed             */
+int  list_view_key(LIST_VIEW *p_view, int key);
+   /* Handle a navigation key, returns 1 if the key was used          */
+void list_view_draw(LIST_VIEW *p_view,
+                    void (*draw_item)(void *p_items, int item),
+                    void *p_items);
+   /* Draw only the items that fit in the view                        */
+void draw_player_item(void *p_items, int item);
+   /* Draw one row of the player list                                 */
+void draw_wheel_item(void *p_items, int item);
+   /* Draw one row of the wheel list                                  */
+int  view_wheel_list(WHEEL **p_wheel_list);
+   /* Scroll through the games on the wheel, maybe drawing finalists  */
+   /* or running a tournament                                         */
+void draw_finalists(WHEEL *p_games[], int game_count, int finalist_count);
+   /* Move a few games, drawn without repeats, to the front           */
+void print_finalists(WHEEL *p_games[], int finalist_count);
+   /* Print the shortlist of finalists                                */
+WHEEL *keep_finalists(WHEEL *p_games[], int finalist_count);
+   /* Make the wheel just the finalists, dropping the other games     */
+WHEEL *run_tournament(WHEEL *p_games[], int game_count);
+   /* Knock games out until one is left, spinning only the last rounds*/
+void make_search_key(char *p_key, const char *p_name, int key_size);
+   /* Lower-case a name into a search key                             */
+int  trigram_code(const char *p_key);
+   /* Number a three letter gram of a search key                      */
+int  compare_search_keys(const void *p_first, const void *p_second);
+   /* Order search keys alphabetically for qsort                      */
+int  build_search_index(SEARCH_INDEX *p_index,
+                        const char   *p_first_name,
+                        size_t       item_size,
+                        int          item_count,
+                        int          key_size);
+   /* Build the prefix trie and trigram lists over a list's names     */
+void free_search_index(SEARCH_INDEX *p_index);
+   /* Free a search index                                             */
+void search_index_find(SEARCH_INDEX  *p_index,
+                       const char    *p_query,
+                       SEARCH_RESULT *p_result);
+   /* Find names starting with, then names close to, the query        */
+void search_view_init(SEARCH_VIEW  *p_search,
+                      SEARCH_INDEX *p_index,
+                      void         *p_items,
+                      int          item_count);
+   /* Start a search box with nothing typed                           */
+int  search_view_key(SEARCH_VIEW *p_search, int key);
+   /* Edit the query, returns 1 if the key was used                   */
+int  search_view_count(SEARCH_VIEW *p_search);
+   /* Amount of items the search box lets through                     */
+int  search_view_item(SEARCH_VIEW *p_search, int position);
+   /* Item shown at a position of the search results                  */
+void draw_game_item(void *p_items, int item);
+   /* Draw one row of the game lookup list                            */
+void trace_init(int argc, char *argv[]);
+   /* Turn tracing on if the flag or environment variable asks for it */
+long long monotonic_us();
+   /* Microseconds from a clock that never jumps                      */
+long long trace_begin();
+   /* Start timing a stage, costs nothing when timing is off          */
+void trace_end(const char *p_name, const char *p_category, long long start);
+   /* Record a stage that started at trace_begin()                    */
+void trace_span(const char *p_name,
+                const char *p_category,
+                long long  start,
+                long long  duration);
+   /* Record a stage with a known start and length                    */
+void trace_download(CURL *curl_handle, long long start);
+   /* Record the connection stages curl timed for a download          */
+void trace_close();
+   /* Write the Chrome trace-event file and stop tracing              */
+void metrics_init(int argc, char *argv[]);
+   /* Turn metrics on if the flag or environment variable asks for it*/
+void metrics_observe(int stage, long long start);
+   /* Record how long a stage took since trace_begin()                */
+void metrics_count(int counter);
+   /* Add one to a counter                                            */
+void metrics_arena(ARENA *p_arena);
+   /* Record a session arena's peak and allocations                   */
+int  histogram_bucket(long long value);
+   /* Find the histogram bucket a sample falls in                     */
+long long histogram_bucket_limit(int bucket);
+   /* Largest sample a histogram bucket holds                         */
+void metrics_write();
+   /* Atomically rewrite the Prometheus textfile                      */
+void metrics_close();
+   /* Write the metrics one last time and stop recording              */
+void history_open(int argc, char *argv[]);
+   /* Open the spin journal, checking only what follows its checkpoint*/
+void history_close();
+   /* Close the spin journal                                          */
+void history_record_spin(ROSTER     *p_roster,
+                         int        eligible_count,
+                         const char *p_game_name,
+                         int        rerolled);
+   /* Append a spin to the journal                                    */
+void history_checkpoint();
+   /* Close a block of spins with their count and checksum            */
+int  history_append(SPIN_RECORD *p_record);
+   /* Write a record at the end of the journal                        */
+int  history_block_ok(const SPIN_RECORD *p_records, long long checkpoint);
+   /* Check a checkpoint against the spins it closes                  */
+unsigned long long history_party(ROSTER *p_roster, int *p_party_size);
+   /* Hash the party's names, the same in any order                   */
+int  history_top_games(long long since, HISTORY_TOP top[], int max_top);
+   /* Find the games picked most since a point in time                */
+long long history_last_played(unsigned long long party,
+                              const char         *p_game_name);
+   /* Find when a party, or anyone when party is 0, last kept a game  */
+void history_recent_picks(unsigned long long party,
+                          RECENT_PICKS       *p_recent);
+   /* Find the games a party kept in its last few sessions            */
+int  recently_picked(RECENT_PICKS *p_recent, const char *p_game_name);
+   /* Check if the party kept a game in its last few sessions         */
+long long month_start();
+   /* When the current month started, in seconds                      */
+void print_top_games(HISTORY_TOP top[], int top_count, int row);
+   /* Print this month's most picked games                            */
+int  map_file(const char *file_name, MAPPED_FILE *p_map);
+   /* Map a whole file into memory to read                            */
+void unmap_file(MAPPED_FILE *p_map);
+   /* Unmap a file mapped to read                                     */
+void session_init(int argc, char *argv[]);
+   /* Start recording or replaying a session if a flag asks for it    */
+int  session_close();
+   /* Finish the session, returning the program's exit code           */
+void session_fail(const char *p_reason);
+   /* Stop a replay that no longer follows its recording              */
+void session_expect(char type);
+   /* Read the kind of the next entry of a replay, which must match   */
+void session_screen();
+   /* Save the screen size, or bring back the one saved, for a replay */
+void session_roster(ROSTER *p_roster);
+   /* Save the lists in use, or load the ones saved, for a replay     */
+unsigned int session_seed();
+   /* Seed for a spin, saved or played back                           */
+int  session_key(int key);
+   /* Save a key press, for a replay                                  */
+int  session_replay_key();
+   /* Next key press of a replay                                      */
+void session_recent_picks(RECENT_PICKS *p_recent);
+   /* Save the games resting, or play back the ones saved             */
+void session_pick(const char *p_game_name);
+   /* Save or check a game picked                                     */
+
 /**********************************************************************/
 /*                            Enumerations                            */ 
 /**********************************************************************/
@@ -169,19 +1360,108 @@ enum
     CP_SCROLL           /* Scroll indicator                           */
 };
 
+enum
+{
+    EV_KEY = 1,         /* Key pressed                                */
+    EV_RESIZE,          /* Terminal was resized                       */
+    EV_TIMER,           /* Timer fired                                */
+    EV_STATUS,          /* Status message from a worker               */
+    EV_WORK_DONE,       /* Background job finished                    */
+    EV_PLAYERS_READY    /* Background job has the players, not games  */
+};
+
+enum
+{
+    TIMER_ANIMATION,    /* Wheel animation frames                     */
+    TIMER_MESSAGE,      /* Clears the transient message               */
+    TIMER_WAIT,         /* Ends a wait_ms pause                       */
+    TIMER_METRICS       /* Rewrites the metrics textfile              */
+};
+enum
+{
+    STAGE_FETCH,        /* Downloading the sheet                      */
+    STAGE_PARSE,        /* Converting and reading the sheet           */
+    STAGE_FILTER,       /* Filtering games onto the wheel             */
+    STAGE_SPIN          /* Spinning the wheel                         */
+};
+enum
+{
+    RECORD_HEADER = 1,  /* First record, naming the journal's format  */
+    RECORD_SPIN,        /* One spin of the wheel                      */
+    RECORD_CHECKPOINT   /* Count and checksum of the spins before it  */
+};
+enum
+{
+    QUERY_AND,          /* Games in both lists                        */
+    QUERY_OR,           /* Games in either list                       */
+    QUERY_AND_NOT       /* Games in the first list but not the second */
+};
+enum
+{
+    FILTER_TEST,        /* Games whose value is in (or out of) a range*/
+    FILTER_AND,         /* Games in both of the last two results      */
+    FILTER_OR,          /* Games in either of the last two results    */
+    FILTER_NOT          /* Games missing from the last result         */
+};
+enum
+{
+    WHEEL_SHORTLIST,    /* Shortlist drawn, nothing to spin           */
+    WHEEL_SPIN,         /* Spin the wheel for a game                  */
+    WHEEL_DECIDED       /* Tournament already left one game           */
+};
+enum
+{
+    SESSION_OFF,        /* Nothing recorded or replayed               */
+    SESSION_RECORD,     /* Saving the session to replay later         */
+    SESSION_REPLAY      /* Playing a saved session back headless      */
+};
+enum
+{
+    COUNT_DOWNLOADS,    /* Sheets downloaded                          */
+    COUNT_DOWNLOAD_ERRORS, /* Downloads that failed                   */
+    COUNT_CACHE_HITS,   /* Loads served from local data               */
+    COUNT_REROLLS,      /* Games removed to spin again                */
+    COUNT_ALLOC_ERRORS  /* Session memory that could not be allocated */
+};
+
+/**********************************************************************/
+/*                          Global Variables                          */
+/**********************************************************************/
+static EVENT_LOOP event_loop; /* Drives every screen of the program    */
+static TRACER     tracer;     /* Times the stages of a session         */
+static METRICS    metrics;    /* Latencies and counts across sessions  */
+static SOURCES    sources;    /* Sheets merged into every roster       */
+static HISTORY    history;    /* Journal of every spin                 */
+static SESSION    session;    /* Session being recorded or replayed    */
+static ARENA      session_arena; /* Memory for the session being played */
+
+/**********************************************************************/
+/*                          Fallback Roster                           */
+/**********************************************************************/
+#include "wheel_roster.h" /* Built from the sheet by roster_compiler  */
+
 /**********************************************************************/
 /*                           Main Function                            */
 /**********************************************************************/
-int main()
+int main(int argc, char *argv[])
 {
-   GAME   game_list[MAX_GAMES];
-   PLAYER player_list[MAX_PLAYERS];
+   ROSTER   roster;
+   LOAD_JOB load_job;
+   RECENT_PICKS recent_picks;
+   WHEEL_UNDO wheel_undo;
    WHEEL  *p_wheel_list             = NULL;
    char   remove_game_check         = 'y';
-   int    amount_of_games,
-          amount_of_players,
-          party_count               = 0,
-          player_id;
+   int    party_count               = 0;
+   int    party_size;
+   int    eligible_count;
+   int    wheel_choice;
+   char   willing_to_wait;
+   GAME_FILTER game_filter;
+   int    exit_code;
+   int    loading;
+
+   memset(&roster, 0, sizeof(roster));
+   memset(&wheel_undo, 0, sizeof(wheel_undo));
 
    /* Automatically resize CMD window to required size BEFORE ncurses */
    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
@@ -191,8 +1471,31 @@ int main()
    SetConsoleScreenBufferSize(hConsole, bufferSize);
    SetConsoleWindowInfo(hConsole, TRUE, &windowSize);
 
+   /* Start tracing before anything worth timing has happened         */
+   trace_init(argc, argv);
+   metrics_init(argc, argv);
+   sources_init(argc, argv);
+   session_init(argc, argv);
+
+   /* Initialize curl once, before any thread can use it             */
+   curl_global_init(CURL_GLOBAL_ALL);
+
+   /* A file of parties is checked in one batch, with no screen       */
+   exit_code = party_file_main(argc, argv);
+   if (exit_code >= 0)
+   {
+      curl_global_cleanup();
+      trace_close();
+      metrics_close();
+      return exit_code;
+   }
+
    /* Initialize ncurses                                              */
    ncurses_setup();
+   event_loop_init();
+   history_open(argc, argv);
+   if (metrics.enabled)
+      start_timer(TIMER_METRICS, METRICS_PERIOD, METRICS_PERIOD);
 
    //check_term_size();
 
@@ -201,6 +1504,9 @@ int main()
    print_heading();
    print_instructions();
    refresh();
+
+   /* Download the game list while the user reads the prompt          */
+   start_load(&load_job, &roster);
    
    /* Loop processing a game to play until the user says to quit      */
    while (get_response(1) == 'y')
@@ -208,81 +1514,111 @@ int main()
       clear_screen();
       refresh();
       
-      load_data_file(game_list, player_list, &amount_of_games, 
-                                                    &amount_of_players);
+      /* The party can be picked while the games are still loading    */
+      loading = wait_for_players(&load_job, &roster);
 
-      if (amount_of_games > 0 && amount_of_players > 0)
+      if (roster.amount_of_players > 0 &&
+          (loading || roster.amount_of_games > 0))
       {
-         /* Clear and draw player list ONCE before loop               */
-         clear_screen();
-         move(HEADER_ROWS - 2, 0);
-         clrtoeol();
-         printw("Use the number and enter keys to select players");
-         print_players(player_list, amount_of_players);
-         refresh();
-
          /* Loop processing party until the user says to quit         */
-         while (1)
+         party_select(&roster, loading ? &load_job : NULL, &party_count);
+
+         /* Only the filter has to wait for the games, and a member   */
+         /* missing from the loaded sheet drops out of the party      */
+         if (load_job.early)
          {
-            /* Display party status (overwrites previous line)        */
-            move(HEADER_ROWS + amount_of_players + 4, 0);
-            clrtoeol();
-            printw("Party (%d):", party_count);
-            for (int i = 0; i < amount_of_players; i++)
-            {
-               if (player_list[i].party_status == 1)
-                  printw(" %s", player_list[i].player_name);
-            }
-            
-            /* Display input prompt                                   */
-            move(HEADER_ROWS, 0);
-            clrtoeol();
-            printw("Who do you want to add or remove from the party\n");
-            printw("(%d to quit): ", QUIT);
-            refresh();
-            
-            echo();
-            curs_set(0);
-            scanw("%d", &player_id);
-            curs_set(0);
-            noecho();
-            
-            if (player_id <= QUIT)
-               break;
-               
-            party_control(player_list, amount_of_players,
-                          player_id, &party_count);
+            finish_load(&load_job, &roster);
+            history_party(&roster, &party_count);
          }
 
          clear_screen();
          
          if (party_count > 0)
          {
-            /* Filter the game list into the wheel list               */
-            p_wheel_list = filter_list(game_list, player_list, 
-                                       amount_of_games, amount_of_players,
-                                       party_count);
+            /* Filter the game list into the wheel list, resting      */
+            /* what the party played lately                           */
+            history_recent_picks(history_party(&roster, &party_size),
+                                 &recent_picks);
+            session_recent_picks(&recent_picks);
+            willing_to_wait = get_response(2);
+
+            /* A sheet with extra columns can be filtered on them too */
+            memset(&game_filter, 0, sizeof(game_filter));
+            if (roster.attributes.count > 0)
+               filter_games(&roster, &game_filter);
+            p_wheel_list = filter_list(&roster,
+                                       party_count,
+                                       willing_to_wait,
+                                       &game_filter,
+                                       &recent_picks);
+
+            /* No game fits everyone, so offer to split the party and */
+            /* filter again for the sub-party picked                  */
+            if (p_wheel_list == NULL && party_count > 2 &&
+                split_party(&roster, willing_to_wait, &game_filter,
+                            &party_count))
+            {
+               history_recent_picks(history_party(&roster, &party_size),
+                                    &recent_picks);
+               session_recent_picks(&recent_picks);
+               p_wheel_list = filter_list(&roster,
+                                          party_count,
+                                          willing_to_wait,
+                                          &game_filter,
+                                          &recent_picks);
+            }
             
             if (p_wheel_list != NULL)
             {
-               /* Spin the wheel list and pick a game                 */
-               while (remove_game_check == 'y' && 
-                      p_wheel_list->p_next_game != p_wheel_list)
+               /* Let the party see what made it onto the wheel, or   */
+               /* settle on a shortlist or tournament without a spin  */
+               eligible_count = get_game_count(p_wheel_list);
+               wheel_choice   = view_wheel_list(&p_wheel_list);
+               if (wheel_choice == WHEEL_DECIDED)
+               {
+                  session_pick(p_wheel_list->p_next_game->game_name);
+                  history_record_spin(&roster, eligible_count,
+                                      p_wheel_list->p_next_game->game_name,
+                                      0);
+                  remove_game_check = 'n';
+               }
+               if (wheel_choice != WHEEL_SHORTLIST)
                {
-                  wheel(&p_wheel_list, get_game_count(p_wheel_list)); 
+                  /* Spin the wheel list and pick a game              */
+                  while (remove_game_check != 'n' && 
+                         p_wheel_list->p_next_game != p_wheel_list)
+                  {
+                     /* An undone reroll brings its pick straight back */
+                     if (remove_game_check != 'u')
+                        wheel(&p_wheel_list, get_game_count(p_wheel_list)); 
+                     selected_game(p_wheel_list->game_name,
+                                   p_wheel_list->p_next_game->game_name,
+                                   p_wheel_list->p_next_game->p_next_game->game_name,
+                                   get_game_count(p_wheel_list));
+                     session_pick(p_wheel_list->p_next_game->game_name);
+                     remove_game_check = get_response(3);
+                     if (remove_game_check == 'y' || remove_game_check == 'n')
+                        history_record_spin(&roster,
+                                            get_game_count(p_wheel_list),
+                                            p_wheel_list->p_next_game->game_name,
+                                            remove_game_check == 'y');
+                     if ((p_wheel_list != p_wheel_list->p_next_game) &&
+                        (remove_game_check == 'y'))
+                        remove_game(&wheel_undo, p_wheel_list);
+                     else if (remove_game_check == 'u')
+                        undo_removal(&wheel_undo, &p_wheel_list);
+                     else if (remove_game_check == 'r' &&
+                              !redo_removal(&wheel_undo, &p_wheel_list))
+                        remove_game_check = 'u'; /* Nothing to redo,*/
+                                                 /* so keep the pick*/
+                     else if (remove_game_check == 'o')
+                        restore_wheel(&wheel_undo, &p_wheel_list);
+                  }
                   selected_game(p_wheel_list->game_name,
                                 p_wheel_list->p_next_game->game_name,
                                 p_wheel_list->p_next_game->p_next_game->game_name,
                                 get_game_count(p_wheel_list));
-                  remove_game_check = get_response(3);
-                  if ((p_wheel_list != p_wheel_list->p_next_game) &&
-                     (remove_game_check == 'y'))
-                     remove_game(p_wheel_list);
                }
-               selected_game(p_wheel_list->game_name,
-                             p_wheel_list->p_next_game->game_name,
-                             p_wheel_list->p_next_game->p_next_game->game_name,
-                             get_game_count(p_wheel_list));
             }
             else
             {
@@ -290,7 +1626,7 @@ int main()
                mvprintw(15, 10, "No games in this list");
                mvprintw(16, 10, "Press any key to continue...");
                refresh();
-               getch();
+               wait_key();
                clear_screen();
             }
          }
@@ -300,19 +1636,31 @@ int main()
             mvprintw(15, 10, "No members in the party");
             mvprintw(16, 10, "Press any key to continue...");
             refresh();
-            getch();
+            wait_key();
             clear_screen();
          }
 
-         reset(player_list, &p_wheel_list, amount_of_games,
-               amount_of_players, &party_count, &remove_game_check);
+         reset(roster.player_list, &p_wheel_list, roster.amount_of_games,
+               roster.amount_of_players, &party_count, &remove_game_check);
+         free_wheel_undo(&wheel_undo);
       }
+
+      /* Fetch a fresh list for the next round in the background     */
+      start_load(&load_job, &roster);
    }
    
    /* Cleanup and print goodbye message                               */
+   cancel_load(&load_job);
+   free_roster(&roster);
+   arena_free(&session_arena);
+   event_loop_close();
    endwin();
+   curl_global_cleanup();
+   history_close();
+   trace_close();
+   metrics_close();
    printf("\nThank you for using wheel. Have a nice day! :>\n\n");
-   return 0;
+   return session_close();
 }
 
 /**********************************************************************/
@@ -354,903 +1702,8845 @@ void print_instructions()
 /**********************************************************************/
 /*                        Load data from file                         */
 /**********************************************************************/
-void load_data_file(GAME   game_list[MAX_GAMES],
-                    PLAYER player_list[MAX_PLAYERS],
-                    int    *p_amount_of_games, 
-                    int    *p_amount_of_players)
+void load_data_file(ROSTER *p_roster)
 {
    FILE *p_game_file;  /* Points to file containing game and player   */
                        /* information                                 */
-   int player_counter, /* Count through each player in it's list      */
-       game_counter;   /* Count through each game  in it's list       */
-   int row = 1;        /* Row for status messages                     */
-
-   download_csv(WHEEL_URL, CSV_FILE);
-
-   /* Parse CSV into space-separated format                           */
-   file_converter(CSV_FILE, GAME_FILE);
+   long long start;    /* When reading the game file started          */
 
    /* Get info from game file                                         */
+   start       = trace_begin();
    p_game_file = fopen(GAME_FILE, "r");
-   if (p_game_file != NULL) 
+   if (p_game_file != NULL)
    {
-      /* Get amount of players and amount of games                    */
-      fscanf(p_game_file, "%d %d", 
-             p_amount_of_players, p_amount_of_games);
-
-      /* Get list of players                                          */
-      for (player_counter = 0; 
-           player_counter < *p_amount_of_players; 
-           player_counter++)
-         fscanf(p_game_file, "%s", player_list[player_counter].player_name);
-
-      /* Get list of games                                            */
-      for (game_counter = 0; 
-           game_counter < *p_amount_of_games; 
-           game_counter++)
-         fscanf(p_game_file, "%d %s %s", 
-            &game_list[game_counter].player_limit, 
-            game_list[game_counter].game_name, 
-            game_list[game_counter].game_status);
-
+      if (read_lists(p_game_file, p_roster))
+         trace_end("load_data_file", "parse", start);
       fclose(p_game_file);
    }
    else
    {
-      mvprintw(row++, 0, "No local game file found.");
-      mvprintw(row++, 0, "Loading data manually...");
-      refresh();
-      load_data_manual(game_list, player_list, p_amount_of_games, 
-                                                   p_amount_of_players);
+      post_status("No local game file found. Loading data manually...");
+      metrics_count(COUNT_CACHE_HITS);
+      load_data_manual(p_roster);
    }
 
    return;
 }
 
 /**********************************************************************/
-/*              Download CSV from URL and save to file                */
+/*           Read the lists written out like the game file            */
 /**********************************************************************/
-int download_csv(const char *url, const char *filename)
+int read_lists(FILE *p_game_file, ROSTER *p_roster)
 {
-   CURL     *curl_handle;     /* Handle for curl operations            */
-   CURLcode res;              /* Result code from curl                 */
-   FILE     *p_GAME_FILE;     /* Local file to write to                */
-   int      row = HEADER_ROWS; /* Row for status messages               */
-   
-   clear_screen();
-   mvprintw(row, 0, "Downloading CSV from Google Sheets...");
-   refresh();
-   
-   /* Open local file for writing                                     */
-   p_GAME_FILE = fopen(filename, "wb");
-   if (p_GAME_FILE == NULL)
-   {
-      mvprintw(row, 0, "Error: Cannot create file '%s'", filename);
-      refresh();
-      napms(2000);
+   int amount_of_players, /* Players in the file                      */
+       amount_of_games,   /* Games in the file                        */
+       player_counter, /* Count through each player in it's list      */
+       game_counter;   /* Count through each game  in it's list       */
+   char name_format[FORMAT_LEN], /* Reads a player name safely        */
+        game_format[FORMAT_LEN], /* Reads a game row safely           */
+        status[MAX_PLAYERS + 1]; /* One row's statuses, until packed  */
+   GAME *p_game;       /* Game being read                             */
+
+   /* Get amount of players and amount of games                       */
+   if (fscanf(p_game_file, "%d %d",
+              &amount_of_players, &amount_of_games) != 2 ||
+       !allocate_roster(p_roster, amount_of_games, amount_of_players))
       return 0;
+
+   /* Never read more than the names and statuses can hold            */
+   snprintf(name_format, sizeof(name_format), "%%%ds",
+            MAX_PLAYER_NAME - 1);
+   snprintf(game_format, sizeof(game_format), "%%d %%%ds %%%ds",
+            MAX_GAME_NAME - 1, amount_of_players);
+
+   /* Get list of players                                             */
+   for (player_counter = 0;
+        player_counter < amount_of_players;
+        player_counter++)
+      fscanf(p_game_file, name_format,
+             p_roster->player_list[player_counter].player_name);
+
+   /* Get list of games, packing each row's statuses into its bits    */
+   /* as it is read; players missing from a short row count as 'n'  */
+   for (game_counter = 0;
+        game_counter < amount_of_games;
+        game_counter++)
+   {
+      p_game = &p_roster->game_list[game_counter];
+      memset(status, '\0', amount_of_players + 1);
+      fscanf(p_game_file, game_format,
+             &p_game->player_limit, p_game->game_name, status);
+      set_owner_bits(p_roster, game_counter, status);
    }
-   
-   /* Initialize curl                                                 */
-   curl_global_init(CURL_GLOBAL_ALL);
-   curl_handle = curl_easy_init();
-   
-   if (curl_handle) 
-   {
-      /* Configure curl to download and write to file                 */
-      curl_easy_setopt(curl_handle, CURLOPT_URL, url);
-      curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, p_GAME_FILE);
-      curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, 
-                      "Wheel-Program/1.0");
-      curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
-      curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, 0L);
-      
-      /* Perform the download                                         */
-      res = curl_easy_perform(curl_handle);
-      
-      if (res != CURLE_OK) 
-      {
-         mvprintw(row, 0, "Error: %s", curl_easy_strerror(res));
-         refresh();
-         napms(2000);
-         fclose(p_GAME_FILE);
-         curl_easy_cleanup(curl_handle);
-         curl_global_cleanup();
-         return 0;
-      }
-      
-      mvprintw(row, 0, "Download complete!");
-      refresh();
-      curl_easy_cleanup(curl_handle);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*          Allocate game and player lists for the given amounts      */
+/**********************************************************************/
+int allocate_lists(GAME   **p_game_list,
+                   PLAYER **p_player_list,
+                   int    amount_of_games,
+                   int    amount_of_players)
+{
+   *p_game_list   = NULL;
+   *p_player_list = NULL;
+
+   if (amount_of_games   < 0 || amount_of_games   > MAX_GAMES ||
+       amount_of_players < 0 || amount_of_players > MAX_PLAYERS)
+   {
+      post_status("Error: %d games and %d players is too many",
+                  amount_of_games, amount_of_players);
+      return 0;
    }
-   else
+
+   /* Statuses live in the roster's bits, so a game is just its name  */
+   /* and limit                                                       */
+   *p_game_list   = (GAME*) calloc(amount_of_games + 1, sizeof(GAME));
+   *p_player_list = (PLAYER*) calloc(amount_of_players + 1,
+                                     sizeof(PLAYER));
+   if (*p_game_list == NULL || *p_player_list == NULL)
    {
-      mvprintw(row, 0, "Error: Could not initialize curl");
-      refresh();
-      napms(2000);
-      fclose(p_GAME_FILE);
-      curl_global_cleanup();
+      post_status("Error: Cannot allocate memory for %d games",
+                  amount_of_games);
+      free_lists(*p_game_list, *p_player_list);
+      *p_game_list   = NULL;
+      *p_player_list = NULL;
       return 0;
    }
-   
-   fclose(p_GAME_FILE);
-   curl_global_cleanup();
-   
-   return 1;  /* Success                                              */
+
+   return 1;
 }
 
 /**********************************************************************/
-/*              Parse CSV and convert to space-separated format       */
+/*       Allocate a roster's lists and bits for the given amounts     */
 /**********************************************************************/
-void file_converter(const char *input_file, const char *output_file)
+int allocate_roster(ROSTER *p_roster,
+                    int    amount_of_games,
+                    int    amount_of_players)
 {
-   FILE *p_input;          /* Input CSV file                          */
-   FILE *p_output;         /* Output space-separated file             */
-   char line[256];         /* Buffer to hold each line                */
-   int  player_count,      /* Number of players                       */
-        game_count;        /* Number of games                         */
-   int  player_counter,    /* Count through players                   */
-        game_counter;      /* Count through games                     */
-   char player_names[MAX_PLAYERS][MAX_PLAYER_NAME]; /* Store names    */
-   int  player_limit;      /* Player limit for each game              */
-   char game_name[MAX_GAME_NAME]; /* Game name                        */
-   char status_char;       /* Individual status character             */
-   int  row = 18;           /* Row for status messages                 */
-   
-   mvprintw(row, 0, "Parsing CSV file...");
-   refresh();
-   
-   /* Open input CSV file                                             */
-   p_input = fopen(input_file, "r");
-   if (p_input == NULL)
+   size_t word_count; /* Words of bits for the whole roster           */
+
+   if (!allocate_lists(&p_roster->game_list, &p_roster->player_list,
+                       amount_of_games, amount_of_players))
+      return 0;
+   p_roster->amount_of_games   = amount_of_games;
+   p_roster->amount_of_players = amount_of_players;
+
+   /* Who has and who has to download every game, a bit per player,   */
+   /* filled in as the rows are read so no row is kept as text        */
+   p_roster->player_words = (amount_of_players + 63) / 64;
+   word_count = (size_t) p_roster->player_words * amount_of_games + 1;
+   p_roster->p_have_bits     = (unsigned long long *)
+      calloc(word_count, sizeof(unsigned long long));
+   p_roster->p_download_bits = (unsigned long long *)
+      calloc(word_count, sizeof(unsigned long long));
+   if (p_roster->p_have_bits == NULL || p_roster->p_download_bits == NULL)
    {
-      mvprintw(row, 0, "Error: Cannot open %s", input_file);
-      refresh();
-      napms(2000);
-      return;
+      post_status("Error: Cannot allocate memory for %d games",
+                  amount_of_games);
+      free_roster(p_roster);
+      return 0;
    }
-   
-   /* Skip first line (headers: "Player Count,Game Count,,,," )       */
-   fgets(line, sizeof(line), p_input);
-   
-   /* Read second line with counts                                    */
-   fscanf(p_input, "%d,%d", &player_count, &game_count);
-   fgets(line, sizeof(line), p_input); /* Skip rest of line           */
-   
-   /* Read third line and extract player names                        */
-   fscanf(p_input, "%*[^,],%*[^,]"); /* Skip "Player Limit,Game"      */
-   for (player_counter = 0; 
-        player_counter < player_count; 
-        player_counter++)
-   {
-      fscanf(p_input, ",%[^,\n]", player_names[player_counter]);
-   }
-   fgets(line, sizeof(line), p_input); /* Skip rest of line           */
-   
-   /* Open output file for writing                                    */
-   p_output = fopen(output_file, "w");
-   if (p_output == NULL)
-   {
-      mvprintw(row, 0, "Error: Cannot create %s", output_file);
-      refresh();
-      napms(2000);
-      fclose(p_input);
-      return;
-   }
-   
-   /* Write player count and game count (space-separated)             */
-   fprintf(p_output, "%d %d\n", player_count, game_count);
-   
-   /* Write player names (space-separated)                            */
-   for (player_counter = 0; 
-        player_counter < player_count; 
-        player_counter++)
-   {
-      fprintf(p_output, "%s", player_names[player_counter]);
-      if (player_counter < player_count - 1)
-         fprintf(p_output, " ");
-   }
-   fprintf(p_output, "\n");
-   
-   /* Read and write game data                                        */
-   for (game_counter = 0; game_counter < game_count; game_counter++)
-   {
-      /* Read player limit and game name                              */
-      fscanf(p_input, "%d,%[^,]", &player_limit, game_name);
-      
-      /* Write player limit and game name (space-separated)           */
-      fprintf(p_output, "%d %s ", player_limit, game_name);
-      
-      /* Read each player's status and write as combined string       */
-      for (player_counter = 0; 
-           player_counter < player_count; 
-           player_counter++)
-      {
-         fscanf(p_input, ",%c", &status_char);
-         fprintf(p_output, "%c", status_char);
-      }
-      fprintf(p_output, "\n");
-      
-      fgets(line, sizeof(line), p_input); /* Skip rest of line        */
-   }
-   
-   fclose(p_input);
-   fclose(p_output);
-   
-   mvprintw(row, 0, "Parsing complete!");
-   refresh();
-   
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                    Free game and player lists                      */
+/**********************************************************************/
+void free_lists(GAME *game_list, PLAYER *player_list)
+{
+   free(game_list);
+   free(player_list);
+
    return;
 }
 
 /**********************************************************************/
-/*                      Get a yes or no response                      */
+/*    Load the lists, or just what changed since the roster in use    */
 /**********************************************************************/
-char get_response(int response_type)
+void load_roster(ROSTER       *p_roster,
+                 ROSTER       *p_base,
+                 ROSTER_DELTA *p_delta,
+                 LOAD_JOB     *p_early)
 {
-   int selected = 0;  /* 0 = Yes, 1 = No                              */
-   int key;           /* Key pressed by user                          */
-   int row = HEADER_ROWS;           /* Row position for prompt        */
+   PARSED_SHEET parsed[MAX_SOURCES]; /* Each source's sheet, parsed   */
+   ATTRIBUTES attributes;    /* Extra columns, kept with a delta      */
+   int       sheet_counter,  /* Count through each source's sheet     */
+             fetched;        /* Lists came from the sheets            */
+   long long parse_start;    /* When merging the sheets started       */
 
-   move(HEADER_ROWS - 2, 0);
-   clrtoeol();
-   printw("Use the arrow and enter keys to select");
+   /* Fetch every source at once, parsing each sheet straight from    */
+   /* memory (or its last saved copy when the download failed), then  */
+   /* merge them into the lists in memory                             */
+   fetch_sheets(parsed, p_early);
+   parse_start = trace_begin();
+   fetched = sheets_to_lists(parsed, sources.count, p_roster);
+   write_attribute_file(parsed, sources.count, ATTRIBUTE_FILE);
+   for (sheet_counter = 0; sheet_counter < sources.count; sheet_counter++)
+      free_parsed_sheet(&parsed[sheet_counter]);
 
-   switch(response_type)  /* Print message based on type */
+   /* With no sheet at all, the game file from the last good load is  */
+   /* all there is                                                    */
+   if (!fetched)
+      load_data_file(p_roster);
+   load_attributes(p_roster->game_list, p_roster->amount_of_games,
+                   &p_roster->attributes);
+   metrics_observe(STAGE_PARSE, parse_start);
+   hash_roster(p_roster);
+
+   /* With the same players and games as the roster in use, only the  */
+   /* rows that changed are carried back to be patched into it        */
+   memset(p_delta, 0, sizeof(*p_delta));
+   if (p_base != NULL && diff_rosters(p_base, p_roster, p_delta))
    {
-      case 1:
-         mvprintw(row, 0, "Spin for game?");
-         break;
-      case 2:
-         move(HEADER_ROWS, 0);
-         clrtoeol();
-         clear_screen();
-         mvprintw(row, 0, "Include games that need updates or downloads?");
-         break;
-      case 3:
-         clear_csv();
-         clear_game_file();
-         mvprintw(row, 0, "Remove and reroll?");
-         break;
+      /* Rows that are all as they were are already in the game file  */
+      if (fetched && p_delta->change_count > 0)
+         write_game_file(p_roster, GAME_FILE);
+      attributes = p_roster->attributes;
+      memset(&p_roster->attributes, 0, sizeof(ATTRIBUTES));
+      free_roster(p_roster);
+      p_roster->attributes = attributes;
+      return;
    }
-   
-   /* Loop until user presses Enter                                   */
-   while(1)
+   if (fetched)
+      write_game_file(p_roster, GAME_FILE);
+
+   build_postings(p_roster);
+
+   /* A list whose names are all as they were keeps its search index  */
+   if (p_base != NULL)
    {
-      /* Display the options with highlighting                        */
-      move(row + 2, 5);
-      clrtoeol();
-      
-      if (selected == 0)
-         attron(A_REVERSE);  /* Highlight Yes                         */
-      printw("[ Yes ]");
-      if (selected == 0)
-         attroff(A_REVERSE);
-      
-      printw("    ");
-      
-      if (selected == 1)
-         attron(A_REVERSE);  /* Highlight No                          */
-      printw("[ No ]");
-      if (selected == 1)
-         attroff(A_REVERSE);
-      
-      refresh();
-      
-      /* Get user input using menu navigation function                */
-      key = get_menu_input(&selected, 2);
-      
-      /* Check if Enter was pressed                                   */
-      if (key == '\n')
-      {
-         /* Clear the prompt area                                     */
-         move(row, 0);
-         clrtoeol();
-         move(row + 2, 0);
-         clrtoeol();
-         refresh();
-         
-         if (selected == 0)
-            return 'y';
-         else
-            return 'n';
-      }
+      p_delta->keep_game_index = p_base->game_index.ready &&
+         p_base->amount_of_games == p_roster->amount_of_games &&
+         names_match((const char *) p_base->game_list +
+                        offsetof(GAME, game_name),
+                     (const char *) p_roster->game_list +
+                        offsetof(GAME, game_name),
+                     sizeof(GAME), p_roster->amount_of_games);
+      p_delta->keep_player_index = p_base->player_index.ready &&
+         p_base->amount_of_players == p_roster->amount_of_players &&
+         names_match((const char *) p_base->player_list +
+                        offsetof(PLAYER, player_name),
+                     (const char *) p_roster->player_list +
+                        offsetof(PLAYER, player_name),
+                     sizeof(PLAYER), p_roster->amount_of_players);
    }
+
+   /* Built once here, off the UI thread, so typing only ever queries */
+   if (p_roster->game_list != NULL && !p_delta->keep_game_index)
+      build_search_index(&p_roster->game_index,
+                         (const char *) p_roster->game_list +
+                            offsetof(GAME, game_name),
+                         sizeof(GAME), p_roster->amount_of_games,
+                         MAX_GAME_NAME);
+   if (p_roster->player_list != NULL && !p_delta->keep_player_index)
+      build_search_index(&p_roster->player_index,
+                         (const char *) p_roster->player_list +
+                            offsetof(PLAYER, player_name),
+                         sizeof(PLAYER), p_roster->amount_of_players,
+                         MAX_PLAYER_NAME);
+
+   return;
 }
 
 /**********************************************************************/
-/*                     Print the list of players                      */
+/*               Free everything loaded from the sheet                */
 /**********************************************************************/
-void print_players(PLAYER player_list[MAX_PLAYERS], 
-                   int    amount_of_players)
+void free_roster(ROSTER *p_roster)
 {
-   int player_counter; /* Count through each player in it's list       */
-   int row = HEADER_ROWS + 3; /* Starting row position                        */
+   free_lists(p_roster->game_list, p_roster->player_list);
+   free_search_index(&p_roster->game_index);
+   free_search_index(&p_roster->player_index);
+   free(p_roster->row_hashes);
+   free(p_roster->p_have_bits);
+   free(p_roster->p_download_bits);
+   free_postings(p_roster);
+   free_attributes(&p_roster->attributes);
+   memset(p_roster, 0, sizeof(*p_roster));
 
-   move(row, 0);
-   clrtoeol();
+   return;
+}
 
-   mvprintw(row++, 0, "Players:");
-   
-   if (amount_of_players > 0)
-   {
-      for (player_counter = 0; 
-           player_counter < amount_of_players; 
-           player_counter++)
-      {
-         mvprintw(row++, 2, "%d. %s", player_counter + 1, 
-                  player_list[player_counter].player_name);
-      }
-   }
-   else
+/**********************************************************************/
+/*                 Hash the content of every game row                 */
+/**********************************************************************/
+void hash_roster(ROSTER *p_roster)
+{
+   GAME *p_game;      /* Game being hashed                            */
+   int  game_counter; /* Count through each game in it's list         */
+
+   if (p_roster->game_list == NULL)
+      return;
+   p_roster->row_hashes = (unsigned long long *)
+      malloc(sizeof(unsigned long long) * (p_roster->amount_of_games + 1));
+   if (p_roster->row_hashes == NULL)
+      return; /* Without hashes the next refresh loads everything     */
+
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
    {
-      mvprintw(row, 2, "Empty!");
+      p_game = &p_roster->game_list[game_counter];
+      p_roster->row_hashes[game_counter] =
+         row_hash(p_game->player_limit, p_game->game_name,
+                  (int) strlen(p_game->game_name),
+                  p_roster->p_have_bits +
+                     (size_t) game_counter * p_roster->player_words,
+                  p_roster->p_download_bits +
+                     (size_t) game_counter * p_roster->player_words,
+                  p_roster->player_words);
    }
 
-   refresh();
    return;
 }
 
 /**********************************************************************/
-/*             Add, drop, and count members in the party              */
+/*               Pack one game's statuses into its bits               */
 /**********************************************************************/
-void party_control(PLAYER player_list[MAX_PLAYERS], 
-                   int    amount_of_players, 
-                   int    player_id, 
-                   int    *p_party_count)
+void set_owner_bits(ROSTER *p_roster, int game, const char *p_status)
 {
-   int player_counter; /* Count through each player in it's list      */
-   int row;            /* Row position for output                     */
-   
-   /* Update player status and party count                            */
-   if (player_id <= amount_of_players)
-   {
-      if (player_list[player_id - 1].party_status != 1)
-      {
-         player_list[player_id - 1].party_status = 1;
-         *p_party_count += 1;
-      }
-      else
-      {
-         player_list[player_id - 1].party_status = 0;
-         *p_party_count -= 1;
-      }
-   }
-   else
-   {
-      mvprintw(HEADER_ROWS + amount_of_players + 4, 0, "!!PLAYER NOT IN LIST!!");
-      refresh();
-      napms(1000);  /* Show error for 1 second                       */
-      move(row, 0);
-      clrtoeol();
-   }
-   
-   refresh();
+   unsigned long long *p_have,     /* Game's row of who has it        */
+                      *p_download; /* Game's row of who downloads it  */
+   int                player_counter; /* Count through each player    */
+
+   if (p_roster->p_have_bits == NULL)
+      return;
+   p_have     = p_roster->p_have_bits +
+                (size_t) game * p_roster->player_words;
+   p_download = p_roster->p_download_bits +
+                (size_t) game * p_roster->player_words;
+   memset(p_have, 0, sizeof(unsigned long long) * p_roster->player_words);
+   memset(p_download, 0,
+          sizeof(unsigned long long) * p_roster->player_words);
+
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_status[player_counter] == 'y')
+         p_have[player_counter / 64] |= 1ULL << (player_counter % 64);
+      else if (p_status[player_counter] == 'd')
+         p_download[player_counter / 64] |= 1ULL << (player_counter % 64);
+
    return;
 }
 
+/**********************************************************************/
+/*         Read one player's status for a game from its bits          */
+/**********************************************************************/
+char roster_status(const ROSTER *p_roster, int game, int player)
+{
+   size_t             word; /* Word of the game's row with the player */
+   unsigned long long bit;  /* Player's bit in that word              */
+
+   word = (size_t) game * p_roster->player_words + player / 64;
+   bit  = 1ULL << (player % 64);
+   if (p_roster->p_have_bits[word] & bit)
+      return 'y';
+   if (p_roster->p_download_bits[word] & bit)
+      return 'd';
+
+   return 'n';
+}
 
 /**********************************************************************/
-/*              Filter the game list into the wheel list              */
+/*   Check every member of a party has a game, or can download it     */
 /**********************************************************************/
-WHEEL  *filter_list(GAME   game_list[MAX_GAMES], 
-                    PLAYER player_list[MAX_PLAYERS], 
-                    int    amount_of_games, 
-                    int    amount_of_players, 
-                    int    party_count)
-{
-   WHEEL *p_new_game;     /* New game to add to the wheel list        */
-   int   game_counter,    /* Count through each game in it's list     */
-         player_counter;  /* Count through each player in it's list   */
-   char  willing_to_wait; /* Check if players are will to wait for    */
-                          /* updates and downloads                    */
-   int   row = HEADER_ROWS + 20; /* Row for displaying filtered games */
+int party_can_play(const ROSTER             *p_roster,
+                   int                      game,
+                   const unsigned long long *p_party,
+                   char                     willing_to_wait)
+{
+   const unsigned long long *p_have,     /* Game's row of who has it  */
+                            *p_download; /* Row of who downloads it   */
+   unsigned long long       lacking = 0; /* Members who can't play it */
+   int                      word;        /* Count through each word   */
 
-   p_new_game = NULL;     /* New game to add to the wheel list        */
+   /* Rows are checked a word of members at a time                    */
+   p_have     = p_roster->p_have_bits +
+                (size_t) game * p_roster->player_words;
+   p_download = p_roster->p_download_bits +
+                (size_t) game * p_roster->player_words;
+   for (word = 0; word < p_roster->player_words; word++)
+      lacking |= p_party[word] & ~p_have[word] &
+                 ~(willing_to_wait == 'y' ? p_download[word] : 0ULL);
 
-   willing_to_wait = get_response(2);
+   return lacking == 0;
+}
 
-   /* Set every game to approved                                      */
-   for (game_counter =  0;
-        game_counter < amount_of_games; 
-        game_counter++)
-      game_list[game_counter].wheel_approved = 1;
+/**********************************************************************/
+/*        List the games each player has and has to download          */
+/**********************************************************************/
+void build_postings(ROSTER *p_roster)
+{
+   POSTING            *p_posting;  /* List being built                */
+   const unsigned long long *p_planes[2]; /* Have then download bits  */
+   unsigned long long bits;        /* Players left in a word of a row */
+   int                words,       /* Words of bits for a list kept   */
+                                   /* as bits                         */
+                      game_counter,/* Count through each game         */
+                      word,        /* Count through a row's words     */
+                      plane,       /* List a bit goes in, 0 or 1      */
+                      list;        /* Count through each list         */
 
-   /* Filter out games                                                */
-   for (game_counter =  0;
-        game_counter < amount_of_games; 
+   if (p_roster->game_list == NULL || p_roster->amount_of_players == 0)
+      return;
+   p_roster->p_postings = (POSTING *)
+      calloc(2 * p_roster->amount_of_players, sizeof(POSTING));
+   if (p_roster->p_postings == NULL)
+      return; /* Without the lists, queries are just left out         */
+   words       = (p_roster->amount_of_games + 63) / 64;
+   p_planes[0] = p_roster->p_have_bits;
+   p_planes[1] = p_roster->p_download_bits;
+
+   /* Count each list first so each is allocated once, as numbers if  */
+   /* that is smaller or as a bit per game if it isn't; each row is   */
+   /* read a word of players at a time, skipping straight to the set  */
+   /* bits                                                            */
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
         game_counter++)
-      if (party_count <= game_list[game_counter].player_limit || 
-          game_list[game_counter].player_limit == 0)
+      for (plane = 0; plane < 2; plane++)
+         for (word = 0; word < p_roster->player_words; word++)
+            for (bits = p_planes[plane][(size_t) game_counter *
+                                        p_roster->player_words + word];
+                 bits != 0;
+                 bits &= bits - 1)
+               p_roster->p_postings[2 * (word * 64 + lowest_bit(bits)) +
+                                    plane].count++;
+   for (list = 0; list < 2 * p_roster->amount_of_players; list++)
+   {
+      p_posting         = &p_roster->p_postings[list];
+      p_posting->shared = 1;
+      if ((long long) p_posting->count * POSTING_BITS_RATIO >
+          p_roster->amount_of_games)
+         p_posting->p_bits = (unsigned long long *)
+            calloc(words + 1, sizeof(unsigned long long));
+      else
+         p_posting->p_games = (int *)
+            malloc(sizeof(int) * (p_posting->count + 1));
+      if (p_posting->p_bits == NULL && p_posting->p_games == NULL)
       {
-         for (player_counter = 0; 
-              player_counter < amount_of_players; 
-              player_counter++)
-            if (player_list[player_counter].party_status == 1 &&
-                game_list[game_counter].wheel_approved   != 0)
-            {
-               if (game_list[game_counter].game_status[player_counter] == 'y' ||
-                  (game_list[game_counter].game_status[player_counter] == 'd' &&
-                   willing_to_wait == 'y'))
-                  game_list[game_counter].wheel_approved = 1;
-               else
-                  game_list[game_counter].wheel_approved = 0;
-            }
+         free_postings(p_roster);
+         return;
       }
-      else
-         game_list[game_counter].wheel_approved = 0;
-
-   /* Display filtered games message                                  */
-   //mvprintw(row++, 0, "Filtered games: ");
-   refresh();
+      if (p_posting->p_bits == NULL)
+         p_posting->count = 0; /* Counted again as games are added    */
+   }
 
-   /* Insert the filtered games into a wheel list                     */
-   for (game_counter = 0; 
-        game_counter < amount_of_games; 
+   /* Games are added in order, so every list comes out sorted        */
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
         game_counter++)
-      if (game_list[game_counter].wheel_approved == 1)
-      {
-         //printw("%s ", game_list[game_counter].game_name);
-         //refresh();
-         p_new_game = insert_game(p_new_game, 
-                                    game_list[game_counter].game_name);
-      }
+      for (plane = 0; plane < 2; plane++)
+         for (word = 0; word < p_roster->player_words; word++)
+            for (bits = p_planes[plane][(size_t) game_counter *
+                                        p_roster->player_words + word];
+                 bits != 0;
+                 bits &= bits - 1)
+            {
+               p_posting = &p_roster->p_postings[
+                  2 * (word * 64 + lowest_bit(bits)) + plane];
+               if (p_posting->p_bits != NULL)
+                  p_posting->p_bits[game_counter / 64] |=
+                     1ULL << (game_counter % 64);
+               else
+                  p_posting->p_games[p_posting->count++] = game_counter;
+            }
 
-   return p_new_game;
+   return;
 }
 
 /**********************************************************************/
-/*          Create a new game node to add to the wheel list           */
+/*                Free every player's lists of games                  */
 /**********************************************************************/
-WHEEL *create_game_node(char game_name[MAX_GAME_NAME])
+void free_postings(ROSTER *p_roster)
 {
-   WHEEL *new_game; /* New game to add to the list                    */
+   int list; /* Count through each list                               */
 
-   if ((new_game = (WHEEL*) malloc(sizeof(WHEEL))) == NULL)
+   if (p_roster->p_postings == NULL)
+      return;
+   for (list = 0; list < 2 * p_roster->amount_of_players; list++)
    {
-      endwin();  /* End ncurses before error message                  */
-      printf("\nError #%d occurred in create_game_node.", 
-                                                      INSERT_ALLOC_ERR);
-      printf("\nCannot allocate memory for a new game.");
-      printf("\nThe program is aborting\n\n");
-      exit  (INSERT_ALLOC_ERR);
+      free(p_roster->p_postings[list].p_games);
+      free(p_roster->p_postings[list].p_bits);
    }
-   strcpy(new_game->game_name, game_name);
-   new_game->p_next_game = NULL;
+   free(p_roster->p_postings);
+   p_roster->p_postings = NULL;
 
-   return new_game;
+   return;
 }
 
 /**********************************************************************/
-/*                 Insert a game into the wheel list                  */
+/*       Put a game in one of a player's lists, or take it out        */
 /**********************************************************************/
-WHEEL *insert_game(WHEEL *p_insert_game, char game_name[MAX_GAME_NAME])
+int posting_set(POSTING *p_posting, int game, int present)
 {
-   WHEEL *new_game = create_game_node(game_name); /* New game to add  */
-                                                  /* to the list      */
+   unsigned long long bit; /* Game's bit in a list kept as bits       */
+   int                *p_games, /* Numbers after growing              */
+                      place; /* Place of the game, or where it'd go   */
 
-   if (p_insert_game == NULL) 
-       new_game->p_next_game = new_game;
-   else
+   /* A list keeps the form it was built in until the next full load  */
+   if (p_posting->p_bits != NULL)
    {
-      new_game->p_next_game      = p_insert_game->p_next_game;
-      p_insert_game->p_next_game = new_game;
+      bit = 1ULL << (game % 64);
+      if (present && !(p_posting->p_bits[game / 64] & bit))
+         p_posting->count++;
+      else if (!present && (p_posting->p_bits[game / 64] & bit))
+         p_posting->count--;
+      if (present)
+         p_posting->p_bits[game / 64] |= bit;
+      else
+         p_posting->p_bits[game / 64] &= ~bit;
+      return 1;
    }
 
-   return new_game; /* Return the new tail */
+   place = gallop_to(p_posting->p_games, p_posting->count, 0, game);
+   if (present && (place == p_posting->count ||
+                   p_posting->p_games[place] != game))
+   {
+      p_games = (int *) realloc(p_posting->p_games,
+                                sizeof(int) * (p_posting->count + 2));
+      if (p_games == NULL)
+         return 0;
+      p_posting->p_games = p_games;
+      memmove(p_games + place + 1, p_games + place,
+              sizeof(int) * (p_posting->count - place));
+      p_games[place] = game;
+      p_posting->count++;
+   }
+   else if (!present && place < p_posting->count &&
+            p_posting->p_games[place] == game)
+   {
+      memmove(p_posting->p_games + place, p_posting->p_games + place + 1,
+              sizeof(int) * (p_posting->count - place - 1));
+      p_posting->count--;
+   }
+
+   return 1;
 }
 
 /**********************************************************************/
-/*        Get a count of all the students in the student list         */
+/*               Hash a game row's limit, name and bits               */
 /**********************************************************************/
-int get_game_count(WHEEL *p_wheel_list)
+unsigned long long row_hash(int                      player_limit,
+                            const char               *p_name,
+                            int                      name_length,
+                            const unsigned long long *p_have,
+                            const unsigned long long *p_download,
+                            int                      word_count)
 {
-   WHEEL *p_current_game;
-   int   game_count = 0;  /* Count the amount of students in the      */
-                          /* student id list                          */
+   unsigned long long hash; /* Hash of the row so far                 */
 
-   p_current_game = p_wheel_list->p_next_game;
-
-   while(p_current_game != p_wheel_list)
-   {
-      p_current_game = p_current_game->p_next_game;
-      game_count++;
-   }
+   /* The zero after the name keeps a name apart from the bits after  */
+   hash = hash_bytes(ROW_HASH_BASIS, &player_limit, sizeof(player_limit));
+   hash = hash_bytes(hash, p_name, name_length);
+   hash = hash_bytes(hash, "", 1);
+   hash = hash_bytes(hash, p_have, sizeof(unsigned long long) * word_count);
 
-   return game_count;
+   return hash_bytes(hash, p_download,
+                     sizeof(unsigned long long) * word_count);
+}
+
+/**********************************************************************/
+/*                    Add bytes to an FNV-1a hash                     */
+/**********************************************************************/
+unsigned long long hash_bytes(unsigned long long hash,
+                              const void         *p_bytes,
+                              size_t             length)
+{
+   const unsigned char *p_byte = (const unsigned char *) p_bytes;
+                                  /* Byte being hashed                */
+
+   while (length-- > 0)
+      hash = (hash ^ *p_byte++) * ROW_HASH_PRIME;
+
+   return hash;
+}
+
+/**********************************************************************/
+/*      Check if two lists have the same names in the same order      */
+/**********************************************************************/
+int names_match(const char *p_first_name,
+                const char *p_second_name,
+                size_t     item_size,
+                int        item_count)
+{
+   int item_counter; /* Count through each item                       */
+
+   for (item_counter = 0; item_counter < item_count; item_counter++)
+      if (strcmp(p_first_name  + item_size * item_counter,
+                 p_second_name + item_size * item_counter) != 0)
+         return 0;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*      Find the rows that changed, if the games and players didn't   */
+/**********************************************************************/
+int diff_rosters(ROSTER       *p_base,
+                 ROSTER       *p_roster,
+                 ROSTER_DELTA *p_delta)
+{
+   GAME *p_game;              /* Game in the fresh lists              */
+   int  game_counter,         /* Count through games                  */
+        differs;              /* Lists themselves changed             */
+   long long start = trace_begin(); /* When diffing started           */
+
+   /* The counts and every name have to be as they were               */
+   differs = p_base->game_list == NULL || p_base->row_hashes == NULL ||
+             p_roster->game_list == NULL || p_roster->row_hashes == NULL ||
+             p_base->amount_of_players != p_roster->amount_of_players ||
+             p_base->amount_of_games   != p_roster->amount_of_games ||
+             !names_match((const char *) p_base->player_list +
+                             offsetof(PLAYER, player_name),
+                          (const char *) p_roster->player_list +
+                             offsetof(PLAYER, player_name),
+                          sizeof(PLAYER), p_roster->amount_of_players) ||
+             !names_match((const char *) p_base->game_list +
+                             offsetof(GAME, game_name),
+                          (const char *) p_roster->game_list +
+                             offsetof(GAME, game_name),
+                          sizeof(GAME), p_roster->amount_of_games);
+
+   /* Only rows whose hash changed are kept                           */
+   for (game_counter = 0;
+        !differs && game_counter < p_roster->amount_of_games;
+        game_counter++)
+   {
+      p_game = &p_roster->game_list[game_counter];
+      if (p_roster->row_hashes[game_counter] !=
+             p_base->row_hashes[game_counter] &&
+          !add_row_change(p_delta, game_counter, p_game->player_limit,
+                          p_roster->p_have_bits + (size_t) game_counter *
+                             p_roster->player_words,
+                          p_roster->p_download_bits + (size_t) game_counter *
+                             p_roster->player_words,
+                          p_roster->player_words,
+                          p_roster->row_hashes[game_counter]))
+         differs = 1;
+   }
+   trace_end("diff_rosters", "parse", start);
+
+   if (differs)
+   {
+      free_roster_delta(p_delta);
+      return 0;
+   }
+
+   p_delta->ready = 1;
+   if (p_delta->change_count == 0)
+      post_status("The game list is up to date");
+   else
+      post_status("%d games changed", p_delta->change_count);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                     Add a changed row to a delta                   */
+/**********************************************************************/
+int add_row_change(ROSTER_DELTA             *p_delta,
+                   int                      game,
+                   int                      player_limit,
+                   const unsigned long long *p_have,
+                   const unsigned long long *p_download,
+                   int                      word_count,
+                   unsigned long long       hash)
+{
+   ROW_CHANGE         *p_changes; /* Changes after growing            */
+   unsigned long long *p_bits;    /* Bits after growing               */
+   int                capacity;   /* Changes there will be room for   */
+
+   /* Double the room as needed, like the sheet buffer                */
+   if (p_delta->change_count == p_delta->capacity)
+   {
+      capacity   = p_delta->capacity > 0 ? p_delta->capacity * 2 : 64;
+      p_changes  = (ROW_CHANGE *) realloc(p_delta->p_changes,
+                                          sizeof(ROW_CHANGE) * capacity);
+      if (p_changes == NULL)
+         return 0;
+      p_delta->p_changes = p_changes;
+      p_bits = (unsigned long long *) realloc(p_delta->p_bits,
+                  sizeof(unsigned long long) *
+                  (2 * (size_t) word_count * capacity + 1));
+      if (p_bits == NULL)
+         return 0;
+      p_delta->p_bits   = p_bits;
+      p_delta->capacity = capacity;
+   }
+
+   p_delta->p_changes[p_delta->change_count].game         = game;
+   p_delta->p_changes[p_delta->change_count].player_limit = player_limit;
+   p_delta->p_changes[p_delta->change_count].hash         = hash;
+   p_bits = p_delta->p_bits +
+            (size_t) p_delta->change_count * 2 * word_count;
+   memcpy(p_bits, p_have, sizeof(unsigned long long) * word_count);
+   memcpy(p_bits + word_count, p_download,
+          sizeof(unsigned long long) * word_count);
+   p_delta->change_count++;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*              Patch the changed rows into the lists in use          */
+/**********************************************************************/
+void apply_roster_delta(ROSTER *p_roster, ROSTER_DELTA *p_delta)
+{
+   ROW_CHANGE         *p_change; /* Change being applied              */
+   unsigned long long *p_bits,   /* Its have then download bits       */
+                      *p_planes[2], /* Have then download bits in use */
+                      moved;     /* Players a word of the row moved   */
+   size_t             row;       /* Its game's first word of bits     */
+   int                words = p_roster->player_words, /* Words a row  */
+                      change_counter, /* Count through each change    */
+                      plane,     /* List a bit goes in, 0 or 1        */
+                      word,      /* Count through the row's words     */
+                      player,    /* Player whose list changes         */
+                      stale = 0; /* A list couldn't grow              */
+
+   /* Names are untouched, so both search indexes stay as they are    */
+   for (change_counter = 0;
+        change_counter < p_delta->change_count;
+        change_counter++)
+   {
+      p_change = &p_delta->p_changes[change_counter];
+      p_roster->game_list[p_change->game].player_limit =
+         p_change->player_limit;
+      p_bits = p_delta->p_bits + (size_t) change_counter * 2 * words;
+      row    = (size_t) p_change->game * words;
+      p_planes[0] = p_roster->p_have_bits + row;
+      p_planes[1] = p_roster->p_download_bits + row;
+
+      /* Only the players whose bit flipped have this game moved in   */
+      /* or out of their lists                                        */
+      for (plane = 0; p_roster->p_postings != NULL && plane < 2; plane++)
+         for (word = 0; word < words; word++)
+            for (moved = p_planes[plane][word] ^
+                         p_bits[plane * words + word];
+                 moved != 0;
+                 moved &= moved - 1)
+            {
+               player = word * 64 + lowest_bit(moved);
+               if (!posting_set(&p_roster->p_postings[2 * player + plane],
+                                p_change->game,
+                                (p_bits[plane * words + word] >>
+                                 (player % 64)) & 1))
+                  stale = 1;
+            }
+
+      memcpy(p_planes[0], p_bits, sizeof(unsigned long long) * words);
+      memcpy(p_planes[1], p_bits + words,
+             sizeof(unsigned long long) * words);
+      p_roster->row_hashes[p_change->game] = p_change->hash;
+   }
+
+   /* A list that couldn't take its game means building them again    */
+   if (stale)
+   {
+      free_postings(p_roster);
+      build_postings(p_roster);
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*                    Free the changes of a delta                     */
+/**********************************************************************/
+void free_roster_delta(ROSTER_DELTA *p_delta)
+{
+   free(p_delta->p_changes);
+   free(p_delta->p_bits);
+   memset(p_delta, 0, sizeof(*p_delta));
+
+   return;
+}
+
+/**********************************************************************/
+/*   Read the sheet URLs from the flags, the sources file or default  */
+/**********************************************************************/
+void sources_init(int argc, char *argv[])
+{
+   FILE   *p_sources_file;  /* One sheet URL on each line              */
+   char   line[MAX_URL_LEN],/* Line read from the sources file         */
+          *p_url;           /* URL on the line, past any indent        */
+   size_t url_length;       /* Length of the URL on the line           */
+   int    arg_counter;      /* Count through args                      */
+
+   memset(&sources, 0, sizeof(sources));
+   for (arg_counter = 1; arg_counter < argc - 1; arg_counter++)
+      if (strcmp(argv[arg_counter], SOURCE_FLAG) == 0 &&
+          sources.count < MAX_SOURCES)
+         snprintf(sources.urls[sources.count++], MAX_URL_LEN, "%s",
+                  argv[++arg_counter]);
+
+   /* Without flags, take one URL a line from the sources file,       */
+   /* skipping blank lines and # comments                             */
+   if (sources.count == 0 &&
+       (p_sources_file = fopen(SOURCES_FILE, "r")) != NULL)
+   {
+      while (sources.count < MAX_SOURCES &&
+             fgets(line, sizeof(line), p_sources_file) != NULL)
+      {
+         p_url      = line + strspn(line, " \t");
+         url_length = strcspn(p_url, " \t\r\n");
+         if (url_length > 0 && p_url[0] != '#')
+         {
+            memcpy(sources.urls[sources.count], p_url, url_length);
+            sources.urls[sources.count++][url_length] = '\0';
+         }
+      }
+      fclose(p_sources_file);
+   }
+
+   if (sources.count == 0)
+      strcpy(sources.urls[sources.count++], WHEEL_URL);
+
+   return;
+}
+
+/**********************************************************************/
+/*      Name of the file keeping a source's last good sheet           */
+/**********************************************************************/
+void source_copy_name(int source, char *p_file_name)
+{
+   /* The first sheet keeps the file it always had                    */
+   if (source == 0)
+      strcpy(p_file_name, CSV_FILE);
+   else
+      snprintf(p_file_name, MAX_FILE_NAME, CSV_COPY_FORMAT, source + 1);
+
+   return;
+}
+
+/**********************************************************************/
+/*       Download every source at once and parse each as it arrives   */
+/**********************************************************************/
+void fetch_sheets(PARSED_SHEET parsed[], LOAD_JOB *p_early)
+{
+   CURLM        *multi_handle;             /* Runs the transfers      */
+   CURL         *curl_handles[MAX_SOURCES];/* Transfer for each source*/
+   SHEET_BUFFER sheets[MAX_SOURCES];       /* Sheets received so far  */
+   CURLMsg      *p_message;                /* Transfer that finished  */
+   CURLcode     result;                    /* How it finished         */
+   char         file_name[MAX_FILE_NAME];  /* Copy of a source's sheet*/
+   long long    start;                     /* When the fetch started  */
+   int          source,                    /* Count through sources   */
+                running = 0,               /* Transfers still going   */
+                messages_left,             /* Messages not yet read   */
+                headers_in,                /* Sheets whose header is  */
+                                           /* in                      */
+                players_posted = p_early == NULL; /* Players handed   */
+                                           /* over, or not wanted     */
+
+   memset(parsed, 0, sizeof(PARSED_SHEET) * sources.count);
+   memset(curl_handles, 0, sizeof(curl_handles));
+   memset(sheets, 0, sizeof(sheets));
+
+   if (sources.count == 1)
+      post_status("Downloading CSV from Google Sheets...");
+   else
+      post_status("Downloading %d sheets at once...", sources.count);
+
+   /* curl_global_init was done by main                               */
+   start        = trace_begin();
+   multi_handle = curl_multi_init();
+   if (multi_handle == NULL)
+      post_status("Error: Could not initialize curl");
+   else
+   {
+      for (source = 0; source < sources.count; source++)
+         curl_handles[source] = start_download(multi_handle,
+                                               sources.urls[source],
+                                               &sheets[source]);
+
+      /* Every transfer moves along each time round, so the fetch     */
+      /* takes as long as the slowest sheet rather than all of them   */
+      /* added up, and each sheet is parsed as soon as it is in       */
+      do
+      {
+         if (curl_multi_perform(multi_handle, &running) != CURLM_OK)
+            break;
+         while ((p_message = curl_multi_info_read(multi_handle,
+                                                  &messages_left)) != NULL)
+            if (p_message->msg == CURLMSG_DONE)
+            {
+               for (source = 0;
+                    curl_handles[source] != p_message->easy_handle;
+                    source++)
+                  ;
+               result = p_message->data.result;
+               if (finish_download(curl_handles[source], result, source,
+                                   &sheets[source], start))
+                  parse_sheet(sheets[source].p_data, sheets[source].length,
+                              &parsed[source]);
+               free(sheets[source].p_data);
+               sheets[source].p_data = NULL;
+               curl_multi_remove_handle(multi_handle, curl_handles[source]);
+               curl_easy_cleanup(curl_handles[source]);
+               curl_handles[source] = NULL;
+            }
+
+         /* The party screen only needs the players, so they are      */
+         /* handed over once every sheet's first three rows are in,   */
+         /* while the game rows are still coming                      */
+         if (!players_posted)
+         {
+            headers_in = 0;
+            for (source = 0; source < sources.count; source++)
+               headers_in += parsed[source].ready ||
+                  (curl_handles[source] != NULL &&
+                   sheets[source].p_data != NULL &&
+                   csv_skip_rows(sheets[source].p_data, 0,
+                                 sheets[source].length, 3, 0) <
+                      sheets[source].length);
+            if (headers_in == sources.count)
+            {
+               post_early_players(parsed, sheets, p_early);
+               players_posted = 1;
+            }
+         }
+         if (running > 0)
+            curl_multi_poll(multi_handle, NULL, 0, POLL_INTERVAL, NULL);
+      }
+      while (running > 0);
+
+      /* Only a curl failure leaves transfers unfinished here         */
+      for (source = 0; source < sources.count; source++)
+         if (curl_handles[source] != NULL)
+         {
+            curl_multi_remove_handle(multi_handle, curl_handles[source]);
+            curl_easy_cleanup(curl_handles[source]);
+            free(sheets[source].p_data);
+         }
+      curl_multi_cleanup(multi_handle);
+   }
+   trace_end("fetch_sheets", "fetch", start);
+   metrics_observe(STAGE_FETCH, start);
+
+   /* A sheet that couldn't be fetched falls back on its last copy    */
+   for (source = 0; source < sources.count; source++)
+      if (!parsed[source].ready && !background_stopping())
+      {
+         source_copy_name(source, file_name);
+         parse_saved_sheet(file_name, &parsed[source]);
+      }
+
+   return;
+}
+
+/**********************************************************************/
+/*    Hand the players to the party screen before the games are in    */
+/**********************************************************************/
+void post_early_players(PARSED_SHEET parsed[],
+                        SHEET_BUFFER sheets[],
+                        LOAD_JOB     *p_job)
+{
+   PARSED_SHEET *p_header;     /* Header of a sheet still downloading  */
+   PLAYER *p_players;          /* Players of every sheet, by name      */
+   char   (*p_names)[MAX_PLAYER_NAME]; /* One sheet's players          */
+   int    player_count = 0,    /* Players after merging                */
+          name_count,          /* Players in one sheet                 */
+          game_count,          /* Games one sheet's header promises    */
+          source,              /* Count through sources                */
+          name,                /* Count through a sheet's players      */
+          merged;              /* Merged player a sheet's player is    */
+
+   p_header  = (PARSED_SHEET *) calloc(1, sizeof(PARSED_SHEET));
+   p_players = (PLAYER *) calloc(MAX_PLAYERS, sizeof(PLAYER));
+   if (p_header == NULL || p_players == NULL)
+   {
+      /* The party screen just waits for the whole roster then        */
+      free(p_header);
+      free(p_players);
+      return;
+   }
+
+   /* The same player in two sheets is one player, as when merging,   */
+   /* but a lone sheet's players are taken as they are, as its game   */
+   /* file is written                                                 */
+   for (source = 0; source < sources.count; source++)
+   {
+      if (parsed[source].ready)
+      {
+         p_names    = parsed[source].player_names;
+         name_count = parsed[source].player_count;
+      }
+      else if (parse_sheet_header(sheets[source].p_data,
+                                  sheets[source].length, p_header,
+                                  &game_count) != 0)
+      {
+         p_names    = p_header->player_names;
+         name_count = p_header->player_count;
+      }
+      else
+         break;
+
+      for (name = 0; name < name_count; name++)
+      {
+         merged = player_count;
+         if (sources.count > 1)
+            for (merged = 0; merged < player_count; merged++)
+               if (same_name(p_players[merged].player_name,
+                             p_names[name]))
+                  break;
+         if (merged == player_count && player_count < MAX_PLAYERS)
+            strcpy(p_players[player_count++].player_name, p_names[name]);
+      }
+      free(p_header->player_names);
+      p_header->player_names = NULL;
+   }
+   free(p_header);
+
+   /* A header that couldn't be read leaves the wait to the full load */
+   if (source < sources.count || player_count == 0)
+   {
+      free(p_players);
+      return;
+   }
+
+   /* Nothing else touches these until the UI thread takes them       */
+   p_job->p_players    = p_players;
+   p_job->player_count = player_count;
+   post_event(EV_PLAYERS_READY, 0, p_job);
+   post_status("%d players in, still loading the games...", player_count);
+
+   return;
+}
+
+/**********************************************************************/
+/*             Add a sheet's transfer to the ones in flight           */
+/**********************************************************************/
+CURL *start_download(CURLM        *multi_handle,
+                     const char   *url,
+                     SHEET_BUFFER *p_sheet)
+{
+   CURL *curl_handle; /* Handle for curl operations                   */
+
+   p_sheet->p_data   = NULL;
+   p_sheet->length   = 0;
+   p_sheet->capacity = 0;
+
+   curl_handle = curl_easy_init();
+   if (curl_handle == NULL)
+   {
+      post_status("Error: Could not initialize curl");
+      return NULL;
+   }
+
+   /* Configure curl to download into memory for the parser           */
+   curl_easy_setopt(curl_handle, CURLOPT_URL, url);
+   curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, download_write);
+   curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, p_sheet);
+   curl_easy_setopt(curl_handle, CURLOPT_USERAGENT,
+                   "Wheel-Program/1.0");
+   curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
+   curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, 0L);
+   curl_easy_setopt(curl_handle, CURLOPT_FAILONERROR, 1L);
+
+   /* Ask for any compression this curl can undo (gzip, brotli,       */
+   /* zstd); the write callback only ever sees the plain CSV          */
+   curl_easy_setopt(curl_handle, CURLOPT_ACCEPT_ENCODING, "");
+
+   /* Prefer HTTP/2 over TLS, falling back to HTTP/1.1, and let       */
+   /* sheets on the same host share one multiplexed connection        */
+   curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION,
+                    (long) CURL_HTTP_VERSION_2TLS);
+   curl_easy_setopt(curl_handle, CURLOPT_PIPEWAIT, 1L);
+
+   /* Let the program quit in the middle of a slow download           */
+   curl_easy_setopt(curl_handle, CURLOPT_NOPROGRESS, 0L);
+   curl_easy_setopt(curl_handle, CURLOPT_XFERINFOFUNCTION,
+                    download_progress);
+
+   if (curl_multi_add_handle(multi_handle, curl_handle) != CURLM_OK)
+   {
+      post_status("Error: Could not start downloading %s", url);
+      curl_easy_cleanup(curl_handle);
+      return NULL;
+   }
+
+   return curl_handle;
+}
+
+/**********************************************************************/
+/*         Check a finished transfer and keep a copy of its sheet     */
+/**********************************************************************/
+int finish_download(CURL         *curl_handle,
+                    CURLcode     result,
+                    int          source,
+                    SHEET_BUFFER *p_sheet,
+                    long long    start)
+{
+   FILE       *p_copy_file;            /* Local file to write to       */
+   char       file_name[MAX_FILE_NAME];/* Name of the local file       */
+   curl_off_t wire_bytes = 0;          /* Bytes that came over the net */
+   long       http_version = 0;        /* HTTP version the server spoke*/
+
+   trace_end("download_csv", "fetch", start);
+   if (result != CURLE_OK || p_sheet->p_data == NULL)
+   {
+      metrics_count(COUNT_DOWNLOAD_ERRORS);
+      post_status("Error: Sheet %d: %s", source + 1,
+                  curl_easy_strerror(result));
+      return 0;
+   }
+
+   curl_easy_getinfo(curl_handle, CURLINFO_SIZE_DOWNLOAD_T, &wire_bytes);
+   curl_easy_getinfo(curl_handle, CURLINFO_HTTP_VERSION, &http_version);
+   post_status("Download %d of %d complete! %ld KB sent as %ld KB over "
+               "HTTP/%s", source + 1, sources.count,
+               (long) (p_sheet->length / 1024), (long) (wire_bytes / 1024),
+               http_version == CURL_HTTP_VERSION_2_0 ? "2" : "1.1");
+   metrics_count(COUNT_DOWNLOADS);
+   trace_download(curl_handle, start);
+
+   /* The parser's vector loads may read past the last byte           */
+   memset(p_sheet->p_data + p_sheet->length, 0, CSV_PADDING);
+
+   /* Keep a copy to fall back on if the next download fails          */
+   source_copy_name(source, file_name);
+   p_copy_file = fopen(file_name, "wb");
+   if (p_copy_file != NULL)
+   {
+      fwrite(p_sheet->p_data, 1, p_sheet->length, p_copy_file);
+      fclose(p_copy_file);
+   }
+
+   return 1;  /* Success                                              */
+}
+
+/**********************************************************************/
+/*                Add downloaded bytes to the sheet buffer            */
+/**********************************************************************/
+size_t download_write(char *p_bytes, size_t size, size_t count,
+                      void *p_data)
+{
+   SHEET_BUFFER *p_sheet = (SHEET_BUFFER *) p_data; /* Sheet so far   */
+   size_t       bytes    = size * count,  /* Bytes curl handed over   */
+                capacity;                 /* Room needed, with padding*/
+   char         *p_grown;                 /* Buffer after growing     */
+
+   /* curl hands over the body already decoded, but it is kept whole  */
+   /* rather than parsed a chunk at a time: the parser indexes the    */
+   /* whole sheet in one pass, a download that fails halfway must     */
+   /* leave the last good copy in charge, and that copy is the body   */
+   /* itself                                                          */
+
+   /* Double the buffer as needed, always leaving room for the        */
+   /* parser's zero padding after the last byte                       */
+   if (p_sheet->length + bytes + CSV_PADDING > p_sheet->capacity)
+   {
+      capacity = p_sheet->capacity > 0 ? p_sheet->capacity : 65536;
+      while (p_sheet->length + bytes + CSV_PADDING > capacity)
+         capacity *= 2;
+      if (capacity >= 0xFFFFFFFFUL ||
+          (p_grown = (char *) realloc(p_sheet->p_data, capacity)) == NULL)
+         return 0; /* Anything short of bytes makes curl give up      */
+      p_sheet->p_data   = p_grown;
+      p_sheet->capacity = capacity;
+   }
+
+   memcpy(p_sheet->p_data + p_sheet->length, p_bytes, bytes);
+   p_sheet->length += bytes;
+
+   return bytes;
+}
+
+/**********************************************************************/
+/*            Abort the download if the program is quitting           */
+/**********************************************************************/
+int download_progress(void *p_data, curl_off_t download_total,
+                      curl_off_t download_now, curl_off_t upload_total,
+                      curl_off_t upload_now)
+{
+   (void) p_data;
+   (void) download_total;
+   (void) download_now;
+   (void) upload_total;
+   (void) upload_now;
+
+   /* Any non-zero return makes curl give up on the transfer          */
+   return background_stopping();
+}
+
+/**********************************************************************/
+/*                 Parse the last good copy of a sheet                */
+/**********************************************************************/
+int parse_saved_sheet(const char *input_file, PARSED_SHEET *p_parsed)
+{
+   char   *p_sheet;     /* Whole CSV file in memory                   */
+   size_t sheet_length; /* Bytes in the CSV file                      */
+   int    parsed_ok;    /* Sheet was parsed                           */
+
+   p_sheet = read_whole_file(input_file, &sheet_length);
+   if (p_sheet == NULL)
+   {
+      post_status("Error: Cannot open %s", input_file);
+      return 0;
+   }
+   parsed_ok = parse_sheet(p_sheet, sheet_length, p_parsed);
+   free(p_sheet);
+
+   return parsed_ok;
+}
+
+/**********************************************************************/
+/*             Parse a sheet in memory into game file lines           */
+/**********************************************************************/
+int parse_sheet(char *p_sheet, size_t sheet_length, PARSED_SHEET *p_parsed)
+{
+   PARSE_CHUNK *chunks = p_parsed->chunks; /* Slices of the game rows  */
+   size_t body_start;          /* First byte of the game rows          */
+   int  player_count,          /* Number of players                    */
+        game_count,            /* Number of games                      */
+        rows_left,             /* Rows the header still allows         */
+        chunk_count,           /* Slices the game rows are cut into    */
+        chunk_counter,         /* Count through each slice             */
+        in_quotes,             /* A slice starts inside a quoted cell  */
+        attribute_count;       /* Extra columns after the players      */
+   long long start = trace_begin(); /* When parsing started           */
+
+   post_status("Parsing CSV file...");
+   memset(p_parsed, 0, sizeof(PARSED_SHEET));
+   body_start = parse_sheet_header(p_sheet, sheet_length, p_parsed,
+                                   &game_count);
+   if (body_start == 0)
+      return 0;
+   player_count    = p_parsed->player_count;
+   attribute_count = p_parsed->attribute_count;
+
+   /* Game rows don't depend on each other, so big sheets are cut     */
+   /* into one slice per core, each starting right after a newline    */
+   chunk_count = (int) ((sheet_length - body_start) / PARSE_CHUNK_MIN);
+   if (chunk_count > cpu_count())
+      chunk_count = cpu_count();
+   if (chunk_count > MAX_PARSE_THREADS)
+      chunk_count = MAX_PARSE_THREADS;
+   if (chunk_count < 1)
+      chunk_count = 1;
+   for (chunk_counter = 0; chunk_counter < chunk_count; chunk_counter++)
+   {
+      chunks[chunk_counter].p_data       = p_sheet;
+      chunks[chunk_counter].player_count = player_count;
+      chunks[chunk_counter].attribute_count = attribute_count;
+      chunks[chunk_counter].max_rows     = game_count;
+      chunks[chunk_counter].start        = body_start +
+         (sheet_length - body_start) * chunk_counter / chunk_count;
+      chunks[chunk_counter].end          = body_start +
+         (sheet_length - body_start) * (chunk_counter + 1) / chunk_count;
+   }
+
+   /* A newline only ends a row outside quotes, and whether a slice   */
+   /* starts inside quotes depends on the quotes in every slice       */
+   /* before it, so count those first and then move each cut forward  */
+   /* to the first newline that really ends a row                     */
+   if (chunk_count > 1)
+   {
+      run_parse_threads(chunks, chunk_count, count_quotes_worker);
+      in_quotes = 0;
+      for (chunk_counter = 1; chunk_counter < chunk_count; chunk_counter++)
+      {
+         in_quotes ^= chunks[chunk_counter - 1].quote_parity;
+         chunks[chunk_counter].start =
+            csv_skip_rows(p_sheet, chunks[chunk_counter].start, sheet_length,
+                          1, in_quotes);
+         if (chunks[chunk_counter].start < chunks[chunk_counter - 1].start)
+            chunks[chunk_counter].start = chunks[chunk_counter - 1].start;
+         chunks[chunk_counter - 1].end = chunks[chunk_counter].start;
+      }
+   }
+   run_parse_threads(chunks, chunk_count, parse_chunk_worker);
+
+   /* The header never promises more games than follow it, so rows    */
+   /* past its game count are dropped                                 */
+   rows_left = game_count;
+   for (chunk_counter = 0; chunk_counter < chunk_count; chunk_counter++)
+   {
+      chunks[chunk_counter].p_data = NULL; /* Sheet may be freed now  */
+      if (chunks[chunk_counter].row_count > rows_left)
+      {
+         chunks[chunk_counter].output_length =
+            row_bytes(chunks[chunk_counter].p_output,
+                      chunks[chunk_counter].output_length, rows_left);
+         chunks[chunk_counter].attribute_length =
+            row_bytes(chunks[chunk_counter].p_attributes,
+                      chunks[chunk_counter].attribute_length, rows_left);
+         chunks[chunk_counter].row_count = rows_left;
+      }
+      rows_left -= chunks[chunk_counter].row_count;
+   }
+
+   p_parsed->ready        = 1;
+   p_parsed->game_count   = game_count - rows_left;
+   p_parsed->chunk_count  = chunk_count;
+   trace_end("parse_sheet", "parse", start);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*       Read a sheet's counts, players and extra column names        */
+/**********************************************************************/
+size_t parse_sheet_header(char         *p_sheet,
+                          size_t       sheet_length,
+                          PARSED_SHEET *p_parsed,
+                          int          *p_game_count)
+{
+   CSV_INDEX   csv;            /* Header rows and their structurals    */
+   CSV_FIELD   field;          /* Cell being read                      */
+   size_t body_start;          /* First byte of the game rows          */
+   int  player_count,          /* Number of players                    */
+        player_counter,        /* Count through players                */
+        attribute_count = 0,   /* Extra columns after the players      */
+        terminator;            /* What ended the last cell             */
+   char (*player_names)[MAX_PLAYER_NAME]; /* Store names              */
+
+   /* Index just the three header rows, which is all the party screen */
+   /* needs, so this works on a sheet still being downloaded too      */
+   body_start = csv_skip_rows(p_sheet, 0, sheet_length, 3, 0);
+   if (!build_csv_index(&csv, p_sheet, body_start))
+   {
+      post_status("Error: Cannot allocate memory to parse the sheet");
+      return 0;
+   }
+
+   /* Skip first line (headers: "Player Count,Game Count,,,," )       */
+   csv_skip_line(&csv, ',');
+
+   /* Read second line with counts                                    */
+   terminator = csv_next_field(&csv, &field);
+   if (terminator != ',' || !csv_field_number(&field, &player_count) ||
+       (terminator = csv_next_field(&csv, &field)) == 0 ||
+       !csv_field_number(&field, p_game_count) ||
+       player_count  < 0 || player_count  > MAX_PLAYERS ||
+       *p_game_count < 0 || *p_game_count > MAX_GAMES)
+   {
+      post_status("Error: Bad player or game count in the sheet");
+      free(csv.p_structurals);
+      return 0;
+   }
+   csv_skip_line(&csv, terminator); /* Skip rest of line              */
+
+   player_names = malloc((size_t) (player_count + 1) * MAX_PLAYER_NAME);
+   if (player_names == NULL)
+   {
+      post_status("Error: Cannot allocate memory for %d players",
+                  player_count);
+      free(csv.p_structurals);
+      return 0;
+   }
+
+   /* Read third line and extract player names                        */
+   terminator = csv_next_field(&csv, &field); /* Skip "Player Limit"  */
+   if (terminator == ',')
+      terminator = csv_next_field(&csv, &field); /* Skip "Game"       */
+   for (player_counter = 0;
+        player_counter < player_count;
+        player_counter++)
+   {
+      if (terminator == ',')
+         terminator = csv_next_field(&csv, &field);
+      else
+         field.length = 0;
+      if (csv_copy_field(&field, player_names[player_counter],
+                         MAX_PLAYER_NAME) == 0)
+         snprintf(player_names[player_counter], MAX_PLAYER_NAME,
+                  "Player%d", player_counter + 1);
+   }
+
+   /* Named cells after the players are extra columns, up to the      */
+   /* first blank one                                                 */
+   while (terminator == ',' && attribute_count < MAX_ATTRIBUTES)
+   {
+      terminator = csv_next_field(&csv, &field);
+      if (csv_copy_field(&field,
+                         p_parsed->attribute_names[attribute_count],
+                         MAX_ATTRIBUTE_NAME) == 0)
+         break;
+      attribute_count++;
+   }
+   free(csv.p_structurals);
+
+   p_parsed->player_count    = player_count;
+   p_parsed->player_names    = player_names;
+   p_parsed->attribute_count = attribute_count;
+
+   return body_start;
+}
+
+/**********************************************************************/
+/*                 Free a sheet's parsed game file lines              */
+/**********************************************************************/
+void free_parsed_sheet(PARSED_SHEET *p_parsed)
+{
+   int chunk_counter; /* Count through each slice                     */
+
+   for (chunk_counter = 0;
+        chunk_counter < p_parsed->chunk_count;
+        chunk_counter++)
+   {
+      free(p_parsed->chunks[chunk_counter].p_output);
+      free(p_parsed->chunks[chunk_counter].p_attributes);
+   }
+   free(p_parsed->player_names);
+   memset(p_parsed, 0, sizeof(PARSED_SHEET));
+
+   return;
+}
+
+/**********************************************************************/
+/*    Build the game and player lists straight from the parsed sheets */
+/**********************************************************************/
+int sheets_to_lists(PARSED_SHEET parsed[],
+                    int          sheet_count,
+                    ROSTER       *p_roster)
+{
+   PARSED_SHEET *p_parsed = NULL; /* Only sheet that was parsed       */
+   GAME   *p_game;             /* Game a row goes to                   */
+   char   *p_line,             /* Row being read                       */
+          *p_name,             /* Game name in the row                 */
+          *p_status,           /* Player statuses in the row           */
+          *p_end;              /* End of a slice's rows                */
+   int    ready_count = 0,     /* Sheets that were parsed              */
+          game_count  = 0,     /* Games read so far                    */
+          name_length,         /* Length of the game name              */
+          sheet_counter,       /* Count through each sheet             */
+          chunk_counter,       /* Count through each slice             */
+          player_counter;      /* Count through players                */
+   long long start;            /* When building the lists started      */
+
+   for (sheet_counter = 0; sheet_counter < sheet_count; sheet_counter++)
+      if (parsed[sheet_counter].ready)
+      {
+         p_parsed = &parsed[sheet_counter];
+         ready_count++;
+      }
+
+   /* With nothing new the last game file is all there is             */
+   if (ready_count == 0)
+      return 0;
+
+   /* Sheets are only merged when there is more than one              */
+   if (ready_count > 1)
+   {
+      if (!merge_sheets(parsed, sheet_count, p_roster))
+         return 0;
+      post_status("Merged %d sheets: %d players, %d games", ready_count,
+                  p_roster->amount_of_players, p_roster->amount_of_games);
+      return 1;
+   }
+
+   start = trace_begin();
+   if (!allocate_roster(p_roster, p_parsed->game_count,
+                        p_parsed->player_count))
+      return 0;
+   for (player_counter = 0;
+        player_counter < p_parsed->player_count;
+        player_counter++)
+      strcpy(p_roster->player_list[player_counter].player_name,
+             p_parsed->player_names[player_counter]);
+
+   /* Each row is "limit name statuses", a status for every player,   */
+   /* taken from each slice in sheet order and packed straight into   */
+   /* the game's bits                                                 */
+   for (chunk_counter = 0;
+        chunk_counter < p_parsed->chunk_count;
+        chunk_counter++)
+   {
+      p_line = p_parsed->chunks[chunk_counter].p_output;
+      p_end  = p_line + p_parsed->chunks[chunk_counter].output_length;
+      while (p_line < p_end && game_count < p_parsed->game_count)
+      {
+         p_game = &p_roster->game_list[game_count++];
+         p_game->player_limit = (int) strtol(p_line, &p_name, 10);
+         p_name++;
+         p_status    = (char *) memchr(p_name, ' ', p_end - p_name) + 1;
+         name_length = (int) (p_status - 1 - p_name);
+         memcpy(p_game->game_name, p_name, name_length);
+         p_game->game_name[name_length] = '\0';
+         set_owner_bits(p_roster, game_count - 1, p_status);
+         p_line = p_status + p_parsed->player_count + 1;
+      }
+   }
+   p_roster->amount_of_games = game_count;
+   trace_end("sheets_to_lists", "parse", start);
+   post_status("Parsing complete!");
+
+   return 1;
+}
+
+/**********************************************************************/
+/*     Keep the lists as the space-separated file, for when offline   */
+/**********************************************************************/
+void write_game_file(const ROSTER *p_roster, const char *output_file)
+{
+   FILE *p_output; /* Output space-separated file                     */
+
+   if (p_roster->game_list == NULL)
+      return;
+   p_output = fopen(output_file, "w");
+   if (p_output == NULL)
+   {
+      post_status("Error: Cannot create %s", output_file);
+      return;
+   }
+   write_lists(p_output, p_roster);
+   fclose(p_output);
+
+   return;
+}
+
+/**********************************************************************/
+/*             Write the lists the way read_lists reads them          */
+/**********************************************************************/
+void write_lists(FILE *p_file, const ROSTER *p_roster)
+{
+   int  player_counter, /* Count through each player in it's list     */
+        game_counter;   /* Count through each game in it's list       */
+   char status[MAX_PLAYERS + 1]; /* One row's statuses, unpacked      */
+
+   /* Write player count and game count (space-separated)             */
+   fprintf(p_file, "%d %d\n", p_roster->amount_of_players,
+           p_roster->amount_of_games);
+
+   /* Write player names (space-separated)                            */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      fprintf(p_file, "%s%c",
+              p_roster->player_list[player_counter].player_name,
+              player_counter < p_roster->amount_of_players - 1 ? ' ' : '\n');
+
+   /* Write each game as "limit name statuses"                        */
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+   {
+      for (player_counter = 0;
+           player_counter < p_roster->amount_of_players;
+           player_counter++)
+         status[player_counter] =
+            roster_status(p_roster, game_counter, player_counter);
+      status[player_counter] = '\0';
+      fprintf(p_file, "%d %s %s\n",
+              p_roster->game_list[game_counter].player_limit,
+              p_roster->game_list[game_counter].game_name, status);
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*       Union players by name and games by name across the sheets    */
+/**********************************************************************/
+int merge_sheets(PARSED_SHEET parsed[],
+                 int          sheet_count,
+                 ROSTER       *p_roster)
+{
+   char   player_names[MAX_PLAYERS][MAX_PLAYER_NAME], /* Every player */
+          game_name[MAX_GAME_NAME], /* Name of the row being merged   */
+          *p_line,             /* Row being merged                     */
+          *p_name,             /* Game name in the row                 */
+          *p_status,           /* Player statuses in the row           */
+          *p_end;              /* End of a slice's rows                */
+   int    (*player_maps)[MAX_PLAYERS]; /* Merged player for each      */
+                               /* sheet's player                      */
+   int    *game_table;         /* Hash table of merged games, by name  */
+   unsigned int table_mask,    /* Table size less one, a power of two  */
+                slot;          /* Slot in the table being checked      */
+   GAME   *p_game;             /* Merged game a row goes to            */
+   unsigned long long *p_have, /* Merged game's row of who has it      */
+          *p_download;         /* Its row of who downloads it          */
+   size_t word,                /* Count through every word of bits     */
+          word_count;          /* Words of bits for every merged game  */
+   int    player_count = 0,    /* Players after merging                */
+          game_count   = 0,    /* Games after merging                  */
+          max_games    = 0,    /* Rows in every sheet, at most         */
+                               /* MAX_GAMES                            */
+          player_limit,        /* Player limit in the row              */
+          name_length,         /* Length of the game name              */
+          sheet_counter,       /* Count through each sheet             */
+          chunk_counter,       /* Count through each slice             */
+          player_counter,      /* Count through a sheet's players      */
+          merged;              /* Merged player a sheet's player is    */
+   long long start = trace_begin(); /* When merging started           */
+
+   player_maps = malloc(sizeof(*player_maps) * sheet_count);
+   if (player_maps == NULL)
+   {
+      post_status("Error: Cannot allocate memory to merge the sheets");
+      return 0;
+   }
+
+   /* The same player in two sheets is one player                     */
+   for (sheet_counter = 0; sheet_counter < sheet_count; sheet_counter++)
+   {
+      if (!parsed[sheet_counter].ready)
+         continue;
+      max_games += parsed[sheet_counter].game_count;
+      for (player_counter = 0;
+           player_counter < parsed[sheet_counter].player_count;
+           player_counter++)
+      {
+         for (merged = 0; merged < player_count; merged++)
+            if (same_name(player_names[merged],
+                   parsed[sheet_counter].player_names[player_counter]))
+               break;
+         if (merged == MAX_PLAYERS)
+         {
+            post_status("Error: More than %d players across the sheets",
+                        MAX_PLAYERS);
+            free(player_maps);
+            return 0;
+         }
+         if (merged == player_count)
+            strcpy(player_names[player_count++],
+                   parsed[sheet_counter].player_names[player_counter]);
+         player_maps[sheet_counter][player_counter] = merged;
+      }
+   }
+   if (max_games > MAX_GAMES)
+      max_games = MAX_GAMES;
+
+   /* Every status starts as 'n' for players missing from a sheet     */
+   for (table_mask = 15; table_mask < 2U * max_games; table_mask =
+        table_mask * 2 + 1)
+      ;
+   game_table = (int *) calloc(table_mask + 1, sizeof(int));
+   if (game_table == NULL ||
+       !allocate_roster(p_roster, max_games, player_count))
+   {
+      free(game_table);
+      free(player_maps);
+      return 0;
+   }
+   for (merged = 0; merged < player_count; merged++)
+      strcpy(p_roster->player_list[merged].player_name,
+             player_names[merged]);
+
+   /* Each row is "limit name statuses", and a game in two sheets is  */
+   /* one game, with the larger player limit and, for each player,    */
+   /* 'y' over 'd' and either over 'n'                                */
+   for (sheet_counter = 0; sheet_counter < sheet_count; sheet_counter++)
+      for (chunk_counter = 0;
+           chunk_counter < parsed[sheet_counter].chunk_count;
+           chunk_counter++)
+      {
+         p_line = parsed[sheet_counter].chunks[chunk_counter].p_output;
+         p_end  = p_line +
+                  parsed[sheet_counter].chunks[chunk_counter].output_length;
+         while (p_line < p_end)
+         {
+            player_limit = (int) strtol(p_line, &p_name, 10);
+            p_name++;
+            p_status    = (char *) memchr(p_name, ' ', p_end - p_name) + 1;
+            name_length = (int) (p_status - 1 - p_name);
+            memcpy(game_name, p_name, name_length);
+            game_name[name_length] = '\0';
+            p_line = p_status + parsed[sheet_counter].player_count + 1;
+
+            /* Game table slots hold a game's place plus one, 0 = free */
+            slot = name_hash(game_name) & table_mask;
+            while (game_table[slot] != 0 &&
+                   !same_name(p_roster->game_list[game_table[slot] - 1].
+                                 game_name, game_name))
+               slot = (slot + 1) & table_mask;
+            if (game_table[slot] == 0)
+            {
+               if (game_count == max_games)
+                  continue;
+               p_game = &p_roster->game_list[game_count];
+               strcpy(p_game->game_name, game_name);
+               p_game->player_limit = player_limit;
+               game_table[slot] = ++game_count;
+            }
+            p_game = &p_roster->game_list[game_table[slot] - 1];
+            if (player_limit > p_game->player_limit)
+               p_game->player_limit = player_limit;
+
+            p_have     = p_roster->p_have_bits + (size_t)
+                         (game_table[slot] - 1) * p_roster->player_words;
+            p_download = p_roster->p_download_bits + (size_t)
+                         (game_table[slot] - 1) * p_roster->player_words;
+            for (player_counter = 0;
+                 player_counter < parsed[sheet_counter].player_count;
+                 player_counter++)
+            {
+               merged = player_maps[sheet_counter][player_counter];
+               if (p_status[player_counter] == 'y')
+                  p_have[merged / 64] |= 1ULL << (merged % 64);
+               else if (p_status[player_counter] == 'd')
+                  p_download[merged / 64] |= 1ULL << (merged % 64);
+            }
+         }
+      }
+
+   /* Having a game in any sheet beats downloading it in another      */
+   word_count = (size_t) p_roster->player_words * game_count;
+   for (word = 0; word < word_count; word++)
+      p_roster->p_download_bits[word] &= ~p_roster->p_have_bits[word];
+
+   p_roster->amount_of_games = game_count;
+   free(game_table);
+   free(player_maps);
+   trace_end("merge_sheets", "parse", start);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*    Write the sheets' extra columns, unioned by name, a game a line */
+/**********************************************************************/
+void write_attribute_file(PARSED_SHEET parsed[], int sheet_count,
+                          const char *output_file)
+{
+   PARSED_SHEET *p_parsed;     /* Sheet being written                 */
+   FILE   *p_output;           /* Output space-separated file         */
+   char   names[MAX_ATTRIBUTES][MAX_ATTRIBUTE_NAME], /* Columns kept  */
+          line[MAX_GAME_NAME + 2 +
+               MAX_ATTRIBUTES * (MAX_ATTRIBUTE_VALUE + 1)],
+                               /* Row being split into its cells      */
+          *values[MAX_ATTRIBUTES], /* Each column's cell in the row   */
+          *p_line,             /* Next row of the slice               */
+          *p_end,              /* End of the slice's rows             */
+          *p_cell;             /* Cell being split off                */
+   int    column_maps[MAX_ATTRIBUTES], /* Column each cell goes in    */
+          column_count = 0,    /* Columns across every sheet          */
+          row_count = 0,       /* Rows with extra cells               */
+          ready_count = 0,     /* Sheets that were parsed             */
+          identity,            /* Sheet's columns are all of them     */
+          sheet_counter,       /* Count through each sheet            */
+          chunk_counter,       /* Count through each slice            */
+          column,              /* Count through each sheet's column   */
+          merged;              /* Column across every sheet           */
+   size_t line_length;         /* Bytes of the row                    */
+
+   /* The same column in two sheets is one column                     */
+   for (sheet_counter = 0; sheet_counter < sheet_count; sheet_counter++)
+   {
+      p_parsed = &parsed[sheet_counter];
+      if (!p_parsed->ready)
+         continue;
+      ready_count++;
+      if (p_parsed->attribute_count > 0)
+         row_count += p_parsed->game_count;
+      for (column = 0; column < p_parsed->attribute_count; column++)
+      {
+         for (merged = 0; merged < column_count; merged++)
+            if (same_name(names[merged], p_parsed->attribute_names[column]))
+               break;
+         if (merged == column_count && column_count < MAX_ATTRIBUTES)
+            strcpy(names[column_count++], p_parsed->attribute_names[column]);
+      }
+   }
+
+   /* With nothing new the last columns are left as they were         */
+   if (ready_count == 0)
+      return;
+
+   p_output = fopen(output_file, "w");
+   if (p_output == NULL)
+   {
+      post_status("Error: Cannot create %s", output_file);
+      return;
+   }
+   fprintf(p_output, "%d %d\n", column_count, row_count);
+   for (merged = 0; merged < column_count; merged++)
+      fprintf(p_output, "%s%c", names[merged],
+              merged < column_count - 1 ? ' ' : '\n');
+
+   for (sheet_counter = 0; sheet_counter < sheet_count; sheet_counter++)
+   {
+      p_parsed = &parsed[sheet_counter];
+      if (!p_parsed->ready || p_parsed->attribute_count == 0)
+         continue;
+      identity = p_parsed->attribute_count == column_count;
+      for (column = 0; column < p_parsed->attribute_count; column++)
+      {
+         for (merged = 0; merged < column_count; merged++)
+            if (same_name(names[merged], p_parsed->attribute_names[column]))
+               break;
+         column_maps[column] = merged < column_count ? merged : -1;
+         identity = identity && merged == column;
+      }
+
+      /* A sheet holding every column in order is written as it is,   */
+      /* any other has each cell moved to its column, "-" where the   */
+      /* sheet doesn't have it                                        */
+      for (chunk_counter = 0;
+           chunk_counter < p_parsed->chunk_count;
+           chunk_counter++)
+      {
+         p_line = p_parsed->chunks[chunk_counter].p_attributes;
+         p_end  = p_line + p_parsed->chunks[chunk_counter].attribute_length;
+         if (identity)
+         {
+            fwrite(p_line, 1, p_end - p_line, p_output);
+            continue;
+         }
+         while (p_line < p_end)
+         {
+            line_length = (char *) memchr(p_line, '\n', p_end - p_line) -
+                          p_line;
+            memcpy(line, p_line, line_length);
+            line[line_length] = '\0';
+            p_line += line_length + 1;
+
+            for (merged = 0; merged < column_count; merged++)
+               values[merged] = "-";
+            p_cell = strchr(line, ' ');
+            *p_cell++ = '\0';
+            for (column = 0; column < p_parsed->attribute_count; column++)
+            {
+               if (column_maps[column] >= 0)
+                  values[column_maps[column]] = p_cell;
+               p_cell  = p_cell + strcspn(p_cell, " ");
+               if (*p_cell != '\0')
+                  *p_cell++ = '\0';
+            }
+            fprintf(p_output, "%s", line);
+            for (merged = 0; merged < column_count; merged++)
+               fprintf(p_output, " %s", values[merged]);
+            fprintf(p_output, "\n");
+         }
+      }
+   }
+   fclose(p_output);
+
+   return;
+}
+
+/**********************************************************************/
+/*      Load the extra columns saved for the games, if there are any  */
+/**********************************************************************/
+void load_attributes(GAME       game_list[],
+                     int        game_count,
+                     ATTRIBUTES *p_attributes)
+{
+   FILE *p_file; /* Saved extra columns                               */
+
+   memset(p_attributes, 0, sizeof(ATTRIBUTES));
+   p_file = fopen(ATTRIBUTE_FILE, "r");
+   if (p_file == NULL)
+      return;
+   if (!read_attributes(p_file, game_list, game_count, p_attributes))
+      post_status("Error: Cannot read %s", ATTRIBUTE_FILE);
+   fclose(p_file);
+
+   return;
+}
+
+/**********************************************************************/
+/*           Read extra columns into a column of values each          */
+/**********************************************************************/
+int read_attributes(FILE       *p_file,
+                    GAME       game_list[],
+                    int        game_count,
+                    ATTRIBUTES *p_attributes)
+{
+   ATTRIBUTE    *p_column;      /* Column being read                  */
+   char         name_format[FORMAT_LEN],  /* Reads a name safely      */
+                value_format[FORMAT_LEN], /* Reads a value safely     */
+                game_name[MAX_GAME_NAME], /* Game the row is for      */
+                value[MAX_ATTRIBUTE_VALUE], /* Cell being read        */
+                *p_number_end;  /* Where a number's digits stop       */
+   int          *game_table,    /* Game's place plus one, 0 = free    */
+                column_count,   /* Columns in the file                */
+                row_count,      /* Rows in the file                   */
+                row_counter,    /* Count through each row             */
+                column,         /* Count through each column          */
+                game,           /* Game a row is for, -1 for none     */
+                code;           /* Code of a text value               */
+   long         number;         /* Text value read as a number        */
+   unsigned int table_mask,     /* Game table size less one           */
+                slot;           /* Slot of the game table             */
+
+   memset(p_attributes, 0, sizeof(ATTRIBUTES));
+   if (fscanf(p_file, "%d %d", &column_count, &row_count) != 2 ||
+       column_count < 0 || column_count > MAX_ATTRIBUTES || row_count < 0)
+      return 0;
+   if (column_count == 0)
+      return 1;
+
+   snprintf(name_format, sizeof(name_format), "%%%ds",
+            MAX_GAME_NAME - 1);
+   snprintf(value_format, sizeof(value_format), "%%%ds",
+            MAX_ATTRIBUTE_VALUE - 1);
+   p_attributes->count = column_count;
+   for (column = 0; column < column_count; column++)
+   {
+      p_column = &p_attributes->columns[column];
+      p_column->p_values = (int *) malloc((game_count + 1) * sizeof(int));
+      if (p_column->p_values == NULL ||
+          fscanf(p_file, value_format, value) != 1)
+      {
+         free_attributes(p_attributes);
+         return 0;
+      }
+      snprintf(p_column->name, MAX_ATTRIBUTE_NAME, "%s", value);
+      for (game = 0; game < game_count; game++)
+         p_column->p_values[game] = ATTRIBUTE_MISSING;
+   }
+
+   /* Rows are matched to games by name, so a game missing from the   */
+   /* file just has no values                                         */
+   for (table_mask = 15; table_mask < 2U * game_count; table_mask =
+        table_mask * 2 + 1)
+      ;
+   game_table = (int *) calloc(table_mask + 1, sizeof(int));
+   if (game_table == NULL)
+   {
+      free_attributes(p_attributes);
+      return 0;
+   }
+   for (game = 0; game < game_count; game++)
+   {
+      slot = name_hash(game_list[game].game_name) & table_mask;
+      while (game_table[slot] != 0)
+         slot = (slot + 1) & table_mask;
+      game_table[slot] = game + 1;
+   }
+
+   for (row_counter = 0; row_counter < row_count; row_counter++)
+   {
+      if (fscanf(p_file, name_format, game_name) != 1)
+         break;
+      slot = name_hash(game_name) & table_mask;
+      while (game_table[slot] != 0 &&
+             !same_name(game_list[game_table[slot] - 1].game_name,
+                        game_name))
+         slot = (slot + 1) & table_mask;
+      game = game_table[slot] - 1;
+
+      for (column = 0; column < column_count; column++)
+      {
+         if (fscanf(p_file, value_format, value) != 1)
+            break;
+         if (game < 0 || strcmp(value, "-") == 0)
+            continue;
+         code = attribute_code(&p_attributes->columns[column], value);
+         if (code < 0)
+            break;
+         p_attributes->columns[column].p_values[game] = code;
+      }
+      if (column < column_count)
+      {
+         free(game_table);
+         free_attributes(p_attributes);
+         return 0;
+      }
+   }
+   free(game_table);
+
+   /* A column holding nothing but whole numbers is kept as numbers   */
+   /* so it can be compared with < and >                              */
+   for (column = 0; column < column_count; column++)
+   {
+      p_column = &p_attributes->columns[column];
+      free(p_column->p_text_slots);
+      p_column->p_text_slots = NULL;
+      p_column->is_number    = p_column->text_count > 0;
+      for (code = 0; code < p_column->text_count && p_column->is_number;
+           code++)
+      {
+         number = strtol(p_column->p_texts[code], &p_number_end, 10);
+         p_column->is_number = *p_number_end == '\0' &&
+                               number >= -MAX_ATTRIBUTE_NUMBER &&
+                               number <= MAX_ATTRIBUTE_NUMBER;
+      }
+      if (p_column->is_number)
+      {
+         for (game = 0; game < game_count; game++)
+            if (p_column->p_values[game] != ATTRIBUTE_MISSING)
+               p_column->p_values[game] = (int) strtol(
+                  p_column->p_texts[p_column->p_values[game]], NULL, 10);
+         free(p_column->p_texts);
+         p_column->p_texts       = NULL;
+         p_column->text_count    = 0;
+         p_column->text_capacity = 0;
+      }
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*        Code of a text value in a column, adding it if it is new    */
+/**********************************************************************/
+int attribute_code(ATTRIBUTE *p_column, const char *p_text)
+{
+   char (*p_texts)[MAX_ATTRIBUTE_VALUE]; /* Texts with room for more  */
+   int  *p_slots,       /* Hash table with room for more              */
+        capacity,       /* Texts there will be room for               */
+        code;           /* Count through each text already kept       */
+   unsigned int slot = 0; /* Slot of the hash table                   */
+
+   /* Text is compared ignoring case, like the names                  */
+   if (p_column->p_text_slots != NULL)
+   {
+      slot = name_hash(p_text) & p_column->text_mask;
+      while (p_column->p_text_slots[slot] != 0)
+      {
+         if (same_name(p_column->p_texts[p_column->p_text_slots[slot] - 1],
+                       p_text))
+            return p_column->p_text_slots[slot] - 1;
+         slot = (slot + 1) & p_column->text_mask;
+      }
+   }
+
+   /* A full dictionary doubles, with a hash table twice its size     */
+   if (p_column->text_count == p_column->text_capacity)
+   {
+      capacity = p_column->text_capacity > 0 ?
+                    p_column->text_capacity * 2 : 16;
+      p_texts  = realloc(p_column->p_texts,
+                         (size_t) capacity * MAX_ATTRIBUTE_VALUE);
+      if (p_texts == NULL)
+         return -1;
+      p_column->p_texts = p_texts;
+      p_slots = (int *) calloc((size_t) capacity * 2, sizeof(int));
+      if (p_slots == NULL)
+         return -1;
+      p_column->text_capacity = capacity;
+      p_column->text_mask     = (unsigned int) capacity * 2 - 1;
+      free(p_column->p_text_slots);
+      p_column->p_text_slots = p_slots;
+      for (code = 0; code < p_column->text_count; code++)
+      {
+         slot = name_hash(p_column->p_texts[code]) & p_column->text_mask;
+         while (p_slots[slot] != 0)
+            slot = (slot + 1) & p_column->text_mask;
+         p_slots[slot] = code + 1;
+      }
+      slot = name_hash(p_text) & p_column->text_mask;
+      while (p_slots[slot] != 0)
+         slot = (slot + 1) & p_column->text_mask;
+   }
+
+   strcpy(p_column->p_texts[p_column->text_count], p_text);
+   p_column->p_text_slots[slot] = ++p_column->text_count;
+
+   return p_column->text_count - 1;
+}
+
+/**********************************************************************/
+/*          Write extra columns the way read_attributes reads them    */
+/**********************************************************************/
+void write_attributes(FILE       *p_file,
+                      GAME       game_list[],
+                      int        game_count,
+                      ATTRIBUTES *p_attributes)
+{
+   ATTRIBUTE *p_column;     /* Column being written                   */
+   int       row_count = 0, /* Games with a value in some column      */
+             game,          /* Count through each game                */
+             column,        /* Count through each column              */
+             value;         /* Game's value in the column             */
+
+   for (game = 0; game < game_count; game++)
+      for (column = 0; column < p_attributes->count; column++)
+         if (p_attributes->columns[column].p_values[game] !=
+             ATTRIBUTE_MISSING)
+         {
+            row_count++;
+            break;
+         }
+
+   fprintf(p_file, "%d %d\n", p_attributes->count, row_count);
+   for (column = 0; column < p_attributes->count; column++)
+      fprintf(p_file, "%s%c", p_attributes->columns[column].name,
+              column < p_attributes->count - 1 ? ' ' : '\n');
+   for (game = 0; game < game_count; game++)
+   {
+      for (column = 0; column < p_attributes->count; column++)
+         if (p_attributes->columns[column].p_values[game] !=
+             ATTRIBUTE_MISSING)
+            break;
+      if (column == p_attributes->count)
+         continue;
+
+      fprintf(p_file, "%s", game_list[game].game_name);
+      for (column = 0; column < p_attributes->count; column++)
+      {
+         p_column = &p_attributes->columns[column];
+         value    = p_column->p_values[game];
+         if (value == ATTRIBUTE_MISSING)
+            fprintf(p_file, " -");
+         else if (p_column->is_number)
+            fprintf(p_file, " %d", value);
+         else
+            fprintf(p_file, " %s", p_column->p_texts[value]);
+      }
+      fprintf(p_file, "\n");
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*                       Free every extra column                      */
+/**********************************************************************/
+void free_attributes(ATTRIBUTES *p_attributes)
+{
+   int column; /* Count through each column                           */
+
+   for (column = 0; column < p_attributes->count; column++)
+   {
+      free(p_attributes->columns[column].p_values);
+      free(p_attributes->columns[column].p_text_slots);
+      free(p_attributes->columns[column].p_texts);
+   }
+   memset(p_attributes, 0, sizeof(ATTRIBUTES));
+
+   return;
+}
+
+/**********************************************************************/
+/*              Hash a name the same whatever its case                */
+/**********************************************************************/
+unsigned int name_hash(const char *p_name)
+{
+   unsigned int hash = 2166136261U; /* FNV-1a offset basis            */
+
+   while (*p_name != '\0')
+      hash = (hash ^ (unsigned char) tolower((unsigned char) *p_name++)) *
+             16777619U;
+
+   return hash;
+}
+
+/**********************************************************************/
+/*               Check if two names match, ignoring case              */
+/**********************************************************************/
+int same_name(const char *p_first, const char *p_second)
+{
+   while (*p_first != '\0' &&
+          tolower((unsigned char) *p_first) ==
+          tolower((unsigned char) *p_second))
+   {
+      p_first++;
+      p_second++;
+   }
+
+   return *p_first == *p_second;
+}
+
+/**********************************************************************/
+/*                  Amount of processors this machine has             */
+/**********************************************************************/
+int cpu_count()
+{
+   int processors; /* Processors the system reports                   */
+#ifdef _WIN32
+   SYSTEM_INFO system_info; /* Reports the processor count            */
+
+   GetSystemInfo(&system_info);
+   processors = (int) system_info.dwNumberOfProcessors;
+#else
+   processors = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+   return processors < 1 ? 1 : processors;
+}
+
+/**********************************************************************/
+/*               Run a worker on every slice and wait for them        */
+/**********************************************************************/
+void run_parse_threads(PARSE_CHUNK *p_chunks,
+                       int         chunk_count,
+                       void        *(*worker)(void *p_data))
+{
+   int chunk_counter; /* Count through each slice                     */
+
+   /* The first slice is done on this thread while the others run,    */
+   /* and a slice whose thread can't start is done here too           */
+   for (chunk_counter = 1; chunk_counter < chunk_count; chunk_counter++)
+      p_chunks[chunk_counter].running =
+         pthread_create(&p_chunks[chunk_counter].thread, NULL, worker,
+                        &p_chunks[chunk_counter]) == 0;
+   worker(&p_chunks[0]);
+   for (chunk_counter = 1; chunk_counter < chunk_count; chunk_counter++)
+      if (p_chunks[chunk_counter].running)
+      {
+         pthread_join(p_chunks[chunk_counter].thread, NULL);
+         p_chunks[chunk_counter].running = 0;
+      }
+      else
+         worker(&p_chunks[chunk_counter]);
+
+   return;
+}
+
+/**********************************************************************/
+/*             Count whether a slice has an odd number of quotes      */
+/**********************************************************************/
+void *count_quotes_worker(void *p_data)
+{
+   PARSE_CHUNK *p_chunk = (PARSE_CHUNK *) p_data; /* Slice to count   */
+   const char  *p_quote = p_chunk->p_data + p_chunk->start,
+               *p_end   = p_chunk->p_data + p_chunk->end;
+
+   p_chunk->quote_parity = 0;
+   while (p_quote < p_end &&
+          (p_quote = memchr(p_quote, '"', p_end - p_quote)) != NULL)
+   {
+      p_chunk->quote_parity ^= 1;
+      p_quote++;
+   }
+
+   return NULL;
+}
+
+/**********************************************************************/
+/*             Index and decode the game rows in one slice            */
+/**********************************************************************/
+void *parse_chunk_worker(void *p_data)
+{
+   PARSE_CHUNK *p_chunk = (PARSE_CHUNK *) p_data; /* Slice to parse   */
+   CSV_INDEX   csv;              /* Slice and its structural index    */
+   size_t      newline_count = 0,/* Rows can't outnumber the newlines */
+               structural;       /* Count through each structural     */
+   long long   start = trace_begin(); /* When this slice started      */
+
+   p_chunk->row_count     = 0;
+   p_chunk->output_length = 0;
+   p_chunk->attribute_length = 0;
+   if (p_chunk->end <= p_chunk->start ||
+       !build_csv_index(&csv, p_chunk->p_data + p_chunk->start,
+                        p_chunk->end - p_chunk->start))
+      return NULL;
+
+   /* Size the output for the longest possible row of every line      */
+   for (structural = 0; structural < csv.structural_count; structural++)
+      if (csv.p_data[csv.p_structurals[structural]] == '\n')
+         newline_count++;
+   p_chunk->p_output = (char *) malloc((newline_count + 1) *
+                          (p_chunk->player_count + MAX_GAME_NAME +
+                           MAX_NUMBER_FIELD + 4));
+   if (p_chunk->attribute_count > 0)
+   {
+      p_chunk->p_attributes = (char *) malloc((newline_count + 1) *
+                                 (MAX_GAME_NAME + 2 +
+                                  p_chunk->attribute_count *
+                                  (MAX_ATTRIBUTE_VALUE + 1)));
+      if (p_chunk->p_attributes == NULL)
+      {
+         free(p_chunk->p_output);
+         p_chunk->p_output = NULL;
+      }
+   }
+   if (p_chunk->p_output != NULL)
+      p_chunk->row_count = decode_game_rows(&csv, p_chunk->player_count,
+                                            p_chunk->attribute_count,
+                                            p_chunk->max_rows,
+                                            p_chunk->p_output,
+                                            &p_chunk->output_length,
+                                            p_chunk->p_attributes,
+                                            &p_chunk->attribute_length);
+   free(csv.p_structurals);
+   trace_end("parse_chunk", "parse", start);
+
+   return NULL;
+}
+
+/**********************************************************************/
+/*        Decode game rows into game file lines, returns the rows     */
+/**********************************************************************/
+int decode_game_rows(CSV_INDEX *p_csv,
+                     int       player_count,
+                     int       attribute_count,
+                     int       max_rows,
+                     char      *p_output,
+                     size_t    *p_output_length,
+                     char      *p_attributes,
+                     size_t    *p_attribute_length)
+{
+   CSV_FIELD field;          /* Cell being read                        */
+   char      *p_row,         /* Row being written                      */
+             *p_name,        /* Game name in the row                   */
+             *p_extra;       /* Extra column line being written        */
+   size_t    name_length;    /* Bytes of the game name                 */
+   int       row_count = 0,  /* Rows written                           */
+             player_limit,   /* Player limit for the game              */
+             player_counter, /* Count through players                  */
+             attribute_counter, /* Count through extra columns         */
+             terminator;     /* What ended the last cell               */
+
+   p_row   = p_output;
+   p_extra = p_attributes;
+   while (p_csv->cursor < p_csv->length && row_count < max_rows)
+   {
+      /* Read player limit and game name, skipping blank lines        */
+      terminator = csv_next_field(p_csv, &field);
+      if (terminator != ',' && field.length == 0)
+         continue;
+      if (!csv_field_number(&field, &player_limit))
+         player_limit = 0;
+      if (terminator == ',')
+         terminator = csv_next_field(p_csv, &field);
+      else
+         field.length = 0;
+      p_row += snprintf(p_row, MAX_NUMBER_FIELD + 2, "%d ", player_limit);
+      if (csv_copy_field(&field, p_row, MAX_GAME_NAME) == 0)
+         strcpy(p_row, "Unnamed");
+      p_name      = p_row;
+      name_length = strlen(p_row);
+      p_row      += name_length;
+      *p_row++    = ' ';
+      
+      /* Each player's status is the first letter of their cell, and  */
+      /* a missing cell means they don't have the game                */
+      for (player_counter = 0; 
+           player_counter < player_count; 
+           player_counter++)
+      {
+         if (terminator == ',')
+            terminator = csv_next_field(p_csv, &field);
+         else
+            field.length = 0;
+         *p_row++ = field.length > 0 ? field.p_start[0] : 'n';
+      }
+      *p_row++ = '\n';
+      row_count++;
+
+      /* Extra cells go on their own line after the game's name, a    */
+      /* blank one written as "-"                                     */
+      if (attribute_count > 0)
+      {
+         memcpy(p_extra, p_name, name_length);
+         p_extra += name_length;
+         for (attribute_counter = 0;
+              attribute_counter < attribute_count;
+              attribute_counter++)
+         {
+            if (terminator == ',')
+               terminator = csv_next_field(p_csv, &field);
+            else
+               field.length = 0;
+            *p_extra++ = ' ';
+            if (csv_copy_field(&field, p_extra, MAX_ATTRIBUTE_VALUE) == 0)
+               strcpy(p_extra, "-");
+            p_extra += strlen(p_extra);
+         }
+         *p_extra++ = '\n';
+      }
+      
+      csv_skip_line(p_csv, terminator); /* Skip rest of line          */
+   }
+   *p_output_length = p_row - p_output;
+   if (attribute_count > 0)
+      *p_attribute_length = p_extra - p_attributes;
+
+   return row_count;
+}
+
+/**********************************************************************/
+/*            Bytes taken by the first rows of some lines             */
+/**********************************************************************/
+size_t row_bytes(const char *p_lines, size_t length, int row_count)
+{
+   const char *p_row_end = p_lines - 1; /* Newline ending a row kept  */
+   int        row_counter;              /* Count through the rows     */
+
+   if (p_lines == NULL)
+      return 0;
+   for (row_counter = 0; row_counter < row_count; row_counter++)
+      p_row_end = memchr(p_row_end + 1, '\n',
+                         length - (p_row_end + 1 - p_lines));
+
+   return p_row_end + 1 - p_lines;
+}
+
+/**********************************************************************/
+/*                      Get a yes or no response                      */
+/**********************************************************************/
+char get_response(int response_type)
+{
+   int selected = 0;  /* 0 = Yes, 1 = No                              */
+   int key;           /* Key pressed by user                          */
+   int row = HEADER_ROWS;           /* Row position for prompt        */
+
+   move(HEADER_ROWS - 2, 0);
+   clrtoeol();
+   printw("Use the arrow and enter keys to select");
+
+   switch(response_type)  /* Print message based on type */
+   {
+      case 1:
+         mvprintw(row, 0, "Spin for game?");
+         break;
+      case 2:
+         move(HEADER_ROWS, 0);
+         clrtoeol();
+         clear_screen();
+         mvprintw(row, 0, "Include games that need updates or downloads?");
+         break;
+      case 3:
+         clear_game_file();
+         mvprintw(row, 0, "Remove and reroll?");
+         mvprintw(row + 4, 0, "U to undo a reroll, R to redo it, "
+                              "O to put every game back");
+         break;
+      case 4:
+         mvprintw(row, 0, "Spin among the finalists?");
+         break;
+   }
+   
+   /* Loop until user presses Enter                                   */
+   while(1)
+   {
+      /* Display the options with highlighting                        */
+      move(row + 2, 5);
+      clrtoeol();
+      
+      if (selected == 0)
+         attron(A_REVERSE);  /* Highlight Yes                         */
+      printw("[ Yes ]");
+      if (selected == 0)
+         attroff(A_REVERSE);
+      
+      printw("    ");
+      
+      if (selected == 1)
+         attron(A_REVERSE);  /* Highlight No                          */
+      printw("[ No ]");
+      if (selected == 1)
+         attroff(A_REVERSE);
+      
+      refresh();
+      
+      /* Get user input using menu navigation function                */
+      key = get_menu_input(&selected, 2);
+      
+      /* Check if Enter was pressed                                   */
+      if (key == '\n' ||
+          (response_type == 3 && key < 256 && strchr("uUrRoO", key) != NULL))
+      {
+         /* Clear the prompt area                                     */
+         move(row, 0);
+         clrtoeol();
+         move(row + 2, 0);
+         clrtoeol();
+         move(row + 4, 0);
+         clrtoeol();
+         refresh();
+         
+         if (key != '\n')
+            return (char) tolower(key);
+         else if (selected == 0)
+            return 'y';
+         else
+            return 'n';
+      }
+   }
+}
+
+/**********************************************************************/
+/*                     Print the list of players                      */
+/**********************************************************************/
+void print_players(SEARCH_VIEW *p_player_search,
+                   LIST_VIEW   *p_player_view)
+{
+   int row = p_player_view->top_row - 1; /* Row of the list heading   */
+
+   move(row, 0);
+   clrtoeol();
+
+   if (p_player_search->query_length > 0)
+      mvprintw(row++, 0, "Players matching \"%s\" (%d):",
+               p_player_search->query, p_player_view->item_count);
+   else
+      mvprintw(row++, 0, "Players (%d):", p_player_view->item_count);
+
+   /* Only the rows that fit in the window are drawn                  */
+   list_view_draw(p_player_view, draw_player_item, p_player_search);
+   if (p_player_view->item_count == 0)
+   {
+      mvprintw(row, 2, "Empty!");
+   }
+
+   refresh();
+   return;
+}
+
+/**********************************************************************/
+/*                 Print who is in the party on one line              */
+/**********************************************************************/
+void print_party(PLAYER player_list[],
+                 int    amount_of_players,
+                 int    party_count)
+{
+   int player_counter; /* Count through each player in it's list      */
+   int row = LINES - 2; /* Party line sits above the status line      */
+
+   move(row, 0);
+   clrtoeol();
+   printw("Party (%d):", party_count);
+
+   /* Stop at the edge of the window instead of wrapping              */
+   for (player_counter = 0;
+        player_counter < amount_of_players;
+        player_counter++)
+      if (player_list[player_counter].party_status == 1)
+      {
+         if (getcurx(stdscr) + 
+             (int) strlen(player_list[player_counter].player_name) + 5 >= 
+             COLS)
+         {
+            printw(" ...");
+            break;
+         }
+         printw(" %s", player_list[player_counter].player_name);
+      }
+
+   return;
+}
+
+/**********************************************************************/
+/*           Let the user pick the party from the list of players     */
+/**********************************************************************/
+void party_select(ROSTER   *p_roster,
+                  LOAD_JOB *p_load,
+                  int      *p_party_count)
+{
+   PLAYER      *player_list = p_roster->player_list; /* Players to pick */
+   int         amount_of_players = p_roster->amount_of_players;
+   LIST_VIEW   player_view;            /* Visible part of the players */
+   SEARCH_VIEW player_search;          /* Name typed to find a player */
+   HISTORY_TOP top_games[MAX_TOP_GAMES]; /* Picked most this month    */
+   char        digits[MAX_NUMBER_DIGITS + 1]; /* Player number typed  */
+   int         length = 0,             /* Amount of digits typed      */
+               top_count,              /* Games in top_games          */
+               key,                    /* Key pressed by user         */
+               player_id;              /* Player to add or remove     */
+
+   search_view_init(&player_search, &p_roster->player_index, player_list,
+                    amount_of_players);
+   list_view_init(&player_view, search_view_count(&player_search));
+   top_count = history_top_games(month_start(), top_games, MAX_TOP_GAMES);
+   digits[0] = '\0';
+   clear_screen();
+
+   while (1)
+   {
+      /* The list fills the rows between the prompt and the party     */
+      /* line, so it follows the window size, not the roster size     */
+      list_view_place(&player_view, HEADER_ROWS + 4,
+                      LINES - HEADER_ROWS - 6);
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Type a name or number and enter to select, tab for games, "
+             "? to rank them");
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Who do you want to add or remove from the party");
+      move(HEADER_ROWS + 1, 0);
+      clrtoeol();
+      if (player_search.query_length > 0)
+         printw("Search (esc to clear): %s", player_search.query);
+      else
+         printw("(%d to quit): %s", QUIT, digits);
+      print_top_games(top_games, top_count, HEADER_ROWS + 3);
+      print_players(&player_search, &player_view);
+      print_party(player_list, amount_of_players, *p_party_count);
+      refresh();
+
+      key = wait_key();
+
+      if (list_view_key(&player_view, key))
+         continue;
+
+      /* Letters search the players, and the list follows each key    */
+      if (length == 0 && search_view_key(&player_search, key))
+      {
+         list_view_init(&player_view, search_view_count(&player_search));
+         continue;
+      }
+
+      /* Looking at the games needs them in, so the players handed    */
+      /* over early give way to the whole roster                      */
+      if ((key == '\t' || key == '?') && p_load != NULL)
+      {
+         finish_load(p_load, p_roster);
+         history_party(p_roster, p_party_count);
+         p_load            = NULL;
+         player_list       = p_roster->player_list;
+         amount_of_players = p_roster->amount_of_players;
+         search_view_init(&player_search, &p_roster->player_index,
+                          player_list, amount_of_players);
+         list_view_init(&player_view, search_view_count(&player_search));
+      }
+
+      if (key == '\t')
+      {
+         game_lookup(p_roster);
+         clear_screen();
+      }
+      else if (key == '?')
+      {
+         rank_games(p_roster);
+         clear_screen();
+      }
+      else if (key == '\n' || key == KEY_ENTER)
+      {
+         /* Enter on its own picks the highlighted player             */
+         if (length == 0 && player_view.item_count == 0)
+            continue;
+         else if (length == 0)
+            player_id = search_view_item(&player_search,
+                                         player_view.cursor) + 1;
+         else
+         {
+            player_id = atoi(digits);
+            length    = 0;
+            digits[0] = '\0';
+         }
+
+         if (player_id <= QUIT)
+            break;
+
+         party_control(player_list, amount_of_players,
+                       player_id, p_party_count);
+         if (player_search.query_length == 0 &&
+             player_id <= amount_of_players)
+            list_view_move(&player_view, player_id - 1);
+      }
+      else if ((key == KEY_BACKSPACE || key == 127 || key == '\b') &&
+               length > 0)
+         digits[--length] = '\0';
+      else if (key >= '0' && key <= '9' && length < MAX_NUMBER_DIGITS)
+      {
+         digits[length++] = (char) key;
+         digits[length]   = '\0';
+      }
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*             Add, drop, and count members in the party              */
+/**********************************************************************/
+void party_control(PLAYER player_list[], 
+                   int    amount_of_players, 
+                   int    player_id, 
+                   int    *p_party_count)
+{
+   int player_counter; /* Count through each player in it's list      */
+   
+   /* Update player status and party count                            */
+   if (player_id <= amount_of_players)
+   {
+      if (player_list[player_id - 1].party_status != 1)
+      {
+         player_list[player_id - 1].party_status = 1;
+         *p_party_count += 1;
+      }
+      else
+      {
+         player_list[player_id - 1].party_status = 0;
+         *p_party_count -= 1;
+      }
+   }
+   else
+   {
+      /* Show error for 1 second without holding up the next entry    */
+      show_message(HEADER_ROWS + 2, "!!PLAYER NOT IN LIST!!", 1000);
+   }
+   
+   refresh();
+   return;
+}
+
+
+/**********************************************************************/
+/*              Filter the game list into the wheel list              */
+/**********************************************************************/
+WHEEL  *filter_list(ROSTER       *p_roster,
+                    int          party_count,
+                    char         willing_to_wait,
+                    GAME_FILTER  *p_filter,
+                    RECENT_PICKS *p_recent)
+{
+   GAME  *game_list;      /* Games to filter                          */
+   WHEEL *p_new_game,     /* New game to add to the wheel list        */
+         *p_inserted;     /* Game just inserted, NULL if it couldn't  */
+   unsigned long long party[(MAX_PLAYERS + 63) / 64];
+                          /* Party's members, a bit each, like the    */
+                          /* roster's packed rows                     */
+   int   amount_of_games, /* Games in the list                        */
+         game_counter,    /* Count through each game in it's list     */
+         player_counter,  /* Count through each player in it's list   */
+         rested_count = 0,/* Games sitting out their cooldown         */
+         fresh_count  = 0;/* Games left on the wheel without them     */
+   int   row = HEADER_ROWS + 20; /* Row for displaying filtered games */
+   long long start,       /* When filtering or inserting started      */
+             filter_start;/* When the whole filter started            */
+
+   p_new_game = NULL;     /* New game to add to the wheel list        */
+   game_list       = p_roster->game_list;
+   amount_of_games = p_roster->amount_of_games;
+
+   start        = trace_begin();
+   filter_start = start;
+
+   /* Set every game the extra column filter keeps to approved        */
+   if (p_filter != NULL && p_filter->step_count > 0 &&
+       run_game_filter(p_filter, amount_of_games) < 0)
+      post_status("Error: Cannot allocate memory to filter the games");
+   for (game_counter =  0;
+        game_counter < amount_of_games; 
+        game_counter++)
+      game_list[game_counter].wheel_approved =
+         filter_allows(p_filter, game_counter);
+
+   /* Filter out games, checking the whole party against each game's  */
+   /* packed row a word of members at a time                          */
+   memset(party, 0, sizeof(party));
+   for (player_counter = 0; 
+        player_counter < p_roster->amount_of_players; 
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+         party[player_counter / 64] |= 1ULL << (player_counter % 64);
+   for (game_counter =  0;
+        game_counter < amount_of_games; 
+        game_counter++)
+      if (party_count <= game_list[game_counter].player_limit || 
+          game_list[game_counter].player_limit == 0)
+      {
+         if (game_list[game_counter].wheel_approved != 0)
+            game_list[game_counter].wheel_approved =
+               party_can_play(p_roster, game_counter, party,
+                              willing_to_wait);
+      }
+      else
+         game_list[game_counter].wheel_approved = 0;
+
+   /* Rest the games the party kept lately, each one a hash probe,    */
+   /* unless that would leave nothing to spin                         */
+   if (p_recent->session_count > 0)
+   {
+      for (game_counter = 0;
+           game_counter < amount_of_games;
+           game_counter++)
+         if (game_list[game_counter].wheel_approved == 1)
+         {
+            if (recently_picked(p_recent, game_list[game_counter].game_name))
+            {
+               game_list[game_counter].wheel_approved = 2;
+               rested_count++;
+            }
+            else
+               fresh_count++;
+         }
+      for (game_counter = 0;
+           game_counter < amount_of_games;
+           game_counter++)
+         if (game_list[game_counter].wheel_approved == 2)
+            game_list[game_counter].wheel_approved = (fresh_count > 0) ? 0 : 1;
+      if (rested_count > 0 && fresh_count > 0)
+         post_status("%d game%s played in the last %d session%s left off",
+                     rested_count, (rested_count == 1) ? "" : "s",
+                     p_recent->session_count,
+                     (p_recent->session_count == 1) ? "" : "s");
+   }
+   trace_end("filter_list", "filter", start);
+
+   /* Display filtered games message                                  */
+   //mvprintw(row++, 0, "Filtered games: ");
+   refresh();
+
+   /* Insert the filtered games into a wheel list                     */
+   start = trace_begin();
+   for (game_counter = 0;  
+        game_counter < amount_of_games; 
+        game_counter++)
+      if (game_list[game_counter].wheel_approved == 1)
+      {
+         //printw("%s ", game_list[game_counter].game_name);
+         //refresh();
+         p_inserted = insert_game(p_new_game, 
+                                  game_list[game_counter].game_name);
+
+         /* A wheel missing games would be unfair, so there is none   */
+         /* and what was inserted goes back with the session arena    */
+         if (p_inserted == NULL)
+         {
+            post_status("Error: Cannot allocate memory for the wheel");
+            p_new_game = NULL;
+            break;
+         }
+         p_new_game = p_inserted;
+      }
+   trace_end("insert_game", "alloc", start);
+   metrics_observe(STAGE_FILTER, filter_start);
+
+   return p_new_game;
+}
+
+/**********************************************************************/
+/*   Split a party no game fits into sub-parties that each have one   */
+/**********************************************************************/
+int split_party(ROSTER      *p_roster,
+                char        willing_to_wait,
+                GAME_FILTER *p_filter,
+                int         *p_party_count)
+{
+   SPLIT_SEARCH       search;        /* Search for the best split     */
+   SPLIT_GAME         *p_games;      /* Every game two members share  */
+   int                party[SPLIT_MAX_PLAYERS], /* Player for each bit*/
+                      party_count = 0,  /* Members in the party       */
+                      game_count  = 0,  /* Games two members share    */
+                      game_counter,  /* Count through each game       */
+                      player_counter,/* Count through each player     */
+                      member,        /* Count through each member     */
+                      group_counter, /* Count through each sub-party  */
+                      playable,      /* Games a sub-party fits        */
+                      choice,        /* Sub-party picked to spin for  */
+                      row = HEADER_ROWS;
+   unsigned long long players,       /* Members able to play a game   */
+                      reachable = 0, /* Members sharing any game      */
+                      chosen;        /* Members of the sub-party picked*/
+   char               status;        /* A member's status for a game  */
+   long long          start;         /* When the search started       */
+
+   /* Give each member of the party one bit                           */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+      {
+         if (party_count == SPLIT_MAX_PLAYERS)
+         {
+            post_status("Parties over %d can't be split",
+                        SPLIT_MAX_PLAYERS);
+            return 0;
+         }
+         party[party_count++] = player_counter;
+      }
+
+   if ((p_games = (SPLIT_GAME *) arena_alloc(&session_arena,
+                     sizeof(SPLIT_GAME) *
+                     (2 * p_roster->amount_of_games + 1))) == NULL)
+      return 0;
+   start = trace_begin();
+
+   /* Turn every game at least two members could play, and the extra  */
+   /* column filter keeps, into a bitset                              */
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+   {
+      if (!filter_allows(p_filter, game_counter))
+         continue;
+      players = 0;
+      for (member = 0; member < party_count; member++)
+      {
+         status = roster_status(p_roster, game_counter, party[member]);
+         if (status == 'y' || (status == 'd' && willing_to_wait == 'y'))
+            players |= 1ULL << member;
+      }
+      p_games[game_count].players = players;
+      p_games[game_count].limit   = count_bits(players);
+      p_games[game_count].game    = game_counter;
+      if (p_roster->game_list[game_counter].player_limit > 0 &&
+          p_roster->game_list[game_counter].player_limit <
+             p_games[game_count].limit)
+         p_games[game_count].limit =
+            p_roster->game_list[game_counter].player_limit;
+      if (p_games[game_count].limit >= 2)
+      {
+         reachable |= players;
+         game_count++;
+      }
+   }
+
+   /* Members sharing no game sit out without being searched          */
+   memset(&search, 0, sizeof(search));
+   for (member = 0; member < party_count; member++)
+      if (reachable & (1ULL << member))
+         search.members[search.member_count++] = member;
+
+   /* The search only needs the games no other game covers, but the   */
+   /* full list is kept to count what each sub-party can play         */
+   search.p_games = p_games + game_count;
+   memcpy(search.p_games, p_games, sizeof(SPLIT_GAME) * game_count);
+   search.game_count = build_split_games(search.p_games, game_count);
+   solve_split(&search);
+   trace_end("split_party", "filter", start);
+
+   clear_screen();
+   if (search.best_covered == 0)
+   {
+      mvprintw(15, 10, "No two members of the party share a game");
+      mvprintw(16, 10, "Press any key to continue...");
+      refresh();
+      wait_key();
+      return 0;
+   }
+   if (search.timed_out && search.node_limit > 0)
+      post_status("Split search stopped after %d placements, best found "
+                  "shown", SPLIT_NODE_LIMIT);
+   else if (search.timed_out)
+      post_status("Split search stopped at %d ms, best found shown",
+                  SPLIT_TIME_LIMIT);
+
+   mvprintw(row++, 0, "No game fits the whole party. %d of %d can play "
+            "split into %d group%s:", search.best_covered, party_count,
+            search.best_group_count,
+            (search.best_group_count == 1) ? "" : "s");
+   row++;
+
+   /* Show each sub-party with a game it fits and how many it has     */
+   chosen = 0;
+   for (group_counter = 0;
+        group_counter < search.best_group_count && row < LINES - 5;
+        group_counter++)
+   {
+      playable = 0;
+      for (game_counter = 0; game_counter < game_count; game_counter++)
+         if ((search.best_groups[group_counter] &
+              ~p_games[game_counter].players) == 0 &&
+             count_bits(search.best_groups[group_counter]) <=
+                p_games[game_counter].limit)
+            playable++;
+      mvprintw(row++, 2, "%d. %d game%s to play, e.g. %s:",
+               group_counter + 1, playable, (playable == 1) ? "" : "s",
+               p_roster->game_list[search.best_games[group_counter]].game_name);
+      print_split_names(p_roster, search.best_groups[group_counter],
+                        row++, 5);
+      chosen |= search.best_groups[group_counter];
+   }
+   if (count_bits(chosen) < party_count && row < LINES - 4)
+   {
+      mvprintw(row, 2, "Sitting out:");
+      print_split_names(p_roster,
+                        ~chosen & ((party_count == 64) ? ~0ULL :
+                                   (1ULL << party_count) - 1),
+                        row++, 15);
+   }
+
+   /* A sub-party picked becomes the party to spin for                */
+   mvprintw(row + 1, 0, "Spin for which group (0 to go back)? ");
+   refresh();
+   choice = read_number();
+   if (choice >= 1 && choice <= group_counter)
+   {
+      chosen = search.best_groups[choice - 1];
+      for (member = 0; member < party_count; member++)
+         p_roster->player_list[party[member]].party_status =
+            (chosen & (1ULL << member)) != 0;
+      *p_party_count = count_bits(chosen);
+   }
+   else
+      choice = 0;
+
+   clear_screen();
+
+   return choice > 0;
+}
+
+/**********************************************************************/
+/*          Print the names of a sub-party's members on one line      */
+/**********************************************************************/
+void print_split_names(ROSTER             *p_roster,
+                       unsigned long long group,
+                       int                row,
+                       int                col)
+{
+   int member = 0,      /* Count through each member's bit            */
+       player_counter;  /* Count through each player                  */
+
+   move(row, col);
+
+   /* Bits follow the party's order in the player list                */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+      {
+         if (group & (1ULL << member))
+         {
+            if (getcurx(stdscr) + MAX_PLAYER_NAME + 2 >= COLS)
+            {
+               printw("...");
+               break;
+            }
+            printw("%s%s", (getcurx(stdscr) > col) ? ", " : "",
+                   p_roster->player_list[player_counter].player_name);
+         }
+         member++;
+      }
+
+   return;
+}
+
+/**********************************************************************/
+/*                        Amount of bits set                          */
+/**********************************************************************/
+int count_bits(unsigned long long bits)
+{
+#ifdef __GNUC__
+   return __builtin_popcountll(bits);
+#else
+   int count = 0; /* Bits counted so far                              */
+
+   for (; bits != 0; bits &= bits - 1)
+      count++;
+   return count;
+#endif
+}
+
+/**********************************************************************/
+/*           Place of the lowest bit set, bits can't be 0             */
+/**********************************************************************/
+int lowest_bit(unsigned long long bits)
+{
+#ifdef __GNUC__
+   return __builtin_ctzll(bits);
+#else
+   int place = 0; /* Bits below the lowest one set                    */
+
+   for (; (bits & 1) == 0; bits >>= 1)
+      place++;
+   return place;
+#endif
+}
+
+/**********************************************************************/
+/*     Order games with the most members able to play them first      */
+/**********************************************************************/
+int compare_split_games(const void *p_first, const void *p_second)
+{
+   const SPLIT_GAME *p_game_1 = (const SPLIT_GAME *) p_first,
+                    *p_game_2 = (const SPLIT_GAME *) p_second;
+   int              bits_1 = count_bits(p_game_1->players),
+                    bits_2 = count_bits(p_game_2->players);
+
+   if (bits_1 != bits_2)
+      return bits_2 - bits_1;
+   if (p_game_1->limit != p_game_2->limit)
+      return p_game_2->limit - p_game_1->limit;
+   return p_game_1->game - p_game_2->game; /* Keeps runs the same    */
+}
+
+/**********************************************************************/
+/*        Keep just the games no other game covers, returns how many  */
+/**********************************************************************/
+int build_split_games(SPLIT_GAME *p_games, int game_count)
+{
+   int *p_lists[SPLIT_MAX_PLAYERS],      /* Games kept with each member*/
+       list_counts[SPLIT_MAX_PLAYERS],   /* Games in each list         */
+       list_sizes[SPLIT_MAX_PLAYERS],    /* Room in each list          */
+       *p_list,                          /* List being grown           */
+       game_counter,  /* Count through each game                       */
+       kept_counter,  /* Count through the games in a list             */
+       member,        /* Count through each member                     */
+       shortest,      /* Member of the game with the fewest kept games */
+       kept = 0;      /* Games kept so far                             */
+   unsigned long long players;          /* Members of a game            */
+
+   /* A game whose members all share a bigger game, with room for as  */
+   /* many, never makes a sub-party the bigger game can't, and sorted */
+   /* biggest first the game covering it is always kept before it.    */
+   /* Whatever covers a game has every one of its members, so only    */
+   /* the games kept with its least common member are checked         */
+   qsort(p_games, game_count, sizeof(SPLIT_GAME), compare_split_games);
+   memset(p_lists, 0, sizeof(p_lists));
+   memset(list_counts, 0, sizeof(list_counts));
+   memset(list_sizes, 0, sizeof(list_sizes));
+   for (game_counter = 0; game_counter < game_count; game_counter++)
+   {
+      players  = p_games[game_counter].players;
+      shortest = -1;
+      for (member = 0; member < SPLIT_MAX_PLAYERS; member++)
+         if ((players & (1ULL << member)) &&
+             (shortest < 0 || list_counts[member] < list_counts[shortest]))
+            shortest = member;
+      for (kept_counter = 0;
+           kept_counter < list_counts[shortest];
+           kept_counter++)
+         if ((players &
+              ~p_games[p_lists[shortest][kept_counter]].players) == 0 &&
+             p_games[game_counter].limit <=
+                p_games[p_lists[shortest][kept_counter]].limit)
+            break;
+      if (kept_counter < list_counts[shortest])
+         continue;
+
+      /* Keeping a game it didn't need is only slower, so running out */
+      /* of memory for a list just leaves that list short             */
+      p_games[kept] = p_games[game_counter];
+      for (member = 0; member < SPLIT_MAX_PLAYERS; member++)
+         if (players & (1ULL << member))
+         {
+            if (list_counts[member] == list_sizes[member])
+            {
+               p_list = (int *) realloc(p_lists[member], sizeof(int) *
+                                        (list_sizes[member] * 2 + 16));
+               if (p_list == NULL)
+                  continue;
+               p_lists[member]    = p_list;
+               list_sizes[member] = list_sizes[member] * 2 + 16;
+            }
+            p_lists[member][list_counts[member]++] = kept;
+         }
+      kept++;
+   }
+   for (member = 0; member < SPLIT_MAX_PLAYERS; member++)
+      free(p_lists[member]);
+
+   return kept;
+}
+
+/**********************************************************************/
+/*    Search every core for the split letting the most members play   */
+/**********************************************************************/
+void solve_split(SPLIT_SEARCH *p_search)
+{
+   SPLIT_WORKER workers[MAX_SPLIT_THREADS]; /* Each thread's part     */
+   int          thread_counter;             /* Count through threads  */
+
+   p_search->thread_count = cpu_count();
+   if (p_search->thread_count > MAX_SPLIT_THREADS)
+      p_search->thread_count = MAX_SPLIT_THREADS;
+   p_search->best_task = 1 << 30;
+   p_search->deadline  = monotonic_ms() + SPLIT_TIME_LIMIT;
+
+   /* A session being recorded or replayed has to stop on the same    */
+   /* split whatever the machine's speed or cores, so it is searched  */
+   /* on one thread and stopped by counting placements, not the clock */
+   if (session.mode != SESSION_OFF)
+   {
+      p_search->thread_count = 1;
+      p_search->node_limit   = SPLIT_NODE_LIMIT;
+   }
+   pthread_mutex_init(&p_search->lock, NULL);
+
+   memset(workers, 0, sizeof(workers));
+   for (thread_counter = 0;
+        thread_counter < p_search->thread_count;
+        thread_counter++)
+   {
+      workers[thread_counter].thread_id = thread_counter;
+      workers[thread_counter].best_task = 1 << 30;
+      workers[thread_counter].p_search  = p_search;
+   }
+
+   /* Every thread places the first few members the same way, taking  */
+   /* every thread_count'th of the tasks they lead to, so the search  */
+   /* is shared out without a queue. A part whose thread can't start  */
+   /* is searched here afterwards                                     */
+   for (thread_counter = 1;
+        thread_counter < p_search->thread_count;
+        thread_counter++)
+      workers[thread_counter].running =
+         pthread_create(&workers[thread_counter].thread, NULL,
+                        split_search_worker, &workers[thread_counter]) == 0;
+   split_search_worker(&workers[0]);
+   for (thread_counter = 1;
+        thread_counter < p_search->thread_count;
+        thread_counter++)
+      if (workers[thread_counter].running)
+         pthread_join(workers[thread_counter].thread, NULL);
+      else
+         split_search_worker(&workers[thread_counter]);
+
+   pthread_mutex_destroy(&p_search->lock);
+   return;
+}
+
+/**********************************************************************/
+/*               Search the tasks that fall to one thread             */
+/**********************************************************************/
+void *split_search_worker(void *p_data)
+{
+   SPLIT_WORKER *p_worker = (SPLIT_WORKER *) p_data; /* Thread's part */
+
+   split_place(p_worker, 0, 0, 0, 0);
+   if (p_worker->stopped)
+   {
+      pthread_mutex_lock(&p_worker->p_search->lock);
+      p_worker->p_search->timed_out = 1;
+      pthread_mutex_unlock(&p_worker->p_search->lock);
+   }
+
+   return NULL;
+}
+
+/**********************************************************************/
+/*      Try every sub-party for a member, then the members after it   */
+/**********************************************************************/
+void split_place(SPLIT_WORKER *p_worker,
+                 int          member,
+                 int          group_count,
+                 int          placed,
+                 int          single_count)
+{
+   SPLIT_SEARCH       *p_search = p_worker->p_search; /* Shared search*/
+   unsigned long long bit,          /* Member being placed            */
+                      group;        /* Sub-party with the member added*/
+   int                group_counter,/* Count through each sub-party   */
+                      witness,      /* First game the sub-party fits  */
+                      old_witness,  /* Its game before the member     */
+                      size,         /* Members in the sub-party       */
+                      kept = 0;     /* Sub-parties of two or more     */
+
+   /* Until the tasks are reached every thread walks the same placings*/
+   if (member == SPLIT_TASK_DEPTH ||
+       (member < SPLIT_TASK_DEPTH && member == p_search->member_count))
+   {
+      p_worker->task = p_worker->task_counter++;
+      if (p_worker->task % p_search->thread_count != p_worker->thread_id)
+         return;
+   }
+
+   if (member >= SPLIT_TASK_DEPTH)
+   {
+      /* Look at the clock and at the other threads' best now and then*/
+      if (p_worker->stopped)
+         return;
+      if (++p_worker->node_count % SPLIT_CHECK_NODES == 0)
+      {
+         if (p_search->node_limit > 0 ?
+                p_worker->node_count >= p_search->node_limit :
+                monotonic_ms() > p_search->deadline)
+         {
+            p_worker->stopped = 1;
+            return;
+         }
+         pthread_mutex_lock(&p_search->lock);
+         p_worker->best_covered     = p_search->best_covered;
+         p_worker->best_group_count = p_search->best_group_count;
+         p_worker->best_task        = p_search->best_task;
+         pthread_mutex_unlock(&p_search->lock);
+      }
+
+      /* Even with every member left placed this can't do better      */
+      if (!split_beats(placed + p_search->member_count - member,
+                       group_count - single_count, p_worker->task,
+                       p_worker->best_covered, p_worker->best_group_count,
+                       p_worker->best_task))
+         return;
+   }
+
+   /* Every member placed: lone members sit out, the rest can play    */
+   if (member == p_search->member_count)
+   {
+      if (!split_beats(placed - single_count, group_count - single_count,
+                       p_worker->task, p_worker->best_covered,
+                       p_worker->best_group_count, p_worker->best_task))
+         return;
+      pthread_mutex_lock(&p_search->lock);
+      if (split_beats(placed - single_count, group_count - single_count,
+                      p_worker->task, p_search->best_covered,
+                      p_search->best_group_count, p_search->best_task))
+      {
+         for (group_counter = 0; group_counter < group_count; group_counter++)
+            if (p_worker->groups[group_counter] &
+                (p_worker->groups[group_counter] - 1))
+            {
+               p_search->best_groups[kept] = p_worker->groups[group_counter];
+               p_search->best_games[kept++] =
+                  p_search->p_games[p_worker->witnesses[group_counter]].game;
+            }
+         p_search->best_covered     = placed - single_count;
+         p_search->best_group_count = kept;
+         p_search->best_task        = p_worker->task;
+      }
+      p_worker->best_covered     = p_search->best_covered;
+      p_worker->best_group_count = p_search->best_group_count;
+      p_worker->best_task        = p_search->best_task;
+      pthread_mutex_unlock(&p_search->lock);
+      return;
+   }
+
+   bit = 1ULL << p_search->members[member];
+
+   /* Join each sub-party still fitting a game with the member added. */
+   /* Adding a member only rules games out, so the search for a game  */
+   /* picks up where the sub-party's last one was found               */
+   for (group_counter = 0; group_counter < group_count; group_counter++)
+   {
+      group = p_worker->groups[group_counter] | bit;
+      size  = count_bits(group);
+      for (witness = p_worker->witnesses[group_counter];
+           witness < p_search->game_count;
+           witness++)
+         if ((group & ~p_search->p_games[witness].players) == 0 &&
+             size <= p_search->p_games[witness].limit)
+            break;
+      if (witness < p_search->game_count)
+      {
+         old_witness = p_worker->witnesses[group_counter];
+         p_worker->groups[group_counter]    = group;
+         p_worker->witnesses[group_counter] = witness;
+         split_place(p_worker, member + 1, group_count, placed + 1,
+                     single_count - (size == 2));
+         p_worker->witnesses[group_counter] = old_witness;
+         p_worker->groups[group_counter]    = group & ~bit;
+      }
+   }
+
+   /* Start a new sub-party at the first game the member shares       */
+   for (witness = 0; witness < p_search->game_count; witness++)
+      if (p_search->p_games[witness].players & bit)
+         break;
+   p_worker->groups[group_count]    = bit;
+   p_worker->witnesses[group_count] = witness;
+   split_place(p_worker, member + 1, group_count + 1, placed + 1,
+               single_count + 1);
+
+   /* Or leave the member out                                         */
+   split_place(p_worker, member + 1, group_count, placed, single_count);
+
+   return;
+}
+
+/**********************************************************************/
+/*            Check if a split scores better than the best one        */
+/**********************************************************************/
+int split_beats(int covered, int group_count, int task,
+                int best_covered, int best_group_count, int best_task)
+{
+   /* More members playing wins, then fewer sub-parties, then the     */
+   /* task found first, so every run settles on the same split        */
+   if (covered != best_covered)
+      return covered > best_covered;
+   if (group_count != best_group_count)
+      return group_count < best_group_count;
+   return task < best_task;
+}
+
+/**********************************************************************/
+/*   Check the parties in a file against the games, then quit, or -1  */
+/*   if no file was named                                             */
+/**********************************************************************/
+int party_file_main(int argc, char *argv[])
+{
+   ROSTER       roster;        /* Games and players to check against  */
+   ROSTER_DELTA delta;         /* Unused, the roster is loaded whole  */
+   PARTY_BATCH  batch;         /* Parties read and what they can play */
+   const char   *p_file_name = NULL; /* File of parties               */
+   char         *p_text,       /* Whole file of parties               */
+                *p_line,       /* Line being read                     */
+                *p_end;        /* Newline ending it                   */
+   size_t       length;        /* Bytes in the file                   */
+   unsigned long long *p_party,/* Members of the party being printed  */
+                      *p_sets; /* Games it can play                   */
+   int          arg_counter,   /* Count through args                  */
+                list_games = 0,/* Print each party's games too        */
+                capacity = 0,  /* Parties there is room for           */
+                line_number = 0, /* Line being read                   */
+                party,         /* Count through each party            */
+                player,        /* Count through each player           */
+                game;          /* Count through each game             */
+   long long    start;         /* When checking started               */
+
+   for (arg_counter = 1; arg_counter < argc; arg_counter++)
+      if (strcmp(argv[arg_counter], PARTIES_FLAG) == 0)
+      {
+         if (arg_counter == argc - 1)
+         {
+            fprintf(stderr, "%s needs a file of parties\n", PARTIES_FLAG);
+            return 1;
+         }
+         p_file_name = argv[++arg_counter];
+      }
+      else if (strcmp(argv[arg_counter], PARTY_GAMES_FLAG) == 0)
+         list_games = 1;
+   if (p_file_name == NULL)
+      return -1;
+
+   p_text = read_whole_file(p_file_name, &length);
+   if (p_text == NULL)
+   {
+      fprintf(stderr, "Cannot read %s\n", p_file_name);
+      return 1;
+   }
+
+   /* There is no screen, so the load's status messages are only      */
+   /* queued, and what went wrong is printed instead                  */
+   event_loop_init();
+   memset(&roster, 0, sizeof(roster));
+   load_roster(&roster, NULL, &delta, NULL);
+   free_roster_delta(&delta);
+   memset(&batch, 0, sizeof(batch));
+   batch.p_roster = &roster;
+   if (roster.amount_of_games == 0 || roster.amount_of_players == 0 ||
+       roster.p_have_bits == NULL)
+   {
+      fprintf(stderr, "No game list could be loaded\n");
+      free(p_text);
+      free_roster(&roster);
+      event_loop_close();
+      return 1;
+   }
+
+   for (p_line = p_text; p_line < p_text + length; p_line = p_end + 1)
+   {
+      p_end = (char *) memchr(p_line, '\n', p_text + length - p_line);
+      if (p_end == NULL)
+         p_end = p_text + length;
+      *p_end = '\0';
+      if (!add_party_line(&batch, &capacity, p_line, ++line_number))
+         break;
+   }
+   free(p_text);
+
+   start = monotonic_us();
+   if (!check_parties(&batch, list_games))
+   {
+      fprintf(stderr, "Not enough memory to check %d parties\n",
+              batch.party_count);
+      free_party_batch(&batch);
+      free_roster(&roster);
+      event_loop_close();
+      return 1;
+   }
+   fprintf(stderr, "Checked %d parties against %d games in %lld us\n",
+           batch.party_count, roster.amount_of_games,
+           monotonic_us() - start);
+
+   /* A line a party: the games it can play now, then after its       */
+   /* downloads, then its members, and the games themselves after a   */
+   /* ':' when asked for, a '*' on those needing a download           */
+   for (party = 0; party < batch.party_count; party++)
+   {
+      p_party = batch.p_parties + (size_t) party * roster.player_words;
+      printf("%d %d", batch.p_ready[party], batch.p_waiting[party]);
+      for (player = 0; player < roster.amount_of_players; player++)
+         if ((p_party[player / 64] >> (player % 64)) & 1)
+            printf(" %s", roster.player_list[player].player_name);
+      if (list_games)
+      {
+         p_sets = batch.p_sets + (size_t) party * 2 * batch.game_words;
+         printf(" :");
+         for (game = 0; game < roster.amount_of_games; game++)
+            if ((p_sets[batch.game_words + game / 64] >> (game % 64)) & 1)
+               printf(" %s%s", roster.game_list[game].game_name,
+                      ((p_sets[game / 64] >> (game % 64)) & 1) ? "" : "*");
+      }
+      printf("\n");
+   }
+
+   free_party_batch(&batch);
+   free_roster(&roster);
+   event_loop_close();
+
+   return 0;
+}
+
+/**********************************************************************/
+/*   Add the party on a line, or with a '*' every sub-party of two or */
+/*   more of its names, returns 0 if there is no room for more        */
+/**********************************************************************/
+int add_party_line(PARTY_BATCH *p_batch,
+                   int         *p_capacity,
+                   char        *p_line,
+                   int         line_number)
+{
+   ROSTER             *p_roster = p_batch->p_roster; /* Players named */
+   unsigned long long named[(MAX_PLAYERS + 63) / 64], /* All named    */
+                      *p_parties, /* Parties with room for more       */
+                      *p_party,   /* Party being added                */
+                      subset,     /* Names in a sub-party, a bit each */
+                      subset_end; /* One past the last sub-party      */
+   int                members[MAX_SUBSET_MEMBERS], /* Players named   */
+                      member_count = 0, /* Names on the line          */
+                      every_subset = 0, /* Line starts with a '*'     */
+                      member,     /* Count through each name          */
+                      player;     /* Player with the name             */
+   char               *p_name;    /* Name being looked up             */
+
+   while (*p_line == ' ' || *p_line == '\t' || *p_line == '\r')
+      p_line++;
+   if (*p_line == '\0' || *p_line == '#')
+      return 1;
+   if (*p_line == '*')
+   {
+      every_subset = 1;
+      p_line++;
+   }
+
+   /* Names are split by spaces, tabs or commas                       */
+   memset(named, 0, sizeof(named));
+   for (p_name = strtok(p_line, " \t\r,"); p_name != NULL;
+        p_name = strtok(NULL, " \t\r,"))
+   {
+      for (player = 0; player < p_roster->amount_of_players; player++)
+         if (same_name(p_roster->player_list[player].player_name, p_name))
+            break;
+      if (player == p_roster->amount_of_players)
+      {
+         fprintf(stderr, "Line %d: nobody is named %s\n", line_number,
+                 p_name);
+         return 1;
+      }
+      if ((named[player / 64] >> (player % 64)) & 1)
+         continue;
+      if (every_subset && member_count == MAX_SUBSET_MEMBERS)
+      {
+         fprintf(stderr, "Line %d: a '*' line names at most %d players\n",
+                 line_number, MAX_SUBSET_MEMBERS);
+         return 1;
+      }
+      named[player / 64] |= 1ULL << (player % 64);
+      if (every_subset)
+         members[member_count] = player;
+      member_count++;
+   }
+   if (member_count == 0)
+      return 1;
+
+   /* A plain line is the one party of everyone named                 */
+   subset     = every_subset ? 3 : 0;
+   subset_end = every_subset ? 1ULL << member_count : 1;
+   for (; subset < subset_end; subset++)
+   {
+      if (every_subset && count_bits(subset) < 2)
+         continue;
+      if (p_batch->party_count == MAX_BATCH_PARTIES)
+      {
+         fprintf(stderr, "Line %d: more than %d parties\n", line_number,
+                 MAX_BATCH_PARTIES);
+         return 0;
+      }
+
+      /* The parties double in room whenever they fill up             */
+      if (p_batch->party_count == *p_capacity)
+      {
+         p_parties = (unsigned long long *) realloc(p_batch->p_parties,
+            sizeof(unsigned long long) * p_roster->player_words *
+            (size_t) (*p_capacity * 2 + 64));
+         if (p_parties == NULL)
+         {
+            fprintf(stderr, "Line %d: not enough memory\n", line_number);
+            return 0;
+         }
+         p_batch->p_parties = p_parties;
+         *p_capacity        = *p_capacity * 2 + 64;
+      }
+      p_party = p_batch->p_parties +
+                (size_t) p_batch->party_count++ * p_roster->player_words;
+      if (!every_subset)
+      {
+         memcpy(p_party, named, sizeof(unsigned long long) *
+                                p_roster->player_words);
+         continue;
+      }
+      memset(p_party, 0, sizeof(unsigned long long) *
+                         p_roster->player_words);
+      for (member = 0; member < member_count; member++)
+         if ((subset >> member) & 1)
+            p_party[members[member] / 64] |= 1ULL << (members[member] % 64);
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*   Count, and list if asked, the games each party can play now and  */
+/*   after downloads, the parties shared out between threads          */
+/**********************************************************************/
+int check_parties(PARTY_BATCH *p_batch, int keep_sets)
+{
+   ROSTER       *p_roster = p_batch->p_roster; /* Games to check      */
+   BATCH_WORKER workers[MAX_PARTY_THREADS]; /* Each thread's parties  */
+   int          thread_count,   /* Threads sharing the parties        */
+                thread_counter, /* Count through threads              */
+                party,          /* Count through each party           */
+                game,           /* Count through each game            */
+                word;           /* Count through each word of members */
+   long long    start = trace_begin(); /* When checking started       */
+
+   p_batch->game_words = (p_roster->amount_of_games + 63) / 64;
+   p_batch->p_limits   = (int *) malloc(sizeof(int) *
+                                        (p_roster->amount_of_games + 1));
+   p_batch->p_sizes    = (int *) malloc(sizeof(int) *
+                                        (p_batch->party_count + 1));
+   p_batch->p_ready    = (int *) malloc(sizeof(int) *
+                                        (p_batch->party_count + 1));
+   p_batch->p_waiting  = (int *) malloc(sizeof(int) *
+                                        (p_batch->party_count + 1));
+   if (keep_sets)
+      p_batch->p_sets = (unsigned long long *) calloc(
+         (size_t) p_batch->party_count * 2 * p_batch->game_words + 1,
+         sizeof(unsigned long long));
+   if (p_batch->p_limits == NULL || p_batch->p_sizes == NULL ||
+       p_batch->p_ready == NULL || p_batch->p_waiting == NULL ||
+       (keep_sets && p_batch->p_sets == NULL))
+      return 0;
+
+   /* A limit of 0 lets any party play, as it does in filter_list     */
+   for (game = 0; game < p_roster->amount_of_games; game++)
+      p_batch->p_limits[game] =
+         (p_roster->game_list[game].player_limit == 0) ?
+            MAX_PLAYERS : p_roster->game_list[game].player_limit;
+   for (party = 0; party < p_batch->party_count; party++)
+   {
+      p_batch->p_sizes[party] = 0;
+      for (word = 0; word < p_roster->player_words; word++)
+         p_batch->p_sizes[party] += count_bits(p_batch->p_parties[
+            (size_t) party * p_roster->player_words + word]);
+   }
+
+   /* Each thread takes its own run of parties, so no two ever write  */
+   /* the same counts, and a run whose thread can't start is checked  */
+   /* here afterwards                                                 */
+   thread_count = p_batch->party_count / PARTY_THREAD_MIN;
+   if (thread_count > cpu_count())
+      thread_count = cpu_count();
+   if (thread_count > MAX_PARTY_THREADS)
+      thread_count = MAX_PARTY_THREADS;
+   if (thread_count < 1)
+      thread_count = 1;
+   memset(workers, 0, sizeof(workers));
+   for (thread_counter = 0; thread_counter < thread_count; thread_counter++)
+   {
+      workers[thread_counter].p_batch     = p_batch;
+      workers[thread_counter].first_party =
+         (int) ((long long) p_batch->party_count * thread_counter /
+                thread_count);
+      workers[thread_counter].end_party   =
+         (int) ((long long) p_batch->party_count * (thread_counter + 1) /
+                thread_count);
+   }
+   for (thread_counter = 1; thread_counter < thread_count; thread_counter++)
+      workers[thread_counter].running =
+         pthread_create(&workers[thread_counter].thread, NULL,
+                        check_parties_worker, &workers[thread_counter]) == 0;
+   check_parties_worker(&workers[0]);
+   for (thread_counter = 1; thread_counter < thread_count; thread_counter++)
+      if (workers[thread_counter].running)
+         pthread_join(workers[thread_counter].thread, NULL);
+      else
+         check_parties_worker(&workers[thread_counter]);
+   trace_end("check_parties", "filter", start);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                 Check one thread's run of parties                  */
+/**********************************************************************/
+void *check_parties_worker(void *p_data)
+{
+   BATCH_WORKER       *p_worker = (BATCH_WORKER *) p_data; /* Its run */
+   PARTY_BATCH        *p_batch  = p_worker->p_batch; /* Batch shared  */
+   ROSTER             *p_roster = p_batch->p_roster; /* Games checked */
+   const unsigned long long *p_party,    /* Party being checked       */
+                            *p_have,     /* Game's row of who has it  */
+                            *p_download; /* Row of who downloads it   */
+   unsigned long long *p_sets,     /* Party's games now, then after   */
+                      lacking,     /* Members missing the game        */
+                      waiting;     /* Members missing it even after   */
+                                   /* their downloads                 */
+   int                words = p_roster->player_words, /* Words a row  */
+                      block,       /* First game of the block         */
+                      block_end,   /* One past its last game          */
+                      party,       /* Count through each party        */
+                      game,        /* Count through each game         */
+                      word,        /* Count through each word of bits */
+                      size,        /* Members in the party            */
+                      fits,       /* Party is within the game's limit */
+                      ready,       /* Games the party can play now    */
+                      after;      /* Games it can play after downloads*/
+
+   for (party = p_worker->first_party; party < p_worker->end_party; party++)
+   {
+      p_batch->p_ready[party]   = 0;
+      p_batch->p_waiting[party] = 0;
+   }
+
+   /* A block of games' rows stays in cache while every party in the  */
+   /* run is checked against it, instead of each party walking the    */
+   /* whole roster. A game fits when no member lacks it, with no      */
+   /* branch on the members or the answer                             */
+   for (block = 0; block < p_roster->amount_of_games;
+        block += PARTY_BLOCK_GAMES)
+   {
+      block_end = block + PARTY_BLOCK_GAMES;
+      if (block_end > p_roster->amount_of_games)
+         block_end = p_roster->amount_of_games;
+      for (party = p_worker->first_party;
+           party < p_worker->end_party;
+           party++)
+      {
+         p_party = p_batch->p_parties + (size_t) party * words;
+         size    = p_batch->p_sizes[party];
+         ready   = 0;
+         after   = 0;
+         for (game = block; game < block_end; game++)
+         {
+            p_have     = p_roster->p_have_bits + (size_t) game * words;
+            p_download = p_roster->p_download_bits + (size_t) game * words;
+            lacking    = 0;
+            waiting    = 0;
+            for (word = 0; word < words; word++)
+            {
+               lacking |= p_party[word] & ~p_have[word];
+               waiting |= p_party[word] & ~(p_have[word] | p_download[word]);
+            }
+            fits   = size <= p_batch->p_limits[game];
+            ready += (lacking == 0) & fits;
+            after += (waiting == 0) & fits;
+            if (p_batch->p_sets != NULL)
+            {
+               p_sets = p_batch->p_sets +
+                        (size_t) party * 2 * p_batch->game_words;
+               p_sets[game / 64] |=
+                  (unsigned long long) ((lacking == 0) & fits) << (game % 64);
+               p_sets[p_batch->game_words + game / 64] |=
+                  (unsigned long long) ((waiting == 0) & fits) << (game % 64);
+            }
+         }
+         p_batch->p_ready[party]   += ready;
+         p_batch->p_waiting[party] += after;
+      }
+   }
+
+   return NULL;
+}
+
+/**********************************************************************/
+/*               Free the parties of a batch and its answers          */
+/**********************************************************************/
+void free_party_batch(PARTY_BATCH *p_batch)
+{
+   free(p_batch->p_parties);
+   free(p_batch->p_limits);
+   free(p_batch->p_sizes);
+   free(p_batch->p_ready);
+   free(p_batch->p_waiting);
+   free(p_batch->p_sets);
+   memset(p_batch, 0, sizeof(*p_batch));
+
+   return;
+}
+
+/**********************************************************************/
+/*         Hand out memory that lasts until the arena is reset        */
+/**********************************************************************/
+void *arena_alloc(ARENA *p_arena, size_t size)
+{
+   ARENA_BLOCK *p_block = p_arena->p_blocks; /* Block handed out from */
+   size_t      header,     /* Block header, rounded up to alignment   */
+               block_size; /* Bytes the new block holds               */
+   void        *p_memory;  /* Memory handed out                       */
+
+   header = (sizeof(ARENA_BLOCK) + ARENA_ALIGN - 1) &
+            ~(size_t) (ARENA_ALIGN - 1);
+   size   = (size + ARENA_ALIGN - 1) & ~(size_t) (ARENA_ALIGN - 1);
+
+   /* A full block is left as it is and a new one, at least twice as  */
+   /* big as the last, is put in front of it                          */
+   if (p_block == NULL || p_block->size - p_block->used < size)
+   {
+      block_size = p_arena->block_size;
+      if (block_size < ARENA_BLOCK_SIZE)
+         block_size = ARENA_BLOCK_SIZE;
+      if (block_size < size)
+         block_size = size;
+      if ((p_block = (ARENA_BLOCK *) malloc(header + block_size)) == NULL)
+      {
+         metrics_count(COUNT_ALLOC_ERRORS);
+         return NULL;
+      }
+      p_block->p_next          = p_arena->p_blocks;
+      p_block->size            = block_size;
+      p_block->used            = 0;
+      p_arena->p_blocks        = p_block;
+      p_arena->block_size      = block_size * 2;
+      p_arena->bytes_reserved += block_size;
+   }
+
+   p_memory        = (char *) p_block + header + p_block->used;
+   p_block->used  += size;
+   p_arena->bytes_used += size;
+   p_arena->allocation_count++;
+   if (p_arena->bytes_used > p_arena->peak_bytes)
+      p_arena->peak_bytes = p_arena->bytes_used;
+
+   return p_memory;
+}
+
+/**********************************************************************/
+/*          Give back everything the session allocated at once        */
+/**********************************************************************/
+void arena_reset(ARENA *p_arena)
+{
+   ARENA_BLOCK *p_block; /* Block being freed                          */
+
+   metrics_arena(p_arena);
+
+   /* A session that needed more than one block frees them all, and   */
+   /* the next one starts with a single block as big as all of them,  */
+   /* so once sessions settle a reset only rewinds that block         */
+   if (p_arena->p_blocks != NULL && p_arena->p_blocks->p_next != NULL)
+   {
+      while ((p_block = p_arena->p_blocks) != NULL)
+      {
+         p_arena->p_blocks = p_block->p_next;
+         free(p_block);
+      }
+      p_arena->block_size     = p_arena->bytes_reserved;
+      p_arena->bytes_reserved = 0;
+   }
+   else if (p_arena->p_blocks != NULL)
+      p_arena->p_blocks->used = 0;
+   p_arena->bytes_used       = 0;
+   p_arena->allocation_count = 0;
+
+   return;
+}
+
+/**********************************************************************/
+/*                   Free the arena's blocks for good                 */
+/**********************************************************************/
+void arena_free(ARENA *p_arena)
+{
+   ARENA_BLOCK *p_block; /* Block being freed                          */
+
+   while ((p_block = p_arena->p_blocks) != NULL)
+   {
+      p_arena->p_blocks = p_block->p_next;
+      free(p_block);
+   }
+   memset(p_arena, 0, sizeof(ARENA));
+
+   return;
+}
+
+/**********************************************************************/
+/*          Create a new game node to add to the wheel list           */
+/**********************************************************************/
+WHEEL *create_game_node(char game_name[MAX_GAME_NAME])
+{
+   WHEEL *new_game; /* New game to add to the list                    */
+
+   if ((new_game = (WHEEL*) arena_alloc(&session_arena, 
+                                        sizeof(WHEEL))) == NULL)
+      return NULL;
+   strcpy(new_game->game_name, game_name);
+   new_game->p_next_game = NULL;
+
+   return new_game;
+}
+
+/**********************************************************************/
+/*                 Insert a game into the wheel list                  */
+/**********************************************************************/
+WHEEL *insert_game(WHEEL *p_insert_game, char game_name[MAX_GAME_NAME])
+{
+   WHEEL *new_game = create_game_node(game_name); /* New game to add  */
+                                                  /* to the list      */
+
+   if (new_game == NULL)
+      return NULL;
+   if (p_insert_game == NULL) 
+       new_game->p_next_game = new_game;
+   else
+   {
+      new_game->p_next_game      = p_insert_game->p_next_game;
+      p_insert_game->p_next_game = new_game;
+   }
+
+   return new_game; /* Return the new tail */
+}
+
+/**********************************************************************/
+/*        Get a count of all the students in the student list         */
+/**********************************************************************/
+int get_game_count(WHEEL *p_wheel_list)
+{
+   WHEEL *p_current_game;
+   int   game_count = 0;  /* Count the amount of students in the      */
+                          /* student id list                          */
+
+   p_current_game = p_wheel_list->p_next_game;
+
+   while(p_current_game != p_wheel_list)
+   {
+      p_current_game = p_current_game->p_next_game;
+      game_count++;
+   }
+
+   return game_count;
 }
 
 /**********************************************************************/
 /*                   Spin the wheel to pick a game                    */
 /**********************************************************************/
-void wheel(WHEEL **p_current_game, int game_count) 
+void wheel(WHEEL **p_current_game, int game_count) 
+{
+   int spin_amount;    /* Random spin amount                          */
+      
+   srand(session_seed());
+   spin_amount = game_count + rand() % ((game_count * 2) - game_count + 1);
+   spin_wheel(p_current_game, spin_amount);
+
+   return;
+}
+
+/**********************************************************************/
+/*          Animate the wheel turning a given amount of games         */
+/**********************************************************************/
+void spin_wheel(WHEEL **p_current_game, int spin_amount)
+{
+   int spin_counter;   /* Count wheel rotations                       */
+   int start_row = HEADER_ROWS + 4;  /* Where wheel starts on screen  */
+   int start_col = 8;  /* Left margin                                 */
+   EVENT event;        /* Event from the event loop                   */
+   EVENT held[EVENT_QUEUE_SIZE]; /* Events that came during the spin  */
+   int   held_count = 0;         /* Events held back                  */
+   long long spin_start = trace_begin(), /* When the spin started     */
+             frame_start;                /* When the frame started    */
+
+   if ((*p_current_game) == NULL)
+   {
+      clear_screen();
+      mvprintw(15, 10, "No games in the list...");
+      refresh();
+      wait_ms(2000);
+      exit(NO_LIST_ERR);
+   }
+
+   clear_screen(); /* Clear ONCE at the start                         */
+   
+   /* Draw the wheel FRAME once (doesn't change)                      */
+   mvprintw(start_row,      start_col, "               .-------.");
+   mvprintw(start_row + 2,  start_col, "   ____________|_______|____________");
+   mvprintw(start_row + 3,  start_col, "  |  _      _     _____ _____ _     |");
+   mvprintw(start_row + 4,  start_col, "  | / \\  /|/ \\ /|/  __//  __// \\    |");
+   mvprintw(start_row + 5,  start_col, "  | | |  ||| |_|||  \\  |  \\  | |    |");
+   mvprintw(start_row + 6,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |    |");
+   mvprintw(start_row + 7,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |_/\\ |");
+   mvprintw(start_row + 8,  start_col, "  | \\_/  \\|\\_/ \\|\\_____\\_____\\____/ |");
+   mvprintw(start_row + 9,  start_col, "  |===_______===_______===_______===|");
+   mvprintw(start_row + 10, start_col, "  ||*|                           |*||");
+   mvprintw(start_row + 11, start_col, "  ||*|                           |*||");  /* Game 1 here */
+   mvprintw(start_row + 12, start_col, "  ||*|___________________________|*||");
+   mvprintw(start_row + 13, start_col, "  |===_______===_______===_______===|");
+   mvprintw(start_row + 14, start_col, "  ||*|\\                          |*||");
+   mvprintw(start_row + 15, start_col, "  ||*| >                         |*||");  /* Game 2 (selected) */
+   mvprintw(start_row + 16, start_col, "  ||*|/__________________________|*||_");
+   mvprintw(start_row + 17, start_col, "  |===_______===_______===_______===|_\\");
+   mvprintw(start_row + 18, start_col, "  ||*|                           |*|| \\\\");
+   mvprintw(start_row + 19, start_col, "  ||*|                           |*||  ||");  /* Game 3 here */
+   mvprintw(start_row + 20, start_col, "  ||*|___________________________|*||  ||");
+   mvprintw(start_row + 21, start_col, "  |===___________________________===|  ||");
+   mvprintw(start_row + 22, start_col, "  |  /___________________________\\  | (__)");
+   mvprintw(start_row + 23, start_col, "  |   |                         |   |");
+   mvprintw(start_row + 24, start_col, " _|    \\_______________________/    |_");
+   mvprintw(start_row + 25, start_col, "(_____________________________________)");
+   
+   /* Now animate by ONLY updating the changing parts, one frame per  */
+   /* animation timer tick so resizes and workers are still served    */
+   start_timer(TIMER_ANIMATION, 0, ANIMATION_DELAY);
+   spin_counter = 0;
+   while (spin_counter < spin_amount)
+   { 
+      /* A replay spins at full speed                                 */
+      if (session.mode != SESSION_REPLAY)
+      {
+         next_event(&event);
+         if (event.type != EV_TIMER || event.value != TIMER_ANIMATION)
+         {
+            /* Keys and finished work are for whoever waits next      */
+            if (event.type != EV_TIMER && held_count < EVENT_QUEUE_SIZE)
+               held[held_count++] = event;
+            continue;
+         }
+      }
+
+      frame_start       = trace_begin();
+      (*p_current_game) = (*p_current_game)->p_next_game;
+      
+      /* Update ONLY the counter (top of wheel)                       */
+      move(start_row + 1, start_col + 15);
+      clrtoeol();  /* Clear old number                                */
+      printw("|  %3d  |", spin_counter);
+      
+      /* Update ONLY game 1 name (previous game)                      */
+      move(start_row + 11, start_col + 10);
+      clrtoeol();
+      printw("%20s   |*||", (*p_current_game)->game_name);
+      
+      /* Update ONLY game 2 name (current/selected game with arrow)   */
+      move(start_row + 15, start_col + 10);
+      clrtoeol();
+      printw("  %20s |*||", (*p_current_game)->p_next_game->game_name);
+      
+      /* Update ONLY game 3 name (next game)                          */
+      move(start_row + 19, start_col + 10);
+      clrtoeol();
+      printw("%20s   |*||  ||", 
+             (*p_current_game)->p_next_game->p_next_game->game_name);
+      
+      refresh();       /* Show the updates                             */
+      trace_end("frame", "render", frame_start);
+      spin_counter++;
+   }
+   stop_timer(TIMER_ANIMATION);
+   requeue_events(held, held_count);
+   trace_end("wheel", "spin", spin_start);
+   metrics_observe(STAGE_SPIN, spin_start);
+   
+   return;
+}
+
+/**********************************************************************/
+/*               Print the selected game from the wheel               */
+/**********************************************************************/
+void selected_game(char previous_game[MAX_GAME_NAME],
+                   char selected_game[MAX_GAME_NAME],
+                   char next_game[MAX_GAME_NAME],
+                   int  game_count)
+{
+   int start_row = HEADER_ROWS + 4;  /* Where wheel starts on screen  */
+   int start_col = 8;  /* Left margin                                 */
+   
+   clear_screen();  /* Clear screen for final display                 */
+   
+   /* Draw the complete wheel with final selection                    */
+   mvprintw(start_row,      start_col, "               .-------.");
+   mvprintw(start_row + 1,  start_col, "               |  %3d  |", game_count);
+   mvprintw(start_row + 2,  start_col, "   ____________|_______|____________");
+   mvprintw(start_row + 3,  start_col, "  |  _      _     _____ _____ _     |");
+   mvprintw(start_row + 4,  start_col, "  | / \\  /|/ \\ /|/  __//  __// \\    |");
+   mvprintw(start_row + 5,  start_col, "  | | |  ||| |_|||  \\  |  \\  | |    |");
+   mvprintw(start_row + 6,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |    |");
+   mvprintw(start_row + 7,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |_/\\ |");
+   mvprintw(start_row + 8,  start_col, "  | \\_/  \\|\\_/ \\|\\_____\\_____\\____/ |");
+   mvprintw(start_row + 9,  start_col, "  |===_______===_______===_______===|");
+   mvprintw(start_row + 10, start_col, "  ||*|                           |*||");
+   mvprintw(start_row + 11, start_col, "  ||*|       %20s|*||  __", previous_game);
+   mvprintw(start_row + 12, start_col, "  ||*|___________________________|*|| (  )");
+   mvprintw(start_row + 13, start_col, "  |===_______===_______===_______===|  ||");
+   mvprintw(start_row + 14, start_col, "  ||*|\\                          |*||  ||");
+   mvprintw(start_row + 15, start_col, "  ||*| >     %20s|*||  ||", selected_game);
+   mvprintw(start_row + 16, start_col, "  ||*|/__________________________|*||_//");
+   mvprintw(start_row + 17, start_col, "  |===_______===_______===_______===|_/");
+   mvprintw(start_row + 18, start_col, "  ||*|                           |*||");
+   mvprintw(start_row + 19, start_col, "  ||*|       %20s|*||", next_game);
+   mvprintw(start_row + 20, start_col, "  ||*|___________________________|*||");
+   mvprintw(start_row + 21, start_col, "  |===___________________________===|");
+   mvprintw(start_row + 22, start_col, "  |  /___________________________\\  |");
+   mvprintw(start_row + 23, start_col, "  |   |     %20s|   |", selected_game);
+   mvprintw(start_row + 24, start_col, " _|    \\_______________________/    |_");
+   mvprintw(start_row + 25, start_col, "(_____________________________________)");
+   
+   refresh();  /* Display it all                                      */
+
+   return;
+}
+
+/**********************************************************************/
+/*                     Clear screen below header                      */
+/**********************************************************************/
+void clear_screen()
+{
+   int row = HEADER_ROWS;
+
+   /* A pending message would otherwise clear a row of the next screen*/
+   stop_timer(TIMER_MESSAGE);
+
+   while (row < LINES)
+   {
+      move(row, 0);
+      clrtoeol();
+      row++;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*           Take a game off the wheel, keeping it to undo            */
+/**********************************************************************/
+void remove_game(WHEEL_UNDO *p_undo, WHEEL *p_game)
+{
+   WHEEL   *p_temp_game; /* Game being taken off the wheel            */
+   REMOVAL *p_grown;     /* Removals with room for more               */
+   int     capacity;     /* Removals there will be room for           */
+
+   if (p_game != NULL && p_game != p_game->p_next_game) 
+   {
+      metrics_count(COUNT_REROLLS);
+      p_temp_game         = p_game->p_next_game;
+      p_game->p_next_game = p_game->p_next_game->p_next_game;
+
+      /* A new removal can no longer be redone past, and the ones     */
+      /* undone are already back on the wheel                         */
+      p_undo->removal_count = p_undo->applied_count;
+      /* The log doubles in the session arena, the old copy going     */
+      /* back with everything else when the session ends              */
+      if (p_undo->applied_count == p_undo->capacity)
+      {
+         capacity = p_undo->capacity > 0 ? p_undo->capacity * 2 : 64;
+         p_grown  = (REMOVAL *) arena_alloc(&session_arena,
+                                            sizeof(REMOVAL) * capacity);
+         if (p_grown != NULL)
+         {
+            if (p_undo->applied_count > 0)
+               memcpy(p_grown, p_undo->p_removals,
+                      sizeof(REMOVAL) * p_undo->applied_count);
+            p_undo->p_removals = p_grown;
+            p_undo->capacity   = capacity;
+         }
+      }
+
+      /* The removed game keeps its link to the next one, so putting  */
+      /* it back is a single link                                     */
+      if (p_undo->applied_count < p_undo->capacity)
+      {
+         p_undo->p_removals[p_undo->applied_count].p_before = p_game;
+         p_undo->p_removals[p_undo->applied_count].p_game   = p_temp_game;
+         p_undo->removal_count = ++p_undo->applied_count;
+      }
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*             Put the last game removed back where it was            */
+/**********************************************************************/
+int undo_removal(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list)
+{
+   REMOVAL *p_removal; /* Removal being undone                        */
+
+   if (p_undo->applied_count == 0)
+      return 0;
+
+   /* Every later removal is undone already, so the game before this  */
+   /* one points where the removed game pointed                       */
+   p_removal = &p_undo->p_removals[--p_undo->applied_count];
+   p_removal->p_before->p_next_game = p_removal->p_game;
+   *p_wheel_list = p_removal->p_before;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*               Remove the last game put back again                  */
+/**********************************************************************/
+int redo_removal(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list)
+{
+   REMOVAL *p_removal; /* Removal being redone                        */
+
+   if (p_undo->applied_count == p_undo->removal_count)
+      return 0;
+
+   metrics_count(COUNT_REROLLS);
+   p_removal = &p_undo->p_removals[p_undo->applied_count++];
+   p_removal->p_before->p_next_game = p_removal->p_game->p_next_game;
+   *p_wheel_list = p_removal->p_before;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                Put every removed game back on the wheel            */
+/**********************************************************************/
+void restore_wheel(WHEEL_UNDO *p_undo, WHEEL **p_wheel_list)
+{
+   /* Undoing newest first leaves the wheel just as it was filtered,  */
+   /* and every removal can still be redone                           */
+   while (undo_removal(p_undo, p_wheel_list))
+      ;
+
+   return;
+}
+
+/**********************************************************************/
+/*                       Forget the removed games                     */
+/**********************************************************************/
+void free_wheel_undo(WHEEL_UNDO *p_undo)
+{
+   /* The removed games and their log went back with the arena        */
+   memset(p_undo, 0, sizeof(*p_undo));
+
+   return;
+}
+
+/**********************************************************************/
+/*           Clear the party and the wheel for another spin           */
+/**********************************************************************/
+void reset(PLAYER player_list[], 
+           WHEEL  **p_wheel_list, 
+           int    amount_of_games, 
+           int    amount_of_players, 
+           int    *p_party_count,
+           char   *p_remove_game_check)
+{
+   int player_counter;  /* Count through each player in it's list      */
+
+   for (player_counter =  0; 
+        player_counter < amount_of_players; 
+        player_counter++)
+      player_list[player_counter].party_status = 0;
+
+   /* Every game on the wheel, and everything else the session        */
+   /* allocated, goes back in one go                                  */
+   arena_reset(&session_arena);
+   if (p_wheel_list != NULL)
+      (*p_wheel_list) = NULL; 
+
+   *p_party_count       = 0;
+   *p_remove_game_check = 'y';
+
+   return;
+}
+
+/**********************************************************************/
+/*                         Load data manually                         */
+/**********************************************************************/
+void load_data_manual(ROSTER *p_roster)
+{
+   int    player_counter, /* Count through each player                */
+          game_counter;   /* Count through each game                  */
+
+   /* The roster was compiled from the sheet into wheel_roster.h, so  */
+   /* it is copied in as it is with nothing to parse                  */
+   if (!allocate_roster(p_roster, ROSTER_GAMES, ROSTER_PLAYERS))
+      return;
+
+   for (player_counter = 0;
+        player_counter < ROSTER_PLAYERS;
+        player_counter++)
+      memcpy(p_roster->player_list[player_counter].player_name,
+             roster_player_names[player_counter], MAX_PLAYER_NAME);
+
+   /* Each status row is packed into its game's bits                  */
+   for (game_counter = 0; game_counter < ROSTER_GAMES; game_counter++)
+   {
+      p_roster->game_list[game_counter].player_limit =
+         roster_player_limits[game_counter];
+      memcpy(p_roster->game_list[game_counter].game_name,
+             roster_game_names[game_counter], MAX_GAME_NAME);
+      set_owner_bits(p_roster, game_counter, roster_status_rows +
+                     (size_t) game_counter * (ROSTER_PLAYERS + 1));
+   }
+   
+   /* Display completion message                                      */
+   post_status("Manual data loaded successfully!");
+
+   return;
+}
+
+/**********************************************************************/
+/*                  Clear the data in game file                       */
+/**********************************************************************/
+void clear_game_file()
+{
+   FILE *p_game_file;  /* Pointer to game file                       */
+   
+   /* Open file in write mode (truncates/empties the file)            */
+   p_game_file = fopen(GAME_FILE, "w");
+   fclose(p_game_file);
+   
+   return;
+}
+
+/**********************************************************************/
+/*                    Initializes ncurses settings                    */
+/**********************************************************************/
+void ncurses_setup()
+{
+    /* Initializes ncurses mode and settings, drawing nowhere for a   */
+    /* replay so it runs without a terminal                           */
+    if (session.mode == SESSION_REPLAY)
+    {
+        session.p_screen = fopen(NULL_DEVICE, "w");
+        if (session.p_screen == NULL ||
+            (newterm(NULL, session.p_screen, stdin) == NULL &&
+             newterm(REPLAY_TERM, session.p_screen, stdin) == NULL))
+            session_fail("No screen could be set up");
+    }
+    else
+        initscr();
+    cbreak();
+    noecho();
+    keypad(stdscr, TRUE);
+    curs_set(0);
+
+    /* Configures color pairs if terminal supports colors             */
+    if (has_colors())
+    {
+        start_color();
+
+        /* Checks if terminal supports custom color definitions       */
+        if (can_change_color())
+        {
+            /* Defines custom orange color (color index 8)             */
+            /* RGB values are 0-1000 in ncurses                        */
+            init_color(8, 1000, 647, 0);  
+        }
+
+        /* Defines color pairs for UI elements                         */
+        init_pair(CP_BG,           COLOR_WHITE,  COLOR_BLACK);
+        init_pair(CP_HEADER,       8,            COLOR_BLACK);
+        init_pair(CP_NORMAL,       COLOR_WHITE,  COLOR_BLACK);
+        init_pair(CP_A,            COLOR_GREEN,  COLOR_BLACK);
+        init_pair(CP_B,            COLOR_BLUE,   COLOR_BLACK);
+        init_pair(CP_C,            COLOR_WHITE,  COLOR_BLACK);
+        init_pair(CP_D,            COLOR_YELLOW, COLOR_BLACK);
+        init_pair(CP_F,            COLOR_RED,    COLOR_BLACK);
+        init_pair(CP_BORDER,       COLOR_WHITE,  COLOR_BLACK);
+        init_pair(CP_FOOTER,       COLOR_WHITE,  COLOR_BLACK);
+        init_pair(CP_DANGER,       COLOR_WHITE,  COLOR_RED);
+        init_pair(CP_TITLE,        COLOR_WHITE,  COLOR_BLUE);
+        init_pair(CP_HIGHLIGHT_BG, COLOR_WHITE,  8);
+        init_pair(CP_SCROLL,       8,            COLOR_BLACK);
+    }
+
+    /* Sets background color and refreshes screen                     */
+    bkgd(COLOR_PAIR(CP_BG));
+    session_screen();
+    refresh();
+}
+
+/**********************************************************************/
+/*                      Check the terminal size                       */
+/**********************************************************************/
+void check_term_size()
+{
+   
+   int term_rows,                  /* Terminal rows                   */
+       term_cols;                  /* Terminal columns                */
+   /* Check minimum terminal size - should pass now!                  */
+   getmaxyx(stdscr, term_rows, term_cols);
+   
+   if (term_cols < 50 || term_rows < 50)
+   {
+      clear();
+      mvprintw(5, 0, "========================================================");
+      mvprintw(6, 0, "            ERROR: Terminal Wrong Size");
+      mvprintw(7, 0, "========================================================");
+      mvprintw(9, 0,  "Current size: %d columns x %d rows", term_cols, term_rows);
+      mvprintw(10, 0, "Required:     50 columns x 45 rows (minimum)");
+      mvprintw(12, 0, "The window should have auto-resized.");
+      mvprintw(13, 0, "If you see this message, please report the issue.");
+      mvprintw(15, 0, "Press any key to continue anyway...");
+      mvprintw(16, 0, "========================================================");
+      refresh();
+      wait_key();
+      clear_screen();
+   }
+}
+
+/**********************************************************************/
+/*             Handles keyboard input for menu navigation             */
+/**********************************************************************/
+int get_menu_input(int *highlighted_choice, int option_count)
+{
+    int key;    /* Key pressed by user                                */
+
+    /* Gets keyboard input                                             */
+    key = wait_key();
+
+    /* Processes navigation keys                                       */
+    switch (key)
+    {
+        case KEY_LEFT:
+            *highlighted_choice = (*highlighted_choice - 1 + option_count) 
+                                  % option_count;
+            break;
+        case KEY_RIGHT:
+            *highlighted_choice = (*highlighted_choice + 1) % option_count;
+            break;
+        case '\n':
+            return key;
+    }
+
+    return key;
+}
+/**********************************************************************/
+/*                      Set up the event loop                         */
+/**********************************************************************/
+void event_loop_init()
+{
+   memset(&event_loop, 0, sizeof(event_loop));
+   pthread_mutex_init(&event_loop.queue_lock, NULL);
+
+#ifdef _WIN32
+   /* Auto-reset event the loop waits on next to the console input    */
+   event_loop.wake_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+#else
+   /* Self-pipe so workers can wake the poll() in next_event()        */
+   if (pipe(event_loop.wake_pipe) == 0)
+   {
+      fcntl(event_loop.wake_pipe[0], F_SETFL, O_NONBLOCK);
+      fcntl(event_loop.wake_pipe[1], F_SETFL, O_NONBLOCK);
+   }
+#endif
+
+   /* getch() only drains keys the wait said are ready                */
+   nodelay(stdscr, TRUE);
+
+   /* Esc clears a search, so don't make it wait a whole second       */
+   set_escdelay(100);
+
+   return;
+}
+
+/**********************************************************************/
+/*                     Tear down the event loop                       */
+/**********************************************************************/
+void event_loop_close()
+{
+#ifdef _WIN32
+   CloseHandle(event_loop.wake_event);
+#else
+   close(event_loop.wake_pipe[0]);
+   close(event_loop.wake_pipe[1]);
+#endif
+   pthread_mutex_destroy(&event_loop.queue_lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*              Milliseconds from a clock that never jumps            */
+/**********************************************************************/
+long long monotonic_ms()
+{
+   struct timespec now; /* Current monotonic time                     */
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (long long) now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+/**********************************************************************/
+/*                 Add an event to the end of the queue               */
+/**********************************************************************/
+void queue_event(int type, int value, void *p_data, const char *message)
+{
+   EVENT *p_event; /* Free slot at the end of the queue               */
+
+   pthread_mutex_lock(&event_loop.queue_lock);
+
+   /* Status messages give way before the queue can fill, so a worker */
+   /* finishing can always be queued                                  */
+   if (event_loop.queue_count < EVENT_QUEUE_SIZE - 8 ||
+      (event_loop.queue_count < EVENT_QUEUE_SIZE && type != EV_STATUS))
+   {
+      p_event = &event_loop.queue[(event_loop.queue_head + 
+                                   event_loop.queue_count) % 
+                                  EVENT_QUEUE_SIZE];
+      p_event->type   = type;
+      p_event->value  = value;
+      p_event->p_data = p_data;
+      p_event->message[0] = '\0';
+      if (message != NULL)
+         snprintf(p_event->message, sizeof(p_event->message), "%s", 
+                  message);
+      event_loop.queue_count++;
+   }
+
+   pthread_mutex_unlock(&event_loop.queue_lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*         Put events set aside back at the front of the queue        */
+/**********************************************************************/
+void requeue_events(EVENT held[], int held_count)
+{
+   pthread_mutex_lock(&event_loop.queue_lock);
+
+   /* Last first, so they come back off the queue in the same order   */
+   while (held_count > 0 && event_loop.queue_count < EVENT_QUEUE_SIZE)
+   {
+      event_loop.queue_head = (event_loop.queue_head + 
+                               EVENT_QUEUE_SIZE - 1) % EVENT_QUEUE_SIZE;
+      event_loop.queue[event_loop.queue_head] = held[--held_count];
+      event_loop.queue_count++;
+   }
+
+   pthread_mutex_unlock(&event_loop.queue_lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*             Wake the event loop from another thread                */
+/**********************************************************************/
+void wake_event_loop()
+{
+#ifdef _WIN32
+   SetEvent(event_loop.wake_event);
+#else
+   /* A full pipe already means the loop will wake up                 */
+   if (write(event_loop.wake_pipe[1], "", 1) < 0)
+      return;
+#endif
+
+   return;
+}
+
+/**********************************************************************/
+/*          Queue an event from any thread and wake the loop          */
+/**********************************************************************/
+void post_event(int type, int value, void *p_data)
+{
+   queue_event(type, value, p_data, NULL);
+   wake_event_loop();
+
+   return;
+}
+
+/**********************************************************************/
+/*          Queue a status line message from any thread               */
+/**********************************************************************/
+void post_status(const char *format, ...)
+{
+   char    message[STATUS_MSG_LEN]; /* Formatted message              */
+   va_list arguments;               /* Values for the format          */
+
+   va_start(arguments, format);
+   vsnprintf(message, sizeof(message), format, arguments);
+   va_end(arguments);
+
+   queue_event(EV_STATUS, 0, NULL, message);
+   wake_event_loop();
+
+   return;
+}
+
+/**********************************************************************/
+/*          Check if background work has been told to quit            */
+/**********************************************************************/
+int background_stopping()
+{
+   int stopping; /* Copy of the flag read under the lock              */
+
+   pthread_mutex_lock(&event_loop.queue_lock);
+   stopping = event_loop.stopping;
+   pthread_mutex_unlock(&event_loop.queue_lock);
+
+   return stopping;
+}
+
+/**********************************************************************/
+/*                 Start a one shot or repeating timer                */
+/**********************************************************************/
+void start_timer(int timer_id, int delay, int period)
+{
+   event_loop.timers[timer_id].active   = 1;
+   event_loop.timers[timer_id].deadline = monotonic_ms() + delay;
+   event_loop.timers[timer_id].period   = period;
+
+   return;
+}
+
+/**********************************************************************/
+/*                           Stop a timer                             */
+/**********************************************************************/
+void stop_timer(int timer_id)
+{
+   event_loop.timers[timer_id].active = 0;
+
+   return;
+}
+
+/**********************************************************************/
+/*        Queue due timers and get the wait until the next one        */
+/**********************************************************************/
+int check_timers()
+{
+   long long now = monotonic_ms(); /* Current time                    */
+   long long wait = -1;            /* Milliseconds until next timer   */
+   int       timer_id;             /* Count through each timer        */
+   TIMER     *p_timer;             /* Timer being checked             */
+
+   for (timer_id = 0; timer_id < MAX_TIMERS; timer_id++)
+   {
+      p_timer = &event_loop.timers[timer_id];
+      if (!p_timer->active)
+         continue;
+
+      if (p_timer->deadline <= now)
+      {
+         queue_event(EV_TIMER, timer_id, NULL, NULL);
+
+         /* Keep repeating timers on their own schedule, but never    */
+         /* queue a burst of frames after a long stall                */
+         if (p_timer->period > 0)
+         {
+            p_timer->deadline += p_timer->period;
+            if (p_timer->deadline <= now)
+               p_timer->deadline = now + p_timer->period;
+         }
+         else
+            p_timer->active = 0;
+      }
+
+      if (p_timer->active && 
+         (wait < 0 || p_timer->deadline - now < wait))
+         wait = p_timer->deadline - now;
+   }
+
+   return (int) wait;
+}
+
+/**********************************************************************/
+/*      Block until the terminal, a worker or the timeout wakes us    */
+/**********************************************************************/
+void wait_for_wakeup(int timeout)
+{
+#ifdef _WIN32
+   HANDLE handles[2]; /* Console input and the worker wake event      */
+
+   handles[0] = GetStdHandle(STD_INPUT_HANDLE);
+   handles[1] = event_loop.wake_event;
+   WaitForMultipleObjects(2, handles, FALSE, 
+                          timeout < 0 ? INFINITE : (DWORD) timeout);
+#else
+   struct pollfd wait_fds[2]; /* Terminal input and the wake pipe     */
+   char          drain[64];   /* Bytes emptied out of the wake pipe   */
+
+   wait_fds[0].fd     = STDIN_FILENO;
+   wait_fds[0].events = POLLIN;
+   wait_fds[1].fd     = event_loop.wake_pipe[0];
+   wait_fds[1].events = POLLIN;
+
+   /* SIGWINCH interrupts the poll, then getch() reports KEY_RESIZE   */
+   if (poll(wait_fds, 2, timeout) > 0 && (wait_fds[1].revents & POLLIN))
+      while (read(event_loop.wake_pipe[0], drain, sizeof(drain)) > 0)
+         ;
+#endif
+
+   return;
+}
+
+/**********************************************************************/
+/*           Wait for the next event the screen has to handle         */
+/**********************************************************************/
+int next_event(EVENT *p_event)
+{
+   int have_event, /* An event came off the queue                     */
+       timeout,    /* Milliseconds to wait for the next timer         */
+       key;        /* Key read from the terminal                      */
+
+   while (1)
+   {
+      /* Take the oldest queued event                                 */
+      pthread_mutex_lock(&event_loop.queue_lock);
+      have_event = event_loop.queue_count > 0;
+      if (have_event)
+      {
+         *p_event = event_loop.queue[event_loop.queue_head];
+         event_loop.queue_head = (event_loop.queue_head + 1) % 
+                                 EVENT_QUEUE_SIZE;
+         event_loop.queue_count--;
+      }
+      pthread_mutex_unlock(&event_loop.queue_lock);
+
+      if (have_event)
+      {
+         /* Events every screen handles the same way                  */
+         if (p_event->type == EV_STATUS)
+         {
+            move(LINES - 1, 0);
+            clrtoeol();
+            printw("%s", p_event->message);
+            refresh();
+         }
+         else if (p_event->type == EV_TIMER && 
+                  p_event->value == TIMER_MESSAGE)
+         {
+            move(event_loop.message_row, 0);
+            clrtoeol();
+            refresh();
+         }
+         else if (p_event->type == EV_TIMER && 
+                  p_event->value == TIMER_METRICS)
+            metrics_write();
+         else if (p_event->type == EV_WORK_DONE)
+         {
+            ((LOAD_JOB *) p_event->p_data)->finished = 1;
+            return p_event->type;
+         }
+         else if (p_event->type == EV_PLAYERS_READY)
+         {
+            ((LOAD_JOB *) p_event->p_data)->players_ready = 1;
+            return p_event->type;
+         }
+         else
+            return p_event->type;
+         continue;
+      }
+
+      /* Queue any timers that are due, then sleep until the next one */
+      /* fires, a key is pressed, or a worker posts something         */
+      timeout = check_timers();
+      pthread_mutex_lock(&event_loop.queue_lock);
+      have_event = event_loop.queue_count > 0;
+      pthread_mutex_unlock(&event_loop.queue_lock);
+      if (!have_event)
+         wait_for_wakeup(timeout);
+
+      /* Drain every key ncurses has, so none hide in its buffer      */
+      while ((key = getch()) != ERR)
+      {
+         if (key == KEY_RESIZE)
+            queue_event(EV_RESIZE, key, NULL, NULL);
+         else
+            queue_event(EV_KEY, key, NULL, NULL);
+      }
+   }
+}
+
+/**********************************************************************/
+/*       Wait for the next key press, handling other events meanwhile */
+/**********************************************************************/
+int wait_key()
+{
+   EVENT event; /* Event from the event loop                          */
+
+   if (session.mode == SESSION_REPLAY)
+      return session_replay_key();
+
+   while (1)
+   {
+      next_event(&event);
+      if (event.type == EV_KEY)
+         return session_key(event.value);
+      if (event.type == EV_RESIZE)
+         return session_key(KEY_RESIZE);
+   }
+}
+
+/**********************************************************************/
+/*      Pause without blocking resizes and background messages       */
+/**********************************************************************/
+void wait_ms(int delay)
+{
+   EVENT event;                  /* Event from the event loop         */
+   EVENT held[EVENT_QUEUE_SIZE]; /* Events that came during the pause */
+   int   held_count = 0;         /* Events held back                  */
+
+   if (session.mode == SESSION_REPLAY)
+      return;
+
+   start_timer(TIMER_WAIT, delay, 0);
+   while (next_event(&event) != EV_TIMER || event.value != TIMER_WAIT)
+      /* Keys typed during the pause are for whoever waits next       */
+      if (event.type != EV_TIMER && held_count < EVENT_QUEUE_SIZE)
+         held[held_count++] = event;
+   requeue_events(held, held_count);
+
+   return;
+}
+
+/**********************************************************************/
+/*                  Read a number typed at the cursor                 */
+/**********************************************************************/
+int read_number()
+{
+   char digits[MAX_NUMBER_DIGITS + 1]; /* Digits typed so far         */
+   int  length = 0,                    /* Amount of digits typed      */
+        key,                           /* Key pressed by user         */
+        row,                           /* Where the number is echoed  */
+        col;
+
+   getyx(stdscr, row, col);
+   digits[0] = '\0';
+
+   /* Loop until user presses Enter after at least one digit          */
+   while (1)
+   {
+      key = wait_key();
+
+      if ((key == '\n' || key == KEY_ENTER) && length > 0)
+         break;
+      else if ((key == KEY_BACKSPACE || key == 127 || key == '\b') && 
+               length > 0)
+         digits[--length] = '\0';
+      else if (key >= '0' && key <= '9' && length < MAX_NUMBER_DIGITS)
+      {
+         digits[length++] = (char) key;
+         digits[length]   = '\0';
+      }
+
+      /* Echo what has been typed                                     */
+      move(row, col);
+      clrtoeol();
+      printw("%s", digits);
+      refresh();
+   }
+
+   /* Clear the echo so the prompt is blank for the next number       */
+   move(row, col);
+   clrtoeol();
+
+   return atoi(digits);
+}
+
+/**********************************************************************/
+/*           Show a message that clears itself after a while          */
+/**********************************************************************/
+void show_message(int row, const char *message, int duration)
+{
+   move(row, 0);
+   clrtoeol();
+   printw("%s", message);
+   refresh();
+
+   event_loop.message_row = row;
+   start_timer(TIMER_MESSAGE, duration, 0);
+
+   return;
+}
+
+/**********************************************************************/
+/*          Load the game and player lists on the worker thread       */
+/**********************************************************************/
+void *load_worker(void *p_data)
+{
+   LOAD_JOB *p_job = (LOAD_JOB *) p_data; /* Job being loaded         */
+
+   load_roster(&p_job->roster, p_job->p_base, &p_job->delta,
+               p_job->early ? p_job : NULL);
+   post_event(EV_WORK_DONE, 0, p_job);
+
+   return NULL;
+}
+
+/**********************************************************************/
+/*      Start loading the game and player lists in the background     */
+/**********************************************************************/
+void start_load(LOAD_JOB *p_job, ROSTER *p_base)
+{
+#ifndef _WIN32
+   sigset_t resize_signal,   /* SIGWINCH, blocked in the worker       */
+            old_mask;        /* Signal mask to restore afterwards     */
+#endif
+
+   p_job->finished      = 0;
+   p_job->p_base        = p_base;
+   p_job->players_ready = 0;
+   p_job->player_count  = 0;
+   p_job->p_players     = NULL;
+   memset(&p_job->roster, 0, sizeof(p_job->roster));
+   memset(&p_job->delta, 0, sizeof(p_job->delta));
+
+   /* A replay takes its lists from the recording instead             */
+   if (session.mode == SESSION_REPLAY)
+   {
+      p_job->running  = 0;
+      p_job->finished = 1;
+      p_job->early    = 0;
+      return;
+   }
+
+   /* With no roster yet, the players are handed over as soon as the  */
+   /* sheet's header is in; the worker never reads the roster then,   */
+   /* as the party screen fills it in. A recording keeps the roster   */
+   /* ahead of the keys, so it waits for the whole load as before     */
+   p_job->early = p_base->amount_of_players == 0 &&
+                  session.mode == SESSION_OFF;
+   if (p_job->early)
+      p_job->p_base = NULL;
+
+#ifndef _WIN32
+   /* The worker inherits this mask, so a resize always interrupts    */
+   /* the poll() on the UI thread                                     */
+   sigemptyset(&resize_signal);
+   sigaddset(&resize_signal, SIGWINCH);
+   pthread_sigmask(SIG_BLOCK, &resize_signal, &old_mask);
+#endif
+   p_job->running = pthread_create(&p_job->thread, NULL, 
+                                   load_worker, p_job) == 0;
+#ifndef _WIN32
+   pthread_sigmask(SIG_SETMASK, &old_mask, NULL);
+#endif
+
+   /* Without a thread, load right here like before                   */
+   if (!p_job->running)
+   {
+      load_roster(&p_job->roster, p_job->p_base, &p_job->delta, NULL);
+      p_job->finished = 1;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*          Wait for the background load and take its lists           */
+/**********************************************************************/
+void finish_load(LOAD_JOB *p_job, ROSTER *p_roster)
+{
+   EVENT event; /* Event from the event loop                          */
+
+   if (session.mode == SESSION_REPLAY)
+   {
+      session_roster(p_roster);
+      return;
+   }
+
+   if (!p_job->finished)
+   {
+      mvprintw(HEADER_ROWS, 0, "Loading the game list...");
+      refresh();
+      while (!p_job->finished)
+         next_event(&event);
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      refresh();
+   }
+
+   if (p_job->running)
+   {
+      pthread_join(p_job->thread, NULL);
+      p_job->running = 0;
+   }
+   free(p_job->p_players); /* Players the party screen didn't take    */
+   p_job->p_players = NULL;
+   p_job->early     = 0;
+
+   /* Patch just the changed rows in, or swap the last round's lists  */
+   /* for the fresh ones, handing over any search index they kept     */
+   if (p_job->delta.ready)
+   {
+      apply_roster_delta(p_roster, &p_job->delta);
+      free_attributes(&p_roster->attributes);
+      p_roster->attributes = p_job->roster.attributes;
+      memset(&p_job->roster.attributes, 0, sizeof(ATTRIBUTES));
+   }
+   else
+   {
+      if (p_job->delta.keep_game_index)
+      {
+         p_job->roster.game_index = p_roster->game_index;
+         memset(&p_roster->game_index, 0, sizeof(SEARCH_INDEX));
+      }
+      if (p_job->delta.keep_player_index)
+      {
+         p_job->roster.player_index = p_roster->player_index;
+         memset(&p_roster->player_index, 0, sizeof(SEARCH_INDEX));
+      }
+      carry_party(p_roster, &p_job->roster);
+      free_roster(p_roster);
+      *p_roster = p_job->roster;
+      memset(&p_job->roster, 0, sizeof(p_job->roster));
+   }
+   free_roster_delta(&p_job->delta);
+   session_roster(p_roster);
+
+   return;
+}
+
+/**********************************************************************/
+/*    Wait until the party can be picked, taking the players early    */
+/**********************************************************************/
+int wait_for_players(LOAD_JOB *p_job, ROSTER *p_roster)
+{
+   EVENT event; /* Event from the event loop                          */
+
+   if (p_job->early && !p_job->finished && !p_job->players_ready)
+   {
+      mvprintw(HEADER_ROWS, 0, "Loading the players...");
+      refresh();
+      while (!p_job->finished && !p_job->players_ready)
+         next_event(&event);
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      refresh();
+   }
+
+   /* The whole roster came in first, or the players never came       */
+   if (!p_job->early || p_job->finished || p_job->p_players == NULL)
+   {
+      finish_load(p_job, p_roster);
+      return 0;
+   }
+
+   /* The roster is empty, so the players just move in; the games     */
+   /* follow when finish_load() swaps in the whole roster             */
+   p_roster->player_list       = p_job->p_players;
+   p_roster->amount_of_players = p_job->player_count;
+   p_job->p_players            = NULL;
+   build_search_index(&p_roster->player_index,
+                      (const char *) p_roster->player_list +
+                         offsetof(PLAYER, player_name),
+                      sizeof(PLAYER), p_roster->amount_of_players,
+                      MAX_PLAYER_NAME);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*     Keep the party picked from one roster's players in another's   */
+/**********************************************************************/
+void carry_party(ROSTER *p_from, ROSTER *p_to)
+{
+   int member, /* Count through each player of the old roster         */
+       player; /* Count through each player of the new one            */
+
+   /* One sheet can have players whose names differ only in case, so  */
+   /* the exact spelling is looked for before any other               */
+   for (member = 0; member < p_from->amount_of_players; member++)
+      if (p_from->player_list[member].party_status == 1)
+      {
+         for (player = 0; player < p_to->amount_of_players; player++)
+            if (strcmp(p_to->player_list[player].player_name,
+                       p_from->player_list[member].player_name) == 0)
+               break;
+         if (player == p_to->amount_of_players)
+            for (player = 0; player < p_to->amount_of_players; player++)
+               if (same_name(p_to->player_list[player].player_name,
+                             p_from->player_list[member].player_name))
+                  break;
+         if (player < p_to->amount_of_players)
+            p_to->player_list[player].party_status = 1;
+      }
+
+   return;
+}
+
+/**********************************************************************/
+/*          Stop a background load that is no longer needed           */
+/**********************************************************************/
+void cancel_load(LOAD_JOB *p_job)
+{
+   if (p_job->running)
+   {
+      pthread_mutex_lock(&event_loop.queue_lock);
+      event_loop.stopping = 1;
+      pthread_mutex_unlock(&event_loop.queue_lock);
+
+      pthread_join(p_job->thread, NULL);
+      p_job->running = 0;
+   }
+
+   /* Nobody is going to take these lists now                         */
+   free_roster(&p_job->roster);
+   free_roster_delta(&p_job->delta);
+   free(p_job->p_players);
+   p_job->p_players = NULL;
+
+   return;
+}
+
+/**********************************************************************/
+/*                 Start a list view at the top of a list             */
+/**********************************************************************/
+void list_view_init(LIST_VIEW *p_view, int item_count)
+{
+   p_view->top_row    = 0;
+   p_view->height     = 1;
+   p_view->item_count = item_count;
+   p_view->first_item = 0;
+   p_view->cursor     = 0;
+
+   return;
+}
+
+/**********************************************************************/
+/*          Put a list view on the screen, e.g. after a resize        */
+/**********************************************************************/
+void list_view_place(LIST_VIEW *p_view, int top_row, int height)
+{
+   p_view->top_row = top_row;
+   p_view->height  = height < 1 ? 1 : height;
+
+   /* Keep the highlighted item on screen at the new height           */
+   list_view_move(p_view, p_view->cursor);
+
+   return;
+}
+
+/**********************************************************************/
+/*        Move the highlight, scrolling only as far as needed         */
+/**********************************************************************/
+void list_view_move(LIST_VIEW *p_view, int cursor)
+{
+   if (cursor > p_view->item_count - 1)
+      cursor = p_view->item_count - 1;
+   if (cursor < 0)
+      cursor = 0;
+   p_view->cursor = cursor;
+
+   if (cursor < p_view->first_item)
+      p_view->first_item = cursor;
+   else if (cursor >= p_view->first_item + p_view->height)
+      p_view->first_item = cursor - p_view->height + 1;
+
+   /* Don't leave blank rows at the bottom if the list can fill them  */
+   if (p_view->first_item > p_view->item_count - p_view->height)
+      p_view->first_item = p_view->item_count - p_view->height;
+   if (p_view->first_item < 0)
+      p_view->first_item = 0;
+
+   return;
+}
+
+/**********************************************************************/
+/*       Handle a navigation key, returns 1 if the key was used       */
+/**********************************************************************/
+int list_view_key(LIST_VIEW *p_view, int key)
+{
+   switch (key)
+   {
+      case KEY_UP:
+         list_view_move(p_view, p_view->cursor - 1);
+         break;
+      case KEY_DOWN:
+         list_view_move(p_view, p_view->cursor + 1);
+         break;
+      case KEY_PPAGE:
+         list_view_move(p_view, p_view->cursor - p_view->height);
+         break;
+      case KEY_NPAGE:
+         list_view_move(p_view, p_view->cursor + p_view->height);
+         break;
+      case KEY_HOME:
+         list_view_move(p_view, 0);
+         break;
+      case KEY_END:
+         list_view_move(p_view, p_view->item_count - 1);
+         break;
+      case KEY_RESIZE:
+         break;  /* Caller places the view again when it redraws      */
+      default:
+         return 0;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*               Draw only the items that fit in the view             */
+/**********************************************************************/
+void list_view_draw(LIST_VIEW *p_view,
+                    void (*draw_item)(void *p_items, int item),
+                    void *p_items)
+{
+   int row,  /* Count through each row of the view                    */
+       item; /* Item drawn on the row                                 */
+
+   for (row = 0; row < p_view->height; row++)
+   {
+      move(p_view->top_row + row, 0);
+      clrtoeol();
+
+      item = p_view->first_item + row;
+      if (item < p_view->item_count)
+      {
+         move(p_view->top_row + row, 2);
+         if (item == p_view->cursor)
+            attron(A_REVERSE);
+         draw_item(p_items, item);
+         if (item == p_view->cursor)
+            attroff(A_REVERSE);
+      }
+   }
+
+   /* Show there is more of the list above or below                   */
+   attron(COLOR_PAIR(CP_SCROLL));
+   if (p_view->first_item > 0)
+      mvprintw(p_view->top_row, COLS - 3, "^");
+   if (p_view->first_item + p_view->height < p_view->item_count)
+      mvprintw(p_view->top_row + p_view->height - 1, COLS - 3, "v");
+   attroff(COLOR_PAIR(CP_SCROLL));
+
+   return;
+}
+
+/**********************************************************************/
+/*                  Draw one row of the player list                   */
+/**********************************************************************/
+void draw_player_item(void *p_items, int item)
+{
+   SEARCH_VIEW *p_search    = (SEARCH_VIEW *) p_items; /* Matches      */
+   PLAYER      *player_list = (PLAYER *) p_search->p_items;
+   int         player       = search_view_item(p_search, item);
+
+   printw("[%c] %d. %s", player_list[player].party_status == 1 ? 'x' : ' ',
+          player + 1, player_list[player].player_name);
+
+   return;
+}
+
+/**********************************************************************/
+/*                   Draw one row of the wheel list                   */
+/**********************************************************************/
+void draw_wheel_item(void *p_items, int item)
+{
+   WHEEL **p_games = (WHEEL **) p_items; /* Games on the wheel         */
+
+   printw("%d. %s", item + 1, p_games[item]->game_name);
+
+   return;
+}
+
+/**********************************************************************/
+/*         Scroll through the games on the wheel before spinning      */
+/**********************************************************************/
+int view_wheel_list(WHEEL **p_wheel_list)
+{
+   WHEEL     **p_games,   /* Games in wheel order, for direct access  */
+             *p_game;     /* Game being added to the array            */
+   LIST_VIEW game_view;   /* Visible part of the wheel list           */
+   int       game_count,  /* Amount of games on the wheel             */
+             game_counter,/* Count through each game on the wheel     */
+             finalist_count = 0, /* Games drawn for a shortlist       */
+             choice = WHEEL_SPIN, /* What to do with the wheel next   */
+             key;         /* Key pressed by user                      */
+
+   /* Walk the ring once so scrolling never has to walk it again      */
+   game_count = get_game_count(*p_wheel_list) + 1;
+   p_games    = (WHEEL **) arena_alloc(&session_arena,
+                                       sizeof(WHEEL *) * game_count);
+   if (p_games == NULL)
+      return choice;
+   p_game = (*p_wheel_list)->p_next_game;
+   for (game_counter = 0; game_counter < game_count; game_counter++)
+   {
+      p_games[game_counter] = p_game;
+      p_game = p_game->p_next_game;
+   }
+
+   list_view_init(&game_view, game_count);
+   clear_screen();
+
+   do
+   {
+      list_view_place(&game_view, HEADER_ROWS + 2, 
+                      LINES - HEADER_ROWS - 3);
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Use the arrow keys to scroll and enter to spin");
+      if (game_count > 2)
+         printw(", F for finalists or T for a tournament");
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Games on the wheel (%d):", game_count);
+      list_view_draw(&game_view, draw_wheel_item, p_games);
+      refresh();
+
+      key = wait_key();
+      if ((key == 'f' || key == 'F') && game_count > 2)
+      {
+         move(HEADER_ROWS - 2, 0);
+         clrtoeol();
+         printw("How many finalists (2 to %d)? ", game_count - 1);
+         refresh();
+         finalist_count = read_number();
+         if (finalist_count >= 2 && finalist_count < game_count)
+            break;
+         finalist_count = 0;
+      }
+      if ((key == 't' || key == 'T') && game_count > 2)
+      {
+         *p_wheel_list = run_tournament(p_games, game_count);
+         choice        = WHEEL_DECIDED;
+         break;
+      }
+      list_view_key(&game_view, key);
+   }
+   while (key != '\n' && key != KEY_ENTER);
+
+   /* One draw replaces a spin and a reroll for every game cut        */
+   if (finalist_count > 0)
+   {
+      draw_finalists(p_games, game_count, finalist_count);
+      clear_screen();
+      print_finalists(p_games, finalist_count);
+      if (get_response(4) == 'y')
+         *p_wheel_list = keep_finalists(p_games, finalist_count);
+      else
+      {
+         mvprintw(LINES - 2, 0, "Press any key to continue...");
+         refresh();
+         wait_key();
+         choice = WHEEL_SHORTLIST;
+      }
+   }
+
+   clear_screen();
+
+   return choice;
+}
+
+/**********************************************************************/
+/*          Move a few games, drawn without repeats, to the front     */
+/**********************************************************************/
+void draw_finalists(WHEEL *p_games[], int game_count, int finalist_count)
+{
+   WHEEL *p_swap_game;     /* Game being swapped                      */
+   int   finalist_counter, /* Count through each finalist             */
+         pick;             /* Game drawn for the finalist             */
+
+   srand(session_seed());
+
+   /* Each draw swaps a game from the ones left into the next slot at */
+   /* the front, so K finalists take K draws and never repeat. Two    */
+   /* rand() calls reach past RAND_MAX on long lists                  */
+   for (finalist_counter = 0;
+        finalist_counter < finalist_count;
+        finalist_counter++)
+   {
+      pick = finalist_counter +
+             (int) (((long long) rand() * ((long long) RAND_MAX + 1) +
+                     rand()) % (game_count - finalist_counter));
+      p_swap_game                = p_games[finalist_counter];
+      p_games[finalist_counter] = p_games[pick];
+      p_games[pick]             = p_swap_game;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*                   Print the shortlist of finalists                 */
+/**********************************************************************/
+void print_finalists(WHEEL *p_games[], int finalist_count)
+{
+   int finalist_counter;        /* Count through each finalist        */
+   int row = HEADER_ROWS + 4;   /* Below the spin prompt              */
+
+   mvprintw(row++, 0, "Finalists (%d):", finalist_count);
+
+   /* Stop above the status line instead of running off the window    */
+   for (finalist_counter = 0;
+        finalist_counter < finalist_count && row < LINES - 2;
+        finalist_counter++)
+      mvprintw(row++, 2, "%d. %s", finalist_counter + 1,
+               p_games[finalist_counter]->game_name);
+   if (finalist_counter < finalist_count)
+      mvprintw(row - 1, 2, "... and %d more",
+               finalist_count - finalist_counter + 1);
+
+   refresh();
+   return;
+}
+
+/**********************************************************************/
+/*       Make the wheel just the finalists, dropping the other games  */
+/**********************************************************************/
+WHEEL *keep_finalists(WHEEL *p_games[], int finalist_count)
+{
+   int game_counter; /* Count through each game on the wheel          */
+
+   /* The finalists link into a ring of their own, and the games left */
+   /* out go back with the session arena                              */
+   for (game_counter = 0; game_counter < finalist_count; game_counter++)
+      p_games[game_counter]->p_next_game =
+         p_games[(game_counter + 1) % finalist_count];
+
+   return p_games[finalist_count - 1]; /* Return the new tail         */
+}
+
+/**********************************************************************/
+/*    Knock games out until one is left, spinning only the last rounds*/
+/**********************************************************************/
+WHEEL *run_tournament(WHEEL *p_games[], int game_count)
+{
+   WHEEL     *p_wheel,          /* Games still in for the last rounds */
+             *p_loser,          /* Game knocked out this round        */
+             *p_before;         /* Game the loser follows             */
+   LIST_VIEW out_view;          /* Visible part of the early losers   */
+   int       highlight_count,   /* Rounds that are spun               */
+             round,             /* Round being played, last one is 1  */
+             steps,             /* Games between the wheel and loser  */
+             key;               /* Key pressed by user                */
+
+   /* One shuffle decides every round: the last game is out first and */
+   /* the first game is the winner, so no round walks the ring        */
+   draw_finalists(p_games, game_count, game_count - 1);
+   highlight_count = TOURNAMENT_HIGHLIGHTS < game_count - 1 ?
+                     TOURNAMENT_HIGHLIGHTS : game_count - 1;
+
+   /* Show who went out before the last rounds, never who is left     */
+   list_view_init(&out_view, game_count - highlight_count - 1);
+   clear_screen();
+   do
+   {
+      list_view_place(&out_view, HEADER_ROWS + 2,
+                      LINES - HEADER_ROWS - 3);
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Use the arrow keys to scroll and enter to spin the last %d "
+             "rounds", highlight_count);
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Knocked out, last out first (%d):", out_view.item_count);
+      list_view_draw(&out_view, draw_wheel_item,
+                     p_games + highlight_count + 1);
+      refresh();
+
+      key = wait_key();
+      list_view_key(&out_view, key);
+   }
+   while (key != '\n' && key != KEY_ENTER);
+
+   /* Each last round spins a full turn and stops on its loser        */
+   p_wheel = keep_finalists(p_games, highlight_count + 1);
+   for (round = highlight_count; round >= 1; round--)
+   {
+      p_loser = p_games[round];
+      for (steps = 0, p_before = p_wheel;
+           p_before->p_next_game != p_loser;
+           steps++)
+         p_before = p_before->p_next_game;
+      spin_wheel(&p_wheel, round + 1 + steps);
+      selected_game(p_wheel->game_name, p_loser->game_name,
+                    p_loser->p_next_game->game_name, round + 1);
+      mvprintw(HEADER_ROWS, 0, "Out: %s", p_loser->game_name);
+      refresh();
+      wait_ms(TOURNAMENT_PAUSE);
+
+      p_wheel->p_next_game = p_loser->p_next_game;
+   }
+
+   return p_wheel;
+}
+
+/**********************************************************************/
+/*                 Lower-case a name into a search key                */
+/**********************************************************************/
+void make_search_key(char *p_key, const char *p_name, int key_size)
+{
+   int letter_counter; /* Count through each letter of the name        */
+
+   /* Anything that is not a letter or digit searches as a '_'        */
+   for (letter_counter = 0;
+        letter_counter < key_size - 1 && p_name[letter_counter] != '\0';
+        letter_counter++)
+      if (isalnum((unsigned char) p_name[letter_counter]))
+         p_key[letter_counter] = 
+            (char) tolower((unsigned char) p_name[letter_counter]);
+      else
+         p_key[letter_counter] = '_';
+   p_key[letter_counter] = '\0';
+
+   return;
+}
+
+/**********************************************************************/
+/*               Number a three letter gram of a search key           */
+/**********************************************************************/
+int trigram_code(const char *p_key)
+{
+   int code = 0,       /* Gram as a base SEARCH_SYMBOLS number         */
+       letter_counter; /* Count through the gram's three letters       */
+
+   for (letter_counter = 0; letter_counter < 3; letter_counter++)
+   {
+      code *= SEARCH_SYMBOLS;
+      if (p_key[letter_counter] >= 'a' && p_key[letter_counter] <= 'z')
+         code += p_key[letter_counter] - 'a';
+      else if (p_key[letter_counter] >= '0' && p_key[letter_counter] <= '9')
+         code += p_key[letter_counter] - '0' + 26;
+      else
+         code += SEARCH_SYMBOLS - 1;
+   }
+
+   return code;
+}
+
+/**********************************************************************/
+/*               Order search keys alphabetically for qsort           */
+/**********************************************************************/
+int compare_search_keys(const void *p_first, const void *p_second)
+{
+   const char *p_first_key  = *(const char * const *) p_first,
+              *p_second_key = *(const char * const *) p_second;
+   int        order         = strcmp(p_first_key, p_second_key);
+
+   /* Same names keep their sheet order                               */
+   if (order == 0)
+      order = (p_first_key > p_second_key) - (p_first_key < p_second_key);
+
+   return order;
+}
+
+/**********************************************************************/
+/*        Build the prefix trie and trigram lists over a list's names */
+/**********************************************************************/
+int build_search_index(SEARCH_INDEX *p_index,
+                       const char   *p_first_name,
+                       size_t       item_size,
+                       int          item_count,
+                       int          key_size)
+{
+   TRIE_NODE *p_nodes;       /* Trie after growing it                  */
+   char      **p_sorted_keys;/* Keys in alphabetical order             */
+   int       *p_last_item,   /* Last item counted for each trigram     */
+             *p_gram_fill,   /* Next free spot in each trigram's list  */
+             item_counter,   /* Count through each item                */
+             letter_counter, /* Count through each letter of a key     */
+             node_counter,   /* Count through the trie nodes of a depth*/
+             level_start,    /* First trie node at the current depth   */
+             level_end,      /* One past the last node at the depth    */
+             sort_counter,   /* Count through a node's sorted keys     */
+             child,          /* Trie node being added                  */
+             depth,          /* Letters from the root of the trie      */
+             code;           /* Trigram being counted                  */
+   char      *p_key;         /* Search key being worked on             */
+   long long start = trace_begin(); /* When building started           */
+
+   memset(p_index, 0, sizeof(*p_index));
+   p_index->item_count = item_count;
+   p_index->key_size   = key_size;
+
+   p_index->keys         = (char *) malloc((size_t) item_count * key_size + 1);
+   p_index->sorted_items = (int *) malloc(sizeof(int) * (item_count + 1));
+   p_index->item_rank    = (int *) malloc(sizeof(int) * (item_count + 1));
+   p_index->scores       = (int *) calloc(item_count + 1, sizeof(int));
+   p_index->touched      = (int *) malloc(sizeof(int) * (item_count + 1));
+   p_index->gram_start   = (int *) calloc(TRIGRAM_COUNT + 1, sizeof(int));
+   p_sorted_keys = (char **) malloc(sizeof(char *) * (item_count + 1));
+   p_last_item   = (int *) malloc(sizeof(int) * TRIGRAM_COUNT);
+   p_gram_fill   = (int *) malloc(sizeof(int) * TRIGRAM_COUNT);
+   if (p_index->keys == NULL || p_index->sorted_items == NULL ||
+       p_index->item_rank == NULL || p_index->scores == NULL ||
+       p_index->touched == NULL || p_index->gram_start == NULL ||
+       p_sorted_keys == NULL || p_last_item == NULL || p_gram_fill == NULL)
+   {
+      free(p_sorted_keys);
+      free(p_last_item);
+      free(p_gram_fill);
+      free_search_index(p_index);
+      post_status("Not enough memory to search, type numbers instead");
+      return 0;
+   }
+
+   /* Sort the keys once so every prefix is one run of sorted keys    */
+   for (item_counter = 0; item_counter < item_count; item_counter++)
+   {
+      p_key = p_index->keys + (size_t) item_counter * key_size;
+      make_search_key(p_key, p_first_name + item_counter * item_size,
+                      key_size);
+      p_sorted_keys[item_counter] = p_key;
+   }
+   qsort(p_sorted_keys, item_count, sizeof(char *), compare_search_keys);
+   for (sort_counter = 0; sort_counter < item_count; sort_counter++)
+   {
+      item_counter = (int) ((p_sorted_keys[sort_counter] - p_index->keys) /
+                            key_size);
+      p_index->sorted_items[sort_counter] = item_counter;
+      p_index->item_rank[item_counter]    = sort_counter;
+   }
+
+   /* Build the trie a depth at a time, each node splitting its run   */
+   /* of keys into one child per next letter                          */
+   p_index->node_capacity = 64;
+   p_index->nodes = (TRIE_NODE *) malloc(sizeof(TRIE_NODE) *
+                                         p_index->node_capacity);
+   if (p_index->nodes == NULL)
+      item_count = 0;
+   else
+   {
+      p_index->nodes[0].letter       = '\0';
+      p_index->nodes[0].first_child  = -1;
+      p_index->nodes[0].last_child   = -1;
+      p_index->nodes[0].next_sibling = -1;
+      p_index->nodes[0].range_start  = 0;
+      p_index->nodes[0].range_count  = item_count;
+      p_index->node_count            = 1;
+   }
+   level_start = 0;
+   level_end   = p_index->node_count;
+   for (depth = 0; depth < TRIE_DEPTH && level_start < level_end; depth++)
+   {
+      for (node_counter = level_start;
+           node_counter < level_end && p_index->nodes != NULL;
+           node_counter++)
+         for (sort_counter = p_index->nodes[node_counter].range_start;
+              sort_counter < p_index->nodes[node_counter].range_start +
+                             p_index->nodes[node_counter].range_count;
+              sort_counter++)
+         {
+            p_key = p_sorted_keys[sort_counter];
+            if (p_key[depth] == '\0')
+               continue;
+
+            /* Same letter as the key before means the same child     */
+            child = p_index->nodes[node_counter].last_child;
+            if (child >= 0 && p_index->nodes[child].letter == p_key[depth])
+            {
+               p_index->nodes[child].range_count++;
+               continue;
+            }
+
+            if (p_index->node_count == p_index->node_capacity)
+            {
+               p_nodes = (TRIE_NODE *) realloc(p_index->nodes,
+                            sizeof(TRIE_NODE) * p_index->node_capacity * 2);
+               if (p_nodes == NULL)
+               {
+                  /* A partial trie would miss names, so the search   */
+                  /* is left off rather than built on one             */
+                  free(p_index->nodes);
+                  p_index->nodes      = NULL;
+                  p_index->node_count = 0;
+                  break;
+               }
+               p_index->nodes          = p_nodes;
+               p_index->node_capacity *= 2;
+            }
+            child = p_index->node_count++;
+            p_index->nodes[child].letter       = p_key[depth];
+            p_index->nodes[child].first_child  = -1;
+            p_index->nodes[child].last_child   = -1;
+            p_index->nodes[child].next_sibling = -1;
+            p_index->nodes[child].range_start  = sort_counter;
+            p_index->nodes[child].range_count  = 1;
+            if (p_index->nodes[node_counter].last_child < 0)
+               p_index->nodes[node_counter].first_child = child;
+            else
+               p_index->nodes[p_index->nodes[node_counter].last_child].
+                  next_sibling = child;
+            p_index->nodes[node_counter].last_child = child;
+         }
+      level_start = level_end;
+      level_end   = p_index->node_count;
+   }
+
+   /* Count each name's trigrams once, then lay the lists end to end  */
+   for (code = 0; code < TRIGRAM_COUNT; code++)
+      p_last_item[code] = -1;
+   for (item_counter = 0; item_counter < p_index->item_count; item_counter++)
+   {
+      p_key = p_index->keys + (size_t) item_counter * key_size;
+      for (letter_counter = 0;
+           p_key[letter_counter] != '\0' &&
+           p_key[letter_counter + 1] != '\0' &&
+           p_key[letter_counter + 2] != '\0';
+           letter_counter++)
+      {
+         code = trigram_code(p_key + letter_counter);
+         if (p_last_item[code] != item_counter)
+         {
+            p_last_item[code] = item_counter;
+            p_index->gram_start[code + 1]++;
+         }
+      }
+   }
+   for (code = 0; code < TRIGRAM_COUNT; code++)
+   {
+      p_index->gram_start[code + 1] += p_index->gram_start[code];
+      p_gram_fill[code] = p_index->gram_start[code];
+      p_last_item[code] = -1;
+   }
+   p_index->gram_items = (int *) malloc(sizeof(int) *
+                            (p_index->gram_start[TRIGRAM_COUNT] + 1));
+   if (p_index->gram_items != NULL)
+      for (item_counter = 0; item_counter < p_index->item_count;
+           item_counter++)
+      {
+         p_key = p_index->keys + (size_t) item_counter * key_size;
+         for (letter_counter = 0;
+              p_key[letter_counter] != '\0' &&
+              p_key[letter_counter + 1] != '\0' &&
+              p_key[letter_counter + 2] != '\0';
+              letter_counter++)
+         {
+            code = trigram_code(p_key + letter_counter);
+            if (p_last_item[code] != item_counter)
+            {
+               p_last_item[code] = item_counter;
+               p_index->gram_items[p_gram_fill[code]++] = item_counter;
+            }
+         }
+      }
+
+   free(p_sorted_keys);
+   free(p_last_item);
+   free(p_gram_fill);
+
+   if (p_index->nodes == NULL || p_index->gram_items == NULL)
+   {
+      free_search_index(p_index);
+      post_status("Not enough memory to search, type numbers instead");
+      return 0;
+   }
+   p_index->ready = 1;
+   trace_end("build_search_index", "index", start);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                          Free a search index                       */
+/**********************************************************************/
+void free_search_index(SEARCH_INDEX *p_index)
+{
+   free(p_index->keys);
+   free(p_index->sorted_items);
+   free(p_index->item_rank);
+   free(p_index->gram_start);
+   free(p_index->gram_items);
+   free(p_index->scores);
+   free(p_index->touched);
+   free(p_index->nodes);
+   memset(p_index, 0, sizeof(*p_index));
+
+   return;
+}
+
+/**********************************************************************/
+/*        Find names starting with, then names close to, the query    */
+/**********************************************************************/
+void search_index_find(SEARCH_INDEX  *p_index,
+                       const char    *p_query,
+                       SEARCH_RESULT *p_result)
+{
+   char key[MAX_QUERY_LEN + 1];       /* Query as a search key        */
+   int  grams[MAX_QUERY_LEN],         /* Query trigrams, rarest first */
+        gram_count = 0,               /* Different trigrams in query  */
+        required,                     /* Trigrams a near match shares */
+        touched_count = 0,            /* Items with a non-zero score  */
+        key_length,                   /* Letters in the query         */
+        node = 0,                     /* Trie node for the query      */
+        depth,                        /* Letters matched in the trie  */
+        low, high, middle,            /* Binary search bounds         */
+        gram_counter,                 /* Count through query trigrams */
+        posting,                      /* Count through a trigram list */
+        item,                         /* Item being scored            */
+        code,                         /* Trigram being looked up      */
+        result_counter;               /* Count through the near ones  */
+
+   make_search_key(key, p_query, (int) sizeof(key));
+   key_length = (int) strlen(key);
+
+   /* Walk the trie for the first letters, every name under the node  */
+   /* starts with them and sits in one run of the sorted keys         */
+   for (depth = 0; depth < key_length && depth < TRIE_DEPTH && node >= 0;
+        depth++)
+   {
+      node = p_index->nodes[node].first_child;
+      while (node >= 0 && p_index->nodes[node].letter != key[depth])
+         node = p_index->nodes[node].next_sibling;
+   }
+   if (node < 0)
+   {
+      p_result->prefix_start = 0;
+      p_result->prefix_count = 0;
+   }
+   else
+   {
+      p_result->prefix_start = p_index->nodes[node].range_start;
+      p_result->prefix_count = p_index->nodes[node].range_count;
+   }
+
+   /* Longer queries narrow the run with a binary search on each end  */
+   if (node >= 0 && key_length > TRIE_DEPTH)
+   {
+      low  = p_result->prefix_start;
+      high = p_result->prefix_start + p_result->prefix_count;
+      while (low < high)
+      {
+         middle = low + (high - low) / 2;
+         if (strncmp(p_index->keys + (size_t) p_index->sorted_items[middle] *
+                        p_index->key_size, key, key_length) < 0)
+            low = middle + 1;
+         else
+            high = middle;
+      }
+      p_result->prefix_start = low;
+      high = p_index->nodes[node].range_start +
+             p_index->nodes[node].range_count;
+      while (low < high)
+      {
+         middle = low + (high - low) / 2;
+         if (strncmp(p_index->keys + (size_t) p_index->sorted_items[middle] *
+                        p_index->key_size, key, key_length) <= 0)
+            low = middle + 1;
+         else
+            high = middle;
+      }
+      p_result->prefix_count = low - p_result->prefix_start;
+   }
+
+   /* Near matches share at least half of the query's trigrams        */
+   p_result->fuzzy_count = 0;
+   for (depth = 0; depth + 2 < key_length; depth++)
+   {
+      code = trigram_code(key + depth);
+      for (gram_counter = 0; gram_counter < gram_count; gram_counter++)
+         if (grams[gram_counter] == code)
+            break;
+      if (gram_counter < gram_count)
+         continue;
+
+      /* Keep the list rarest first so the fewest items are scored    */
+      for (gram_counter = gram_count;
+           gram_counter > 0 &&
+           p_index->gram_start[grams[gram_counter - 1] + 1] -
+           p_index->gram_start[grams[gram_counter - 1]] >
+           p_index->gram_start[code + 1] - p_index->gram_start[code];
+           gram_counter--)
+         grams[gram_counter] = grams[gram_counter - 1];
+      grams[gram_counter] = code;
+      gram_count++;
+   }
+   if (gram_count == 0)
+      return;
+   required = (gram_count + 1) / 2;
+
+   /* A name sharing enough trigrams must be in one of the rarest     */
+   /* lists, so only those are walked and the rest are searched       */
+   for (gram_counter = 0; gram_counter <= gram_count - required;
+        gram_counter++)
+      for (posting = p_index->gram_start[grams[gram_counter]];
+           posting < p_index->gram_start[grams[gram_counter] + 1];
+           posting++)
+      {
+         item = p_index->gram_items[posting];
+         if (p_index->scores[item]++ == 0)
+            p_index->touched[touched_count++] = item;
+      }
+
+   for (posting = 0; posting < touched_count; posting++)
+   {
+      item = p_index->touched[posting];
+      for (gram_counter = gram_count - required + 1;
+           gram_counter < gram_count; gram_counter++)
+      {
+         low  = p_index->gram_start[grams[gram_counter]];
+         high = p_index->gram_start[grams[gram_counter] + 1];
+         while (low < high)
+         {
+            middle = low + (high - low) / 2;
+            if (p_index->gram_items[middle] < item)
+               low = middle + 1;
+            else
+               high = middle;
+         }
+         if (low < p_index->gram_start[grams[gram_counter] + 1] &&
+             p_index->gram_items[low] == item)
+            p_index->scores[item]++;
+      }
+
+      /* Names already shown as prefix matches are not repeated       */
+      if (p_index->scores[item] >= required &&
+          (p_index->item_rank[item] < p_result->prefix_start ||
+           p_index->item_rank[item] >= p_result->prefix_start +
+                                      p_result->prefix_count))
+      {
+         /* Keep the best few, most shared trigrams first             */
+         result_counter = p_result->fuzzy_count;
+         if (result_counter == MAX_FUZZY_RESULTS)
+         {
+            if (p_result->fuzzy_scores[result_counter - 1] >= 
+                p_index->scores[item])
+            {
+               p_index->scores[item] = 0;
+               continue;
+            }
+            result_counter--;
+         }
+         else
+            p_result->fuzzy_count++;
+         while (result_counter > 0 &&
+                p_result->fuzzy_scores[result_counter - 1] <
+                p_index->scores[item])
+         {
+            p_result->fuzzy_items[result_counter] =
+               p_result->fuzzy_items[result_counter - 1];
+            p_result->fuzzy_scores[result_counter] =
+               p_result->fuzzy_scores[result_counter - 1];
+            result_counter--;
+         }
+         p_result->fuzzy_items[result_counter]  = item;
+         p_result->fuzzy_scores[result_counter] = p_index->scores[item];
+      }
+      p_index->scores[item] = 0;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*                  Start a search box with nothing typed             */
+/**********************************************************************/
+void search_view_init(SEARCH_VIEW  *p_search,
+                      SEARCH_INDEX *p_index,
+                      void         *p_items,
+                      int          item_count)
+{
+   p_search->p_index      = p_index;
+   p_search->p_items      = p_items;
+   p_search->item_count   = item_count;
+   p_search->query[0]     = '\0';
+   p_search->query_length = 0;
+   memset(&p_search->result, 0, sizeof(p_search->result));
+
+   return;
+}
+
+/**********************************************************************/
+/*              Edit the query, returns 1 if the key was used         */
+/**********************************************************************/
+int search_view_key(SEARCH_VIEW *p_search, int key)
+{
+   /* Without an index the keys are left for typing numbers           */
+   if (!p_search->p_index->ready)
+      return 0;
+
+   if (key == KEY_BACKSPACE || key == 127 || key == '\b')
+   {
+      if (p_search->query_length == 0)
+         return 0;
+      p_search->query[--p_search->query_length] = '\0';
+   }
+   else if (key == 27)
+   {
+      if (p_search->query_length == 0)
+         return 0;
+      p_search->query_length = 0;
+      p_search->query[0]     = '\0';
+   }
+   /* A letter starts a search, then anything printable goes in it    */
+   else if (key > 0 && key < 256 &&
+            (isalpha(key) || (p_search->query_length > 0 && isprint(key))))
+   {
+      if (p_search->query_length < MAX_QUERY_LEN)
+      {
+         p_search->query[p_search->query_length++] = (char) key;
+         p_search->query[p_search->query_length]   = '\0';
+      }
+   }
+   else
+      return 0;
+
+   if (p_search->query_length > 0)
+      search_index_find(p_search->p_index, p_search->query,
+                        &p_search->result);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*               Amount of items the search box lets through          */
+/**********************************************************************/
+int search_view_count(SEARCH_VIEW *p_search)
+{
+   if (p_search->query_length == 0)
+      return p_search->item_count;
+
+   return p_search->result.prefix_count + p_search->result.fuzzy_count;
+}
+
+/**********************************************************************/
+/*              Item shown at a position of the search results        */
+/**********************************************************************/
+int search_view_item(SEARCH_VIEW *p_search, int position)
+{
+   /* Prefix matches come first in name order, then the near ones     */
+   if (p_search->query_length == 0)
+      return position;
+   if (position < p_search->result.prefix_count)
+      return p_search->p_index->sorted_items[p_search->result.prefix_start +
+                                             position];
+
+   return p_search->result.fuzzy_items[position -
+                                       p_search->result.prefix_count];
+}
+
+/**********************************************************************/
+/*                  Draw one row of the game lookup list              */
+/**********************************************************************/
+void draw_game_item(void *p_items, int item)
+{
+   SEARCH_VIEW *p_search  = (SEARCH_VIEW *) p_items; /* Matches        */
+   GAME        *game_list = (GAME *) p_search->p_items;
+   int         game       = search_view_item(p_search, item);
+
+   if (game_list[game].player_limit > 0)
+      printw("%s (up to %d players)", game_list[game].game_name,
+             game_list[game].player_limit);
+   else
+      printw("%s (any amount of players)", game_list[game].game_name);
+
+   return;
+}
+
+/**********************************************************************/
+/*        Print the players with one status for a game on one line    */
+/**********************************************************************/
+void print_game_owners(ROSTER *p_roster,
+                       int    game,
+                       int    row,
+                       char   status,
+                       int    party_only,
+                       const char *label)
+{
+   PLAYER *player_list = p_roster->player_list; /* Players to print   */
+   int player_counter, /* Count through each player in it's list      */
+       owner_count = 0;/* Players printed so far                      */
+
+   move(row, 0);
+   clrtoeol();
+   printw("%s", label);
+
+   /* Stop at the edge of the window instead of wrapping              */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (roster_status(p_roster, game, player_counter) == status &&
+          (!party_only || player_list[player_counter].party_status == 1))
+      {
+         if (getcurx(stdscr) + 
+             (int) strlen(player_list[player_counter].player_name) + 5 >= 
+             COLS)
+         {
+            printw(" ...");
+            break;
+         }
+         printw(" %s", player_list[player_counter].player_name);
+         owner_count++;
+      }
+   if (owner_count == 0)
+      printw(" nobody");
+
+   return;
+}
+
+/**********************************************************************/
+/*                Look up a game by name to see who has it            */
+/**********************************************************************/
+void game_lookup(ROSTER *p_roster)
+{
+   LIST_VIEW   game_view;   /* Visible part of the matching games      */
+   SEARCH_VIEW game_search; /* Name typed to find a game               */
+   unsigned long long party;/* Party asking, 0 for nobody picked yet   */
+   long long   last_played; /* When the party last kept the game       */
+   char        date[FORMAT_LEN]; /* That day, written out              */
+   time_t      played_time; /* That time, for the date functions       */
+   int         party_size,  /* Players in the party                    */
+               key,         /* Key pressed by user                     */
+               game;        /* Game under the highlight                */
+
+   search_view_init(&game_search, &p_roster->game_index,
+                    p_roster->game_list, p_roster->amount_of_games);
+   list_view_init(&game_view, search_view_count(&game_search));
+   party = history_party(p_roster, &party_size);
+   clear_screen();
+
+   while (1)
+   {
+      list_view_place(&game_view, HEADER_ROWS + 3,
+                      LINES - HEADER_ROWS - 7);
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Type a game's name to find it, / to query who has what, "
+             "tab to go back");
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Find a game: %s", game_search.query);
+      move(HEADER_ROWS + 2, 0);
+      clrtoeol();
+      printw("Games (%d):", game_view.item_count);
+      list_view_draw(&game_view, draw_game_item, &game_search);
+      if (game_view.item_count == 0)
+         mvprintw(HEADER_ROWS + 3, 2, "No games match");
+
+      /* Who has the highlighted game, and who would have to get it   */
+      if (game_view.item_count > 0)
+      {
+         game = search_view_item(&game_search, game_view.cursor);
+         print_game_owners(p_roster, game, LINES - 3, 'y', 0,
+                           "Have it:");
+         print_game_owners(p_roster, game, LINES - 2, 'd', 0,
+                           "Need download:");
+
+         /* When this party, or anyone before a party is picked, last */
+         /* kept the game                                             */
+         last_played = history_last_played(party,
+                          p_roster->game_list[game].game_name);
+         move(HEADER_ROWS + 1, 0);
+         clrtoeol();
+         played_time = (time_t) last_played;
+         if (last_played == 0)
+            printw("%s never played it", party_size > 0 ? "This party has"
+                                                        : "Nobody has");
+         else if (strftime(date, sizeof(date), "%Y-%m-%d",
+                           localtime(&played_time)) > 0)
+            printw("%s last played it on %s",
+                   party_size > 0 ? "This party" : "Somebody", date);
+      }
+      else
+      {
+         move(HEADER_ROWS + 1, 0);
+         clrtoeol();
+         move(LINES - 3, 0);
+         clrtoeol();
+         move(LINES - 2, 0);
+         clrtoeol();
+      }
+      move(HEADER_ROWS, 13 + game_search.query_length);
+      refresh();
+
+      key = wait_key();
+
+      if (list_view_key(&game_view, key))
+         continue;
+
+      if (search_view_key(&game_search, key))
+         list_view_init(&game_view, search_view_count(&game_search));
+      else if (key == '/')
+      {
+         query_games(p_roster);
+         clear_screen();
+      }
+      else if (key == '\t' || key == 27 || key == '\n' || key == KEY_ENTER)
+         break;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*       Rank games by how many of the party can play them            */
+/**********************************************************************/
+void rank_games(ROSTER *p_roster)
+{
+   RANKING   ranking;   /* Games in order, with their counts          */
+   LIST_VIEW game_view; /* Visible part of the ranked games           */
+   int       key,       /* Key pressed by user                        */
+             game;      /* Game under the highlight                   */
+
+   if (!build_ranking(p_roster, &ranking))
+   {
+      show_message(HEADER_ROWS + 2, "!!NOT ENOUGH MEMORY TO RANK GAMES!!",
+                   1000);
+      return;
+   }
+   list_view_init(&game_view, ranking.game_count);
+   clear_screen();
+
+   while (1)
+   {
+      list_view_place(&game_view, HEADER_ROWS + 3,
+                      LINES - HEADER_ROWS - 7);
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Use the arrow keys to scroll, tab to go back to players");
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Games the most of the %s can play (%d of %d games):",
+             (ranking.party_count < p_roster->amount_of_players) ?
+                "party" : "players",
+             ranking.game_count, p_roster->amount_of_games);
+      mvprintw(HEADER_ROWS + 2, 2, "Now  After downloads  Game");
+      list_view_draw(&game_view, draw_ranked_item, &ranking);
+      if (game_view.item_count == 0)
+         mvprintw(HEADER_ROWS + 3, 2, "Nobody has any games");
+
+      /* Who in the party is missing the highlighted game             */
+      move(LINES - 3, 0);
+      clrtoeol();
+      move(LINES - 2, 0);
+      clrtoeol();
+      if (game_view.item_count > 0)
+      {
+         game = ranking.p_games[game_view.cursor];
+         print_game_owners(p_roster, game, LINES - 3, 'd',
+                           ranking.party_count <
+                              p_roster->amount_of_players,
+                           "Need download:");
+         print_game_owners(p_roster, game, LINES - 2, 'n',
+                           ranking.party_count <
+                              p_roster->amount_of_players,
+                           "Don't have it:");
+      }
+      refresh();
+
+      key = wait_key();
+
+      if (list_view_key(&game_view, key))
+         continue;
+      if (key == '\t' || key == 27 || key == '\n' || key == KEY_ENTER)
+         break;
+   }
+
+   free(ranking.p_games);
+   free(ranking.p_ready);
+   free(ranking.p_waiting);
+
+   return;
+}
+
+/**********************************************************************/
+/*        Count each game's players and sort them, best first         */
+/**********************************************************************/
+int build_ranking(ROSTER *p_roster, RANKING *p_ranking)
+{
+   unsigned long long party[(MAX_PLAYERS + 63) / 64], /* Who is ranked*/
+                      *p_have,     /* Game's row of who has it        */
+                      *p_download; /* Game's row of who downloads it  */
+   int                *p_sorted,   /* Games sorted by the first key   */
+                      *p_counts,   /* Games for each count, then where*/
+                                   /* the games with it start         */
+                      game_counter,/* Count through each game         */
+                      game,        /* Game being placed in the order  */
+                      word,        /* Count through each word of bits */
+                      count,       /* Count through each player count */
+                      total,       /* Games with a higher count       */
+                      player_counter; /* Count through each player    */
+   long long          start = trace_begin(); /* When ranking started  */
+
+   memset(p_ranking, 0, sizeof(*p_ranking));
+   p_ranking->p_roster = p_roster;
+   if (p_roster->p_have_bits == NULL)
+      return 0;
+
+   /* With nobody picked yet, everyone counts as online               */
+   memset(party, 0, sizeof(party));
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+      {
+         party[player_counter / 64] |= 1ULL << (player_counter % 64);
+         p_ranking->party_count++;
+      }
+   if (p_ranking->party_count == 0)
+   {
+      for (player_counter = 0;
+           player_counter < p_roster->amount_of_players;
+           player_counter++)
+         party[player_counter / 64] |= 1ULL << (player_counter % 64);
+      p_ranking->party_count = p_roster->amount_of_players;
+   }
+
+   p_ranking->p_games   = (int *) malloc(sizeof(int) *
+                                         (p_roster->amount_of_games + 1));
+   p_ranking->p_ready   = (int *) malloc(sizeof(int) *
+                                         (p_roster->amount_of_games + 1));
+   p_ranking->p_waiting = (int *) malloc(sizeof(int) *
+                                         (p_roster->amount_of_games + 1));
+   p_sorted = (int *) malloc(sizeof(int) * (p_roster->amount_of_games + 1));
+   p_counts = (int *) malloc(sizeof(int) * (p_ranking->party_count + 2));
+   if (p_ranking->p_games == NULL || p_ranking->p_ready == NULL ||
+       p_ranking->p_waiting == NULL || p_sorted == NULL || p_counts == NULL)
+   {
+      free(p_ranking->p_games);
+      free(p_ranking->p_ready);
+      free(p_ranking->p_waiting);
+      free(p_sorted);
+      free(p_counts);
+      return 0;
+   }
+
+   /* A word of each game's bits counts 64 players at a time, and a   */
+   /* player limit caps how many of them can play together            */
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+   {
+      p_have     = p_roster->p_have_bits +
+                   (size_t) game_counter * p_roster->player_words;
+      p_download = p_roster->p_download_bits +
+                   (size_t) game_counter * p_roster->player_words;
+      p_ranking->p_ready[game_counter]   = 0;
+      p_ranking->p_waiting[game_counter] = 0;
+      for (word = 0; word < p_roster->player_words; word++)
+      {
+         p_ranking->p_ready[game_counter] +=
+            count_bits(p_have[word] & party[word]);
+         p_ranking->p_waiting[game_counter] +=
+            count_bits(p_download[word] & party[word]);
+      }
+      if (p_roster->game_list[game_counter].player_limit > 0)
+      {
+         if (p_ranking->p_ready[game_counter] >
+             p_roster->game_list[game_counter].player_limit)
+            p_ranking->p_ready[game_counter] =
+               p_roster->game_list[game_counter].player_limit;
+         if (p_ranking->p_ready[game_counter] +
+                p_ranking->p_waiting[game_counter] >
+             p_roster->game_list[game_counter].player_limit)
+            p_ranking->p_waiting[game_counter] =
+               p_roster->game_list[game_counter].player_limit -
+               p_ranking->p_ready[game_counter];
+      }
+   }
+
+   /* Counts never pass the party's size, so two stable counting      */
+   /* sorts, after downloads then now, rank every game in linear time */
+   memset(p_counts, 0, sizeof(int) * (p_ranking->party_count + 2));
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+      p_counts[p_ranking->p_ready[game_counter] +
+               p_ranking->p_waiting[game_counter]]++;
+   for (total = 0, count = p_ranking->party_count; count >= 0; count--)
+   {
+      total          += p_counts[count];
+      p_counts[count] = total - p_counts[count];
+   }
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+      p_sorted[p_counts[p_ranking->p_ready[game_counter] +
+                        p_ranking->p_waiting[game_counter]]++] =
+         game_counter;
+
+   memset(p_counts, 0, sizeof(int) * (p_ranking->party_count + 2));
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+      p_counts[p_ranking->p_ready[game_counter]]++;
+   for (total = 0, count = p_ranking->party_count; count >= 0; count--)
+   {
+      total          += p_counts[count];
+      p_counts[count] = total - p_counts[count];
+   }
+   for (game_counter = 0;
+        game_counter < p_roster->amount_of_games;
+        game_counter++)
+   {
+      game = p_sorted[game_counter];
+      p_ranking->p_games[p_counts[p_ranking->p_ready[game]]++] = game;
+   }
+
+   /* Games nobody online has or could get sort last and are left off */
+   p_ranking->game_count = p_roster->amount_of_games;
+   while (p_ranking->game_count > 0)
+   {
+      game = p_ranking->p_games[p_ranking->game_count - 1];
+      if (p_ranking->p_ready[game] + p_ranking->p_waiting[game] > 0)
+         break;
+      p_ranking->game_count--;
+   }
+
+   free(p_sorted);
+   free(p_counts);
+   trace_end("build_ranking", "filter", start);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                    Draw one row of the ranked games                */
+/**********************************************************************/
+void draw_ranked_item(void *p_items, int item)
+{
+   RANKING *p_ranking = (RANKING *) p_items; /* Games in order        */
+   GAME    *p_game;                          /* Game on the row       */
+   int     game = p_ranking->p_games[item];  /* Its place in the list */
+
+   p_game = &p_ranking->p_roster->game_list[game];
+   printw("%3d  %9d%-7s  %s", p_ranking->p_ready[game],
+          p_ranking->p_ready[game] + p_ranking->p_waiting[game],
+          (p_game->player_limit > 0 &&
+           p_game->player_limit < p_ranking->party_count) ? " (max)" : "",
+          p_game->game_name);
+
+   return;
+}
+
+/**********************************************************************/
+/*          Find the games a set expression of players picks          */
+/**********************************************************************/
+void query_games(ROSTER *p_roster)
+{
+   GAME_QUERY query;        /* Query typed and the games it found     */
+   LIST_VIEW  game_view;    /* Visible part of the games found        */
+   char       text[MAX_EXPRESSION_LEN + 1]; /* Query typed so far     */
+   int        length = 0,   /* Characters typed                       */
+              changed = 1,  /* Query needs to be run again            */
+              key;          /* Key pressed by user                    */
+   long long  start = 0;    /* When the query started running         */
+
+   memset(&query, 0, sizeof(query));
+   query.p_roster = p_roster;
+   text[0]        = '\0';
+   list_view_init(&game_view, 0);
+   clear_screen();
+
+   while (1)
+   {
+      /* Every key runs the query again, so the list follows typing   */
+      if (changed)
+      {
+         start = monotonic_us();
+         run_game_query(&query, text);
+         start = monotonic_us() - start;
+         list_view_init(&game_view, query.result.count);
+         changed = 0;
+      }
+      list_view_place(&game_view, HEADER_ROWS + 3,
+                      LINES - HEADER_ROWS - 5);
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Names, d:name needs download, party, & | - ! ( ), "
+             "tab to go back");
+      move(HEADER_ROWS + 1, 0);
+      clrtoeol();
+      if (p_roster->p_postings == NULL)
+         printw("Not enough memory to query the games");
+      else if (query.error[0] != '\0')
+         printw("%s", query.error);
+      else if (length > 0)
+         printw("Games (%d), found in %lld us:", query.result.count, start);
+      else
+         printw("e.g. Ann & Bob - Cat, or d:party");
+      list_view_draw(&game_view, draw_query_item, &query);
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Query: %s", text);
+      refresh();
+
+      key = wait_key();
+
+      if (list_view_key(&game_view, key))
+         continue;
+      if (key == '\t' || key == '\n' || key == KEY_ENTER)
+         break;
+      else if (key == 27)
+      {
+         if (length == 0)
+            break;
+         length  = 0;
+         changed = 1;
+      }
+      else if ((key == KEY_BACKSPACE || key == 127 || key == '\b') &&
+               length > 0)
+      {
+         length--;
+         changed = 1;
+      }
+      else if (key >= ' ' && key < 127 && length < MAX_EXPRESSION_LEN)
+      {
+         text[length++] = (char) key;
+         changed        = 1;
+      }
+      text[length] = '\0';
+   }
+
+   free_posting(&query.result);
+
+   return;
+}
+
+/**********************************************************************/
+/*               Draw one row of the games a query found              */
+/**********************************************************************/
+void draw_query_item(void *p_items, int item)
+{
+   GAME_QUERY *p_query = (GAME_QUERY *) p_items; /* Games found        */
+
+   printw("%s", p_query->p_roster->game_list[
+                   p_query->result.p_games[item]].game_name);
+
+   return;
+}
+
+/**********************************************************************/
+/*     Read and run a query, returns 0 with the reason if it can't    */
+/**********************************************************************/
+int run_game_query(GAME_QUERY *p_query, const char *p_text)
+{
+   free_posting(&p_query->result);
+   p_query->p_text   = p_text;
+   p_query->position = 0;
+   p_query->error[0] = '\0';
+   if (p_query->p_roster->p_postings == NULL)
+      return 0;
+
+   while (p_text[p_query->position] == ' ')
+      p_query->position++;
+   if (p_text[p_query->position] == '\0')
+      return 1; /* Nothing typed picks nothing                        */
+
+   if (!parse_query_union(p_query, &p_query->result))
+      return 0;
+   if (p_text[p_query->position] == ')')
+   {
+      snprintf(p_query->error, sizeof(p_query->error),
+               "A ) closes nothing");
+      free_posting(&p_query->result);
+      return 0;
+   }
+
+   /* Shown a row at a time, so the games found are kept as numbers   */
+   if (!posting_unpack(&p_query->result,
+                       p_query->p_roster->amount_of_games))
+   {
+      snprintf(p_query->error, sizeof(p_query->error),
+               "Not enough memory to run the query");
+      free_posting(&p_query->result);
+      return 0;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                     Read terms joined by |                         */
+/**********************************************************************/
+int parse_query_union(GAME_QUERY *p_query, POSTING *p_result)
+{
+   POSTING left,  /* Games picked so far                              */
+           right; /* Games the next term picks                        */
+
+   if (!parse_query_meet(p_query, &left))
+      return 0;
+   while (p_query->p_text[p_query->position] == '|')
+   {
+      p_query->position++;
+      if (!parse_query_meet(p_query, &right))
+      {
+         free_posting(&left);
+         return 0;
+      }
+      if (!posting_combine(&left, &right, QUERY_OR,
+                           p_query->p_roster->amount_of_games, p_result))
+      {
+         snprintf(p_query->error, sizeof(p_query->error),
+                  "Not enough memory to run the query");
+         free_posting(&left);
+         free_posting(&right);
+         return 0;
+      }
+      free_posting(&left);
+      free_posting(&right);
+      left = *p_result;
+   }
+   *p_result = left;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                Read terms joined by &, - or nothing                */
+/**********************************************************************/
+int parse_query_meet(GAME_QUERY *p_query, POSTING *p_result)
+{
+   POSTING left,      /* Games picked so far                          */
+           right;     /* Games the next term picks                    */
+   int     operation; /* How the next term joins in                   */
+   char    next;      /* Character after the last term                */
+
+   if (!parse_query_term(p_query, &left))
+      return 0;
+
+   /* Terms side by side must all hold, as if joined by &             */
+   while ((next = p_query->p_text[p_query->position]) != '\0' &&
+          next != '|' && next != ')')
+   {
+      operation = (next == '-') ? QUERY_AND_NOT : QUERY_AND;
+      if (next == '&' || next == '-')
+         p_query->position++;
+      if (!parse_query_term(p_query, &right))
+      {
+         free_posting(&left);
+         return 0;
+      }
+      if (!posting_combine(&left, &right, operation,
+                           p_query->p_roster->amount_of_games, p_result))
+      {
+         snprintf(p_query->error, sizeof(p_query->error),
+                  "Not enough memory to run the query");
+         free_posting(&left);
+         free_posting(&right);
+         return 0;
+      }
+      free_posting(&left);
+      free_posting(&right);
+      left = *p_result;
+   }
+   *p_result = left;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*          Read a name, d:name, party, !term or (expression)         */
+/**********************************************************************/
+int parse_query_term(GAME_QUERY *p_query, POSTING *p_result)
+{
+   POSTING    inner;      /* Games the term after ! picks             */
+   const char *p_text = p_query->p_text; /* Expression being read     */
+   int        download = 0, /* Term is about games to download        */
+              name_start, /* Where the name starts                    */
+              ok;         /* Term was read                            */
+
+   while (p_text[p_query->position] == ' ')
+      p_query->position++;
+
+   if (p_text[p_query->position] == '!')
+   {
+      p_query->position++;
+      if (!parse_query_term(p_query, &inner))
+         return 0;
+      ok = posting_invert(&inner, p_query->p_roster->amount_of_games,
+                          p_result);
+      free_posting(&inner);
+      if (!ok)
+         snprintf(p_query->error, sizeof(p_query->error),
+                  "Not enough memory to run the query");
+      return ok;
+   }
+
+   if (p_text[p_query->position] == '(')
+   {
+      p_query->position++;
+      if (!parse_query_union(p_query, p_result))
+         return 0;
+      if (p_text[p_query->position] != ')')
+      {
+         snprintf(p_query->error, sizeof(p_query->error),
+                  "A ( is never closed");
+         free_posting(p_result);
+         return 0;
+      }
+      p_query->position++;
+   }
+   else
+   {
+      if (tolower((unsigned char) p_text[p_query->position]) == 'd' &&
+          p_text[p_query->position + 1] == ':')
+      {
+         download           = 1;
+         p_query->position += 2;
+      }
+
+      /* A name runs until a space or an operator                     */
+      name_start = p_query->position;
+      while (p_text[p_query->position] != '\0' &&
+             strchr(" &|-!()", p_text[p_query->position]) == NULL)
+         p_query->position++;
+      if (p_query->position == name_start)
+      {
+         snprintf(p_query->error, sizeof(p_query->error),
+                  "Expected a player's name at column %d",
+                  p_query->position + 1);
+         return 0;
+      }
+      if (!query_player_list(p_query, p_text + name_start,
+                             p_query->position - name_start, download,
+                             p_result))
+         return 0;
+   }
+
+   while (p_text[p_query->position] == ' ')
+      p_query->position++;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*  List the games a player, or anyone in the party, has or needs     */
+/**********************************************************************/
+int query_player_list(GAME_QUERY *p_query,
+                      const char *p_name,
+                      int        name_length,
+                      int        download,
+                      POSTING    *p_result)
+{
+   ROSTER  *p_roster = p_query->p_roster; /* Roster being queried     */
+   POSTING joined;         /* Games of the members so far, joined     */
+   char    name[MAX_PLAYER_NAME]; /* Name as typed, ended             */
+   int     player_counter; /* Count through each player               */
+
+   memset(p_result, 0, sizeof(*p_result));
+   if (name_length >= MAX_PLAYER_NAME)
+      name_length = MAX_PLAYER_NAME - 1;
+   memcpy(name, p_name, name_length);
+   name[name_length] = '\0';
+
+   /* A player's own list is used as it is, never copied              */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (same_name(p_roster->player_list[player_counter].player_name,
+                    name))
+      {
+         *p_result = p_roster->p_postings[2 * player_counter + download];
+         return 1;
+      }
+
+   if (!same_name("party", name))
+   {
+      snprintf(p_query->error, sizeof(p_query->error),
+               "Nobody is named %s", name);
+      return 0;
+   }
+
+   /* The party picks a game if anyone in it does                     */
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+      {
+         if (!posting_combine(p_result,
+                              &p_roster->p_postings[2 * player_counter +
+                                                    download],
+                              QUERY_OR, p_roster->amount_of_games,
+                              &joined))
+         {
+            snprintf(p_query->error, sizeof(p_query->error),
+                     "Not enough memory to run the query");
+            free_posting(p_result);
+            return 0;
+         }
+         free_posting(p_result);
+         *p_result = joined;
+      }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*            Intersect, join or subtract two lists of games          */
+/**********************************************************************/
+int posting_combine(POSTING *p_first,
+                    POSTING *p_second,
+                    int     operation,
+                    int     game_count,
+                    POSTING *p_result)
+{
+   POSTING *p_walked,    /* List whose numbers are walked             */
+           *p_searched,  /* List each of them is looked up in         */
+           *p_swap;      /* Lists being swapped                       */
+   int     words = (game_count + 63) / 64, /* Words of bits a list    */
+           walk_counter, /* Count through the walked list             */
+           found = 0,    /* Place reached in the searched list        */
+           game,         /* Game being looked up                      */
+           in_both,      /* Game is in the searched list too          */
+           word;         /* Count through each word of bits           */
+
+   memset(p_result, 0, sizeof(*p_result));
+
+   /* Both as numbers: the numbers of a union are merged, otherwise   */
+   /* each number walked is looked up in the other list, galloping    */
+   /* when that one is far longer                                     */
+   if (p_first->p_bits == NULL && p_second->p_bits == NULL)
+   {
+      p_result->p_games = (int *) malloc(sizeof(int) *
+         (p_first->count + ((operation == QUERY_OR) ? p_second->count : 0)
+          + 1));
+      if (p_result->p_games == NULL)
+         return 0;
+      if (operation == QUERY_OR)
+      {
+         walk_counter = 0;
+         while (walk_counter < p_first->count || found < p_second->count)
+            if (found == p_second->count ||
+                (walk_counter < p_first->count &&
+                 p_first->p_games[walk_counter] < p_second->p_games[found]))
+               p_result->p_games[p_result->count++] =
+                  p_first->p_games[walk_counter++];
+            else
+            {
+               if (walk_counter < p_first->count &&
+                   p_first->p_games[walk_counter] ==
+                      p_second->p_games[found])
+                  walk_counter++;
+               p_result->p_games[p_result->count++] =
+                  p_second->p_games[found++];
+            }
+         return 1;
+      }
+      p_walked   = p_first;
+      p_searched = p_second;
+      if (operation == QUERY_AND && p_second->count < p_first->count)
+      {
+         p_walked   = p_second;
+         p_searched = p_first;
+      }
+      for (walk_counter = 0; walk_counter < p_walked->count; walk_counter++)
+      {
+         game = p_walked->p_games[walk_counter];
+         if (p_searched->count > GALLOP_RATIO * p_walked->count)
+            found = gallop_to(p_searched->p_games, p_searched->count,
+                              found, game);
+         else
+            while (found < p_searched->count &&
+                   p_searched->p_games[found] < game)
+               found++;
+         in_both = found < p_searched->count &&
+                   p_searched->p_games[found] == game;
+         if (in_both == (operation == QUERY_AND))
+            p_result->p_games[p_result->count++] = game;
+      }
+      return 1;
+   }
+
+   /* Numbers meeting bits, or numbers less bits: each number is      */
+   /* tested against its bit                                          */
+   if (operation != QUERY_OR &&
+       (p_first->p_bits == NULL ||
+        (operation == QUERY_AND && p_second->p_bits == NULL)))
+   {
+      p_walked   = p_first;
+      p_searched = p_second;
+      if (p_first->p_bits != NULL)
+      {
+         p_swap     = p_walked;
+         p_walked   = p_searched;
+         p_searched = p_swap;
+      }
+      p_result->p_games = (int *) malloc(sizeof(int) *
+                                         (p_walked->count + 1));
+      if (p_result->p_games == NULL)
+         return 0;
+      for (walk_counter = 0; walk_counter < p_walked->count; walk_counter++)
+      {
+         game    = p_walked->p_games[walk_counter];
+         in_both = (p_searched->p_bits[game / 64] >> (game % 64)) & 1;
+         if (in_both == (operation == QUERY_AND))
+            p_result->p_games[p_result->count++] = game;
+      }
+      return 1;
+   }
+
+   /* Anything else comes out as bits, a word of 64 games at a time   */
+   p_result->p_bits = (unsigned long long *)
+      calloc(words + 1, sizeof(unsigned long long));
+   if (p_result->p_bits == NULL)
+      return 0;
+   if (p_first->p_bits != NULL)
+      memcpy(p_result->p_bits, p_first->p_bits,
+             sizeof(unsigned long long) * words);
+   else
+      for (walk_counter = 0; walk_counter < p_first->count; walk_counter++)
+         p_result->p_bits[p_first->p_games[walk_counter] / 64] |=
+            1ULL << (p_first->p_games[walk_counter] % 64);
+
+   if (p_second->p_bits != NULL)
+      for (word = 0; word < words; word++)
+         if (operation == QUERY_AND)
+            p_result->p_bits[word] &= p_second->p_bits[word];
+         else if (operation == QUERY_OR)
+            p_result->p_bits[word] |= p_second->p_bits[word];
+         else
+            p_result->p_bits[word] &= ~p_second->p_bits[word];
+   else
+      for (walk_counter = 0; walk_counter < p_second->count; walk_counter++)
+      {
+         game = p_second->p_games[walk_counter];
+         if (operation == QUERY_OR)
+            p_result->p_bits[game / 64] |= 1ULL << (game % 64);
+         else
+            p_result->p_bits[game / 64] &= ~(1ULL << (game % 64));
+      }
+
+   for (word = 0; word < words; word++)
+      p_result->count += count_bits(p_result->p_bits[word]);
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                  List the games missing from a list                */
+/**********************************************************************/
+int posting_invert(POSTING *p_posting, int game_count, POSTING *p_result)
+{
+   int words = (game_count + 63) / 64, /* Words of bits a list        */
+       game_counter, /* Count through each game in the list           */
+       word;         /* Count through each word of bits               */
+
+   memset(p_result, 0, sizeof(*p_result));
+   p_result->p_bits = (unsigned long long *)
+      calloc(words + 1, sizeof(unsigned long long));
+   if (p_result->p_bits == NULL)
+      return 0;
+
+   if (p_posting->p_bits != NULL)
+      for (word = 0; word < words; word++)
+         p_result->p_bits[word] = ~p_posting->p_bits[word];
+   else
+   {
+      memset(p_result->p_bits, 0xff, sizeof(unsigned long long) * words);
+      for (game_counter = 0; game_counter < p_posting->count; game_counter++)
+         p_result->p_bits[p_posting->p_games[game_counter] / 64] &=
+            ~(1ULL << (p_posting->p_games[game_counter] % 64));
+   }
+
+   /* Games past the last one are never in the list                   */
+   if (game_count % 64 != 0)
+      p_result->p_bits[words - 1] &= (1ULL << (game_count % 64)) - 1;
+   p_result->count = game_count - p_posting->count;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*             Turn a list kept as bits into game numbers             */
+/**********************************************************************/
+int posting_unpack(POSTING *p_posting, int game_count)
+{
+   unsigned long long bits;  /* Games of one word not yet numbered    */
+   int                *p_games, /* Game numbers, in order             */
+                      count = 0, /* Games numbered so far             */
+                      word;  /* Count through each word of bits       */
+
+   if (p_posting->p_bits == NULL)
+      return 1;
+   if ((p_games = (int *) malloc(sizeof(int) *
+                                 (p_posting->count + 1))) == NULL)
+      return 0;
+
+   for (word = 0; word < (game_count + 63) / 64; word++)
+      for (bits = p_posting->p_bits[word]; bits != 0; bits &= bits - 1)
+         p_games[count++] = word * 64 + count_bits((bits & -bits) - 1);
+
+   free_posting(p_posting);
+   p_posting->p_games = p_games;
+   p_posting->count   = count;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*    Find the first place from start holding game or a later one     */
+/**********************************************************************/
+int gallop_to(const int *p_games, int count, int start, int game)
+{
+   int step = 1, /* Distance of the next jump                         */
+       low,      /* Last place known to hold an earlier game          */
+       high,     /* First place known to hold game or a later one     */
+       middle;   /* Place being checked                               */
+
+   if (start >= count || p_games[start] >= game)
+      return start;
+
+   /* Jump ahead twice as far each time, then binary search the gap   */
+   low = start;
+   while (low + step < count && p_games[low + step] < game)
+   {
+      low  += step;
+      step *= 2;
+   }
+   high = (low + step < count) ? low + step : count;
+   while (high - low > 1)
+   {
+      middle = low + (high - low) / 2;
+      if (p_games[middle] < game)
+         low = middle;
+      else
+         high = middle;
+   }
+
+   return high;
+}
+
+/**********************************************************************/
+/*                 Free a list of games a query made                  */
+/**********************************************************************/
+void free_posting(POSTING *p_posting)
+{
+   /* A player's own list belongs to the roster                       */
+   if (!p_posting->shared)
+   {
+      free(p_posting->p_games);
+      free(p_posting->p_bits);
+   }
+   memset(p_posting, 0, sizeof(*p_posting));
+
+   return;
+}
+
+/**********************************************************************/
+/*      Let the user filter the games on the sheet's extra columns    */
+/**********************************************************************/
+void filter_games(ROSTER *p_roster, GAME_FILTER *p_filter)
+{
+   char      text[MAX_FILTER_LEN + 1]; /* Filter typed so far         */
+   int       length = 0,  /* Characters typed                         */
+             changed = 1, /* Filter needs to be run again             */
+             kept = 0,    /* Games the filter keeps                   */
+             key;         /* Key pressed by user                      */
+   long long start = 0;   /* When the filter started running          */
+
+   memset(p_filter, 0, sizeof(*p_filter));
+   p_filter->p_roster = p_roster;
+   text[0]            = '\0';
+   clear_screen();
+
+   while (1)
+   {
+      /* Every key compiles and runs the filter again, so the count   */
+      /* follows typing                                               */
+      if (changed)
+      {
+         start = monotonic_us();
+         if (compile_game_filter(p_filter, text))
+            kept = run_game_filter(p_filter, p_roster->amount_of_games);
+         start   = monotonic_us() - start;
+         changed = 0;
+      }
+
+      move(HEADER_ROWS - 2, 0);
+      clrtoeol();
+      printw("Column = != < <= > >= value, and or not ( ), "
+             "enter to use, esc to clear");
+      move(HEADER_ROWS - 1, 0);
+      clrtoeol();
+      printw("A game with no value in the column passes only != "
+             "and not");
+      move(HEADER_ROWS + 1, 0);
+      clrtoeol();
+      if (p_filter->error[0] != '\0')
+         printw("%s", p_filter->error);
+      else if (p_filter->step_count > 0)
+         printw("Games (%d of %d) match, found in %lld us", kept,
+                p_roster->amount_of_games, start);
+      else
+         printw("e.g. genre=coop and length<=60, enter for no filter");
+      print_filter_columns(p_roster, HEADER_ROWS + 3);
+      move(HEADER_ROWS, 0);
+      clrtoeol();
+      printw("Filter: %s", text);
+      refresh();
+
+      key = wait_key();
+
+      /* Only a filter that could be read is used                     */
+      if (key == '\n' || key == KEY_ENTER)
+      {
+         if (p_filter->error[0] == '\0')
+            break;
+      }
+      else if (key == 27)
+      {
+         if (length == 0)
+            break;
+         length  = 0;
+         changed = 1;
+      }
+      else if ((key == KEY_BACKSPACE || key == 127 || key == '\b') &&
+               length > 0)
+      {
+         length--;
+         changed = 1;
+      }
+      else if (key >= ' ' && key < 127 && length < MAX_FILTER_LEN)
+      {
+         text[length++] = (char) key;
+         changed        = 1;
+      }
+      text[length] = '\0';
+   }
+
+   /* Esc with nothing typed leaves every game in                     */
+   if (length == 0)
+      p_filter->step_count = 0;
+   p_filter->p_text = NULL;
+   clear_screen();
+
+   return;
+}
+
+/**********************************************************************/
+/*               List the extra columns a filter can use              */
+/**********************************************************************/
+void print_filter_columns(ROSTER *p_roster, int row)
+{
+   ATTRIBUTE *p_column; /* Column being listed                        */
+   int       column,    /* Count through each column                  */
+             game,      /* Count through each game                    */
+             code,      /* Count through each text value              */
+             low = 0,   /* Lowest number in the column                */
+             high = 0,  /* Highest number in the column               */
+             found;     /* Games with a number in the column          */
+
+   for (column = 0;
+        column < p_roster->attributes.count && row + column < LINES;
+        column++)
+   {
+      p_column = &p_roster->attributes.columns[column];
+      move(row + column, 0);
+      clrtoeol();
+      if (p_column->is_number)
+      {
+         found = 0;
+         for (game = 0; game < p_roster->amount_of_games; game++)
+            if (p_column->p_values[game] != ATTRIBUTE_MISSING)
+            {
+               if (found == 0 || p_column->p_values[game] < low)
+                  low = p_column->p_values[game];
+               if (found == 0 || p_column->p_values[game] > high)
+                  high = p_column->p_values[game];
+               found++;
+            }
+         printw("%s: number, %d to %d", p_column->name, low, high);
+      }
+      else
+      {
+         printw("%s: text, %d values:", p_column->name,
+                p_column->text_count);
+         for (code = 0;
+              code < p_column->text_count && code < FILTER_SHOWN_VALUES;
+              code++)
+            printw(" %s", p_column->p_texts[code]);
+         if (p_column->text_count > FILTER_SHOWN_VALUES)
+            printw(" ...");
+      }
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*   Compile a filter to steps, returns 0 with the reason if it can't */
+/**********************************************************************/
+int compile_game_filter(GAME_FILTER *p_filter, const char *p_text)
+{
+   p_filter->p_text     = p_text;
+   p_filter->position   = 0;
+   p_filter->step_count = 0;
+   p_filter->depth      = 0;
+   p_filter->max_depth  = 0;
+   p_filter->ready      = 0;
+   p_filter->error[0]   = '\0';
+
+   while (p_text[p_filter->position] == ' ')
+      p_filter->position++;
+   if (p_text[p_filter->position] == '\0')
+      return 1; /* Nothing typed keeps every game                     */
+
+   if (parse_filter_any(p_filter) && p_text[p_filter->position] == ')')
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "A ) closes nothing");
+   if (p_filter->error[0] != '\0')
+   {
+      p_filter->step_count = 0;
+      return 0;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                       Read tests joined by or                      */
+/**********************************************************************/
+int parse_filter_any(GAME_FILTER *p_filter)
+{
+   if (!parse_filter_all(p_filter))
+      return 0;
+   while (filter_keyword(p_filter, "or") || filter_keyword(p_filter, "|"))
+      if (!parse_filter_all(p_filter) ||
+          !add_filter_step(p_filter, FILTER_OR))
+         return 0;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*                 Read tests joined by and, or nothing               */
+/**********************************************************************/
+int parse_filter_all(GAME_FILTER *p_filter)
+{
+   int  or_start; /* Where an or would start                          */
+   char next;     /* Character after the last test                    */
+
+   if (!parse_filter_test(p_filter))
+      return 0;
+
+   /* Tests side by side must all hold, as if joined by and           */
+   while ((next = p_filter->p_text[p_filter->position]) != '\0' &&
+          next != '|' && next != ')')
+   {
+      or_start = p_filter->position;
+      if (filter_keyword(p_filter, "or"))
+      {
+         p_filter->position = or_start;
+         break;
+      }
+      if (!filter_keyword(p_filter, "and"))
+         filter_keyword(p_filter, "&");
+      if (!parse_filter_test(p_filter) ||
+          !add_filter_step(p_filter, FILTER_AND))
+         return 0;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*              Read column op value, not test or (filter)            */
+/**********************************************************************/
+int parse_filter_test(GAME_FILTER *p_filter)
+{
+   ATTRIBUTES  *p_attributes = &p_filter->p_roster->attributes;
+   FILTER_STEP *p_step;   /* Step the test compiles to                */
+   const char  *p_text = p_filter->p_text; /* Filter being read       */
+   char        name[MAX_ATTRIBUTE_NAME],   /* Column as typed         */
+               value[MAX_ATTRIBUTE_VALUE], /* Value as typed          */
+               *p_number_end; /* Where the value's digits stop        */
+   int         start,     /* Where the name or value starts           */
+               column,    /* Column the test reads                    */
+               code;      /* Code of a text value                     */
+   long        number;    /* Value as a number                        */
+   char        relation[3] = ""; /* Comparison typed                  */
+
+   if (filter_keyword(p_filter, "not") || filter_keyword(p_filter, "!"))
+      return parse_filter_test(p_filter) &&
+             add_filter_step(p_filter, FILTER_NOT);
+
+   if (filter_keyword(p_filter, "("))
+   {
+      if (!parse_filter_any(p_filter))
+         return 0;
+      if (!filter_keyword(p_filter, ")"))
+      {
+         snprintf(p_filter->error, sizeof(p_filter->error),
+                  "A ( is never closed");
+         return 0;
+      }
+      return 1;
+   }
+
+   /* A column's name runs until a space or a comparison              */
+   start = p_filter->position;
+   while (p_text[p_filter->position] != '\0' &&
+          strchr(" =!<>()&|", p_text[p_filter->position]) == NULL)
+      p_filter->position++;
+   if (p_filter->position == start)
+   {
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "Expected a column's name at column %d", start + 1);
+      return 0;
+   }
+   snprintf(name, sizeof(name), "%.*s", p_filter->position - start,
+            p_text + start);
+   for (column = 0; column < p_attributes->count; column++)
+      if (same_name(p_attributes->columns[column].name, name))
+         break;
+   if (column == p_attributes->count)
+   {
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "No column is named %s", name);
+      return 0;
+   }
+
+   while (p_text[p_filter->position] == ' ')
+      p_filter->position++;
+   while (strlen(relation) < 2 && p_text[p_filter->position] != '\0' &&
+          strchr("=!<>", p_text[p_filter->position]) != NULL)
+      relation[strlen(relation)] = p_text[p_filter->position++];
+   if (strcmp(relation, "==") == 0)
+      strcpy(relation, "=");
+   else if (strcmp(relation, "<>") == 0)
+      strcpy(relation, "!=");
+   if (strcmp(relation, "=") != 0 && strcmp(relation, "!=") != 0 &&
+       strcmp(relation, "<") != 0 && strcmp(relation, "<=") != 0 &&
+       strcmp(relation, ">") != 0 && strcmp(relation, ">=") != 0)
+   {
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "Expected = != < <= > or >= at column %d",
+               p_filter->position + 1);
+      return 0;
+   }
+
+   /* A value runs until a space or a bracket                         */
+   while (p_text[p_filter->position] == ' ')
+      p_filter->position++;
+   start = p_filter->position;
+   while (p_text[p_filter->position] != '\0' &&
+          strchr(" ()&|", p_text[p_filter->position]) == NULL)
+      p_filter->position++;
+   if (p_filter->position == start)
+   {
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "Expected a value at column %d", start + 1);
+      return 0;
+   }
+   snprintf(value, sizeof(value), "%.*s", p_filter->position - start,
+            p_text + start);
+   while (p_text[p_filter->position] == ' ')
+      p_filter->position++;
+
+   if (!add_filter_step(p_filter, FILTER_TEST))
+      return 0;
+   p_step          = &p_filter->steps[p_filter->step_count - 1];
+   p_step->column  = column;
+   p_step->outside = strcmp(relation, "!=") == 0;
+
+   /* Every comparison is a range, with != keeping what is outside it */
+   if (p_attributes->columns[column].is_number)
+   {
+      number = strtol(value, &p_number_end, 10);
+      if (*p_number_end != '\0')
+      {
+         snprintf(p_filter->error, sizeof(p_filter->error),
+                  "%s needs a number, not %s", name, value);
+         return 0;
+      }
+      if (number < -MAX_ATTRIBUTE_NUMBER)
+         number = -MAX_ATTRIBUTE_NUMBER;
+      if (number > MAX_ATTRIBUTE_NUMBER)
+         number = MAX_ATTRIBUTE_NUMBER;
+      p_step->low  = relation[0] == '<' ? -MAX_ATTRIBUTE_NUMBER :
+                     strcmp(relation, ">") == 0 ? (int) number + 1 :
+                                                  (int) number;
+      p_step->high = relation[0] == '>' ? MAX_ATTRIBUTE_NUMBER :
+                     strcmp(relation, "<") == 0 ? (int) number - 1 :
+                                                  (int) number;
+
+      /* Nothing is below the lowest number, or above the highest     */
+      if (p_step->low > p_step->high)
+      {
+         p_step->low  = ATTRIBUTE_MISSING;
+         p_step->high = ATTRIBUTE_MISSING;
+      }
+   }
+   else
+   {
+      if (relation[0] == '<' || relation[0] == '>')
+      {
+         snprintf(p_filter->error, sizeof(p_filter->error),
+                  "%s is text, use = or !=", name);
+         return 0;
+      }
+
+      /* A value no game has matches nothing                          */
+      for (code = 0; code < p_attributes->columns[column].text_count;
+           code++)
+         if (same_name(p_attributes->columns[column].p_texts[code], value))
+            break;
+      p_step->low  = code < p_attributes->columns[column].text_count ?
+                        code : ATTRIBUTE_MISSING;
+      p_step->high = p_step->low;
+   }
+
+   return 1;
+}
+
+/**********************************************************************/
+/*           Skip a keyword if it is next, returns 1 if it was        */
+/**********************************************************************/
+int filter_keyword(GAME_FILTER *p_filter, const char *p_word)
+{
+   const char *p_next = p_filter->p_text + p_filter->position;
+   int        length  = (int) strlen(p_word), /* Keyword's length     */
+              byte;                           /* Count through it     */
+
+   /* Words match in any case, but only whole                         */
+   for (byte = 0; byte < length; byte++)
+      if (tolower((unsigned char) p_next[byte]) != p_word[byte])
+         return 0;
+   if (isalpha((unsigned char) p_word[0]) &&
+       (isalnum((unsigned char) p_next[length]) || p_next[length] == '_'))
+      return 0;
+
+   p_filter->position += length;
+   while (p_filter->p_text[p_filter->position] == ' ')
+      p_filter->position++;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*          Add a step to the filter, returns 0 if there is no room   */
+/**********************************************************************/
+int add_filter_step(GAME_FILTER *p_filter, int op)
+{
+   if (p_filter->step_count == MAX_FILTER_STEPS)
+   {
+      snprintf(p_filter->error, sizeof(p_filter->error),
+               "The filter is too long, at most %d tests and joins",
+               MAX_FILTER_STEPS);
+      return 0;
+   }
+   memset(&p_filter->steps[p_filter->step_count], 0, sizeof(FILTER_STEP));
+   p_filter->steps[p_filter->step_count++].op = op;
+
+   /* A test stacks a result and a join takes two off for one         */
+   if (op == FILTER_TEST)
+      p_filter->depth++;
+   else if (op == FILTER_AND || op == FILTER_OR)
+      p_filter->depth--;
+   if (p_filter->depth > p_filter->max_depth)
+      p_filter->max_depth = p_filter->depth;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*            Run a compiled filter, returns the games kept or -1     */
+/**********************************************************************/
+int run_game_filter(GAME_FILTER *p_filter, int game_count)
+{
+   unsigned long long *p_top,  /* Last result on the stack            */
+                      tail_mask; /* Bits of the last word in use      */
+   FILTER_STEP        *p_step; /* Step being run                      */
+   int                words,   /* Words of bits for the games         */
+                      word,    /* Count through each word             */
+                      step,    /* Count through each step             */
+                      depth = 0, /* Results stacked                   */
+                      kept = 0;  /* Games the filter keeps            */
+
+   p_filter->ready = 0;
+   if (p_filter->step_count == 0)
+      return game_count;
+
+   /* The stack lives as long as the session, and only grows          */
+   words = (game_count + 63) / 64;
+   if (words == 0)
+      words = 1;
+   if (p_filter->p_stack == NULL || words != p_filter->words ||
+       p_filter->max_depth > p_filter->stack_depth)
+   {
+      p_filter->p_stack = (unsigned long long *) arena_alloc(
+         &session_arena, (size_t) p_filter->max_depth * words *
+                         sizeof(unsigned long long));
+      if (p_filter->p_stack == NULL)
+      {
+         p_filter->stack_depth = 0;
+         snprintf(p_filter->error, sizeof(p_filter->error),
+                  "Not enough memory to run the filter");
+         return -1;
+      }
+      p_filter->words       = words;
+      p_filter->stack_depth = p_filter->max_depth;
+   }
+   tail_mask = game_count % 64 == 0 ? ~0ULL :
+                                      (1ULL << (game_count % 64)) - 1;
+
+   /* Each test fills a bitset of the games it keeps, a whole column  */
+   /* at a time, and the joins are then a word of games at a time     */
+   for (step = 0; step < p_filter->step_count; step++)
+   {
+      p_step = &p_filter->steps[step];
+      switch (p_step->op)
+      {
+         case FILTER_TEST:
+            filter_column(p_filter->p_roster->attributes.columns[
+                             p_step->column].p_values,
+                          game_count, p_step,
+                          p_filter->p_stack + (size_t) depth * words);
+            depth++;
+            break;
+         case FILTER_AND:
+            depth--;
+            p_top = p_filter->p_stack + (size_t) depth * words;
+            for (word = 0; word < words; word++)
+               p_top[word - words] &= p_top[word];
+            break;
+         case FILTER_OR:
+            depth--;
+            p_top = p_filter->p_stack + (size_t) depth * words;
+            for (word = 0; word < words; word++)
+               p_top[word - words] |= p_top[word];
+            break;
+         case FILTER_NOT:
+            p_top = p_filter->p_stack + (size_t) (depth - 1) * words;
+            for (word = 0; word < words; word++)
+               p_top[word] = ~p_top[word];
+            p_top[words - 1] &= tail_mask;
+            break;
+      }
+   }
+
+   for (word = 0; word < words; word++)
+      kept += count_bits(p_filter->p_stack[word]);
+   p_filter->ready = 1;
+
+   return kept;
+}
+
+/**********************************************************************/
+/*          Test every value of a column, a word of games at a time   */
+/**********************************************************************/
+void filter_column(const int          *p_values,
+                   int                game_count,
+                   FILTER_STEP        *p_step,
+                   unsigned long long *p_bits)
+{
+   unsigned long long bits;    /* Games of the word the test keeps    */
+   unsigned int       low  = (unsigned int) p_step->low,
+                      span = (unsigned int) p_step->high -
+                             (unsigned int) p_step->low;
+   int                word,    /* Count through each word of games    */
+                      bit,     /* Count through each game of the word */
+                      in_word, /* Games in the word                   */
+                      value;   /* Game's value                        */
+
+   /* One unsigned compare checks both ends of the range, with no     */
+   /* branch on the value. A missing value is never in the range, so  */
+   /* it passes only !=, the same as under not =                      */
+   for (word = 0; word * 64 < game_count; word++)
+   {
+      bits    = 0;
+      in_word = game_count - word * 64 < 64 ? game_count - word * 64 : 64;
+      for (bit = 0; bit < in_word; bit++)
+      {
+         value = p_values[word * 64 + bit];
+         bits |= (unsigned long long)
+                    ((((unsigned int) value - low <= span) &
+                      (value != ATTRIBUTE_MISSING)) ^
+                     p_step->outside) << bit;
+      }
+      p_bits[word] = bits;
+   }
+   if (game_count == 0)
+      p_bits[0] = 0;
+
+   return;
+}
+
+/**********************************************************************/
+/*                    Check if a filter keeps a game                  */
+/**********************************************************************/
+int filter_allows(GAME_FILTER *p_filter, int game)
+{
+   if (p_filter == NULL || !p_filter->ready)
+      return 1;
+
+   return (int) (p_filter->p_stack[game / 64] >> (game % 64)) & 1;
+}
+
+/**********************************************************************/
+/*   Turn tracing on if the flag or environment variable asks for it  */
+/**********************************************************************/
+void trace_init(int argc, char *argv[])
+{
+   char *p_file_name = getenv(TRACE_ENV); /* Trace file asked for     */
+   int  arg_counter;                      /* Count through arguments  */
+
+   /* "--trace" on its own writes to the default file                 */
+   for (arg_counter = 1; arg_counter < argc; arg_counter++)
+      if (strcmp(argv[arg_counter], TRACE_FLAG) == 0)
+      {
+         if (arg_counter + 1 < argc && argv[arg_counter + 1][0] != '-')
+            p_file_name = argv[++arg_counter];
+         else
+            p_file_name = TRACE_FILE;
+      }
+   if (p_file_name == NULL || p_file_name[0] == '\0')
+      return;
+
+   tracer.spans = (TRACE_SPAN *) malloc(sizeof(TRACE_SPAN) *
+                                        MAX_TRACE_SPANS);
+   if (tracer.spans == NULL)
+      return;
+   tracer.p_file_name = p_file_name;
+   tracer.span_count  = 0;
+   tracer.dropped     = 0;
+   tracer.origin      = monotonic_us();
+   tracer.threads[0]   = pthread_self();
+   tracer.thread_count = 1;
+   pthread_mutex_init(&tracer.lock, NULL);
+   tracer.enabled     = 1;
+
+   return;
+}
+
+/**********************************************************************/
+/*               Microseconds from a clock that never jumps           */
+/**********************************************************************/
+long long monotonic_us()
+{
+   struct timespec now; /* Current monotonic time                     */
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return (long long) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/**********************************************************************/
+/*       Start timing a stage, costs nothing when timing is off       */
+/**********************************************************************/
+long long trace_begin()
+{
+   if (!tracer.enabled && !metrics.enabled)
+      return 0;
+
+   return monotonic_us();
+}
+
+/**********************************************************************/
+/*               Record a stage that started at trace_begin()         */
+/**********************************************************************/
+void trace_end(const char *p_name, const char *p_category, long long start)
+{
+   if (!tracer.enabled)
+      return;
+
+   trace_span(p_name, p_category, start, monotonic_us() - start);
+
+   return;
+}
+
+/**********************************************************************/
+/*               Record a stage with a known start and length         */
+/**********************************************************************/
+void trace_span(const char *p_name,
+                const char *p_category,
+                long long  start,
+                long long  duration)
+{
+   TRACE_SPAN *p_span; /* Span being filled in                        */
+   int        thread;  /* Track of the thread recording it            */
+
+   if (!tracer.enabled)
+      return;
+
+   pthread_mutex_lock(&tracer.lock);
+
+   /* The trace may have been written out while waiting for the lock  */
+   if (!tracer.enabled)
+   {
+      pthread_mutex_unlock(&tracer.lock);
+      return;
+   }
+
+   /* Each worker gets a track of its own, those past the last one    */
+   /* sharing it                                                      */
+   for (thread = 0; thread < tracer.thread_count; thread++)
+      if (pthread_equal(pthread_self(), tracer.threads[thread]))
+         break;
+   if (thread == tracer.thread_count)
+   {
+      if (tracer.thread_count < MAX_TRACE_THREADS)
+         tracer.threads[tracer.thread_count++] = pthread_self();
+      else
+         thread = MAX_TRACE_THREADS - 1;
+   }
+
+   if (tracer.span_count < MAX_TRACE_SPANS)
+   {
+      p_span             = &tracer.spans[tracer.span_count++];
+      p_span->p_name     = p_name;
+      p_span->p_category = p_category;
+      p_span->start      = start - tracer.origin;
+      p_span->duration   = duration;
+      p_span->thread     = thread + 1;
+   }
+   else
+      tracer.dropped++;
+   pthread_mutex_unlock(&tracer.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*        Record the connection stages curl timed for a download      */
+/**********************************************************************/
+void trace_download(CURL *curl_handle, long long start)
+{
+   curl_off_t name_lookup = 0, /* Microseconds until the DNS answer   */
+              connect     = 0, /* Microseconds until TCP connected    */
+              app_connect = 0, /* Microseconds until TLS was done     */
+              pre_transfer = 0,/* Microseconds until the request went */
+              first_byte  = 0, /* Microseconds until the reply started*/
+              total       = 0; /* Microseconds for the whole transfer */
+
+   if (!tracer.enabled)
+      return;
+
+   curl_easy_getinfo(curl_handle, CURLINFO_NAMELOOKUP_TIME_T, &name_lookup);
+   curl_easy_getinfo(curl_handle, CURLINFO_CONNECT_TIME_T, &connect);
+   curl_easy_getinfo(curl_handle, CURLINFO_APPCONNECT_TIME_T, &app_connect);
+   curl_easy_getinfo(curl_handle, CURLINFO_PRETRANSFER_TIME_T,
+                     &pre_transfer);
+   curl_easy_getinfo(curl_handle, CURLINFO_STARTTRANSFER_TIME_T,
+                     &first_byte);
+   curl_easy_getinfo(curl_handle, CURLINFO_TOTAL_TIME_T, &total);
+
+   /* curl's times all count from the start of the transfer, and a    */
+   /* stage that was skipped, like TLS over http, stays at zero       */
+   trace_span("dns", "fetch", start, name_lookup);
+   if (connect >= name_lookup)
+      trace_span("connect", "fetch", start + name_lookup,
+                 connect - name_lookup);
+   if (app_connect >= connect)
+      trace_span("tls_handshake", "fetch", start + connect,
+                 app_connect - connect);
+   if (first_byte >= pre_transfer)
+      trace_span("wait_first_byte", "fetch", start + pre_transfer,
+                 first_byte - pre_transfer);
+   if (total >= first_byte)
+      trace_span("transfer", "fetch", start + first_byte,
+                 total - first_byte);
+
+   return;
+}
+
+/**********************************************************************/
+/*            Write the Chrome trace-event file and stop tracing      */
+/**********************************************************************/
+void trace_close()
+{
+   FILE       *p_trace_file; /* Chrome trace-event JSON file          */
+   TRACE_SPAN *p_span;       /* Span being written                    */
+   int        span_counter,  /* Count through each span               */
+              thread;        /* Count through each thread's track     */
+
+   if (!tracer.enabled)
+      return;
+
+   /* Workers still running check the flag under the lock, so none    */
+   /* adds a span while, or after, the spans are written and freed    */
+   pthread_mutex_lock(&tracer.lock);
+   tracer.enabled = 0;
+
+   /* Loads perfectly well in chrome://tracing and ui.perfetto.dev    */
+   p_trace_file = fopen(tracer.p_file_name, "w");
+   if (p_trace_file != NULL)
+   {
+      fprintf(p_trace_file, "{\"displayTimeUnit\":\"ms\",");
+      fprintf(p_trace_file, "\"otherData\":{\"dropped_spans\":%d},",
+              tracer.dropped);
+      fprintf(p_trace_file, "\"traceEvents\":[\n");
+      fprintf(p_trace_file,
+              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,"
+              "\"args\":{\"name\":\"ui\"}}");
+      for (thread = 1; thread < tracer.thread_count; thread++)
+         fprintf(p_trace_file,
+                 ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                 "\"tid\":%d,\"args\":{\"name\":\"worker %d\"}}",
+                 thread + 1, thread);
+      for (span_counter = 0; span_counter < tracer.span_count;
+           span_counter++)
+      {
+         p_span = &tracer.spans[span_counter];
+         fprintf(p_trace_file,
+                 ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+                 "\"ts\":%lld,\"dur\":%lld,\"pid\":1,\"tid\":%d}",
+                 p_span->p_name, p_span->p_category, p_span->start,
+                 p_span->duration, p_span->thread);
+      }
+      fprintf(p_trace_file, "\n]}\n");
+      fclose(p_trace_file);
+   }
+
+   /* The lock is kept, a worker may still be waiting on it           */
+   free(tracer.spans);
+   tracer.spans = NULL;
+   pthread_mutex_unlock(&tracer.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*   Turn metrics on if the flag or environment variable asks for it  */
+/**********************************************************************/
+void metrics_init(int argc, char *argv[])
+{
+   char *p_file_name = getenv(METRICS_ENV); /* Textfile asked for     */
+   int  arg_counter;                        /* Count through args     */
+
+   for (arg_counter = 1; arg_counter < argc - 1; arg_counter++)
+      if (strcmp(argv[arg_counter], METRICS_FLAG) == 0)
+         p_file_name = argv[++arg_counter];
+   if (p_file_name == NULL || p_file_name[0] == '\0' ||
+       strlen(p_file_name) + 5 > MAX_FILE_NAME)
+      return;
+
+   memset(&metrics, 0, sizeof(metrics));
+   metrics.p_file_name = p_file_name;
+   pthread_mutex_init(&metrics.lock, NULL);
+   metrics.enabled     = 1;
+
+   return;
+}
+
+/**********************************************************************/
+/*            Record how long a stage took since trace_begin()        */
+/**********************************************************************/
+void metrics_observe(int stage, long long start)
+{
+   HISTOGRAM *p_histogram = &metrics.stages[stage]; /* Stage's samples */
+   long long duration;                              /* Sample, in us   */
+
+   if (!metrics.enabled)
+      return;
+
+   duration = monotonic_us() - start;
+   if (duration < 0)
+      duration = 0;
+
+   pthread_mutex_lock(&metrics.lock);
+   p_histogram->counts[histogram_bucket(duration)]++;
+   p_histogram->count++;
+   p_histogram->sum += duration;
+   if (duration > p_histogram->max)
+      p_histogram->max = duration;
+   pthread_mutex_unlock(&metrics.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*                           Add one to a counter                     */
+/**********************************************************************/
+void metrics_count(int counter)
+{
+   if (!metrics.enabled)
+      return;
+
+   pthread_mutex_lock(&metrics.lock);
+   metrics.counters[counter]++;
+   pthread_mutex_unlock(&metrics.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*          Record a session arena's peak and allocations             */
+/**********************************************************************/
+void metrics_arena(ARENA *p_arena)
 {
-   int spin_counter,   /* Count wheel rotations                       */
-       spin_amount;    /* Random spin amount                          */
-   int start_row = HEADER_ROWS + 4;  /* Where wheel starts on screen  */
-   int start_col = 8;  /* Left margin                                 */
-   
-   srand(time(NULL));
-   spin_amount = game_count + rand() % ((game_count * 2) - game_count + 1);
+   if (!metrics.enabled || p_arena->allocation_count == 0)
+      return;
 
-   if ((*p_current_game) == NULL)
+   pthread_mutex_lock(&metrics.lock);
+   if ((long long) p_arena->peak_bytes > metrics.arena_peak_bytes)
+      metrics.arena_peak_bytes = (long long) p_arena->peak_bytes;
+   metrics.arena_allocations += p_arena->allocation_count;
+   pthread_mutex_unlock(&metrics.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*              Find the histogram bucket a sample falls in           */
+/**********************************************************************/
+int histogram_bucket(long long value)
+{
+   int sub_buckets = 1 << HISTOGRAM_SUB_BITS, /* Steps per power of 2 */
+       exponent    = HISTOGRAM_SUB_BITS,      /* Power of two of value*/
+       bucket;                                /* Bucket for the value */
+
+   /* Small values get a bucket each, larger ones are split into the  */
+   /* same number of steps per power of two, so error stays relative  */
+   if (value < sub_buckets)
+      return (int) value;
+   while ((value >> (exponent + 1)) != 0)
+      exponent++;
+   bucket = (exponent - HISTOGRAM_SUB_BITS + 1) * sub_buckets +
+            (int) ((value >> (exponent - HISTOGRAM_SUB_BITS)) &
+                   (sub_buckets - 1));
+   if (bucket >= HISTOGRAM_BUCKETS)
+      bucket = HISTOGRAM_BUCKETS - 1;
+
+   return bucket;
+}
+
+/**********************************************************************/
+/*               Largest sample a histogram bucket holds              */
+/**********************************************************************/
+long long histogram_bucket_limit(int bucket)
+{
+   int sub_buckets = 1 << HISTOGRAM_SUB_BITS, /* Steps per power of 2 */
+       exponent;                              /* Power of two of step */
+
+   if (bucket < sub_buckets)
+      return bucket;
+   exponent = bucket / sub_buckets - 1;
+
+   return ((long long) (sub_buckets + bucket % sub_buckets + 1) << exponent)
+          - 1;
+}
+
+/**********************************************************************/
+/*               Atomically rewrite the Prometheus textfile           */
+/**********************************************************************/
+void metrics_write()
+{
+   static const char *stage_names[STAGE_COUNT] =
+      {"fetch", "parse", "filter", "spin"};
+   static const char *counter_names[COUNTER_COUNT] =
+      {"wheel_downloads_total", "wheel_download_errors_total",
+       "wheel_cache_hits_total", "wheel_rerolls_total",
+       "wheel_node_alloc_errors_total"};
+   static const char *counter_helps[COUNTER_COUNT] =
+      {"Sheets downloaded.", "Sheet downloads that failed.",
+       "Loads served from local data instead of a download.",
+       "Games removed from the wheel to spin again.",
+       "Session memory that could not be allocated."};
+   FILE      *p_metrics_file;      /* Temporary textfile being written */
+   HISTOGRAM *p_histogram;         /* Stage being written              */
+   char      temp_name[MAX_FILE_NAME]; /* Written first, then renamed  */
+   long long cumulative;           /* Samples up to the current bucket */
+   int       stage,                /* Count through each stage         */
+             counter,              /* Count through each counter       */
+             bucket;               /* Count through each bucket        */
+
+   if (!metrics.enabled)
+      return;
+
+   /* The collector must never see half a file, so write a temporary  */
+   /* one next to it and rename it over the old one                   */
+   snprintf(temp_name, sizeof(temp_name), "%s.tmp", metrics.p_file_name);
+   p_metrics_file = fopen(temp_name, "w");
+   if (p_metrics_file == NULL)
+      return;
+
+   pthread_mutex_lock(&metrics.lock);
+   fprintf(p_metrics_file,
+           "# HELP wheel_stage_duration_seconds Time taken by each stage.\n"
+           "# TYPE wheel_stage_duration_seconds histogram\n");
+   for (stage = 0; stage < STAGE_COUNT; stage++)
    {
-      clear_screen();
-      mvprintw(15, 10, "No games in the list...");
-      refresh();
-      napms(2000);
-      exit(NO_LIST_ERR);
+      /* Every bucket is listed, empty or not, so each dump has the   */
+      /* same series and two dumps compare bucket for bucket          */
+      p_histogram = &metrics.stages[stage];
+      cumulative  = 0;
+      for (bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++)
+      {
+         cumulative += p_histogram->counts[bucket];
+         fprintf(p_metrics_file,
+                 "wheel_stage_duration_seconds_bucket"
+                 "{stage=\"%s\",le=\"%.6f\"} %lld\n",
+                 stage_names[stage],
+                 (histogram_bucket_limit(bucket) + 1) / 1000000.0,
+                 cumulative);
+      }
+      fprintf(p_metrics_file,
+              "wheel_stage_duration_seconds_bucket"
+              "{stage=\"%s\",le=\"+Inf\"} %lld\n"
+              "wheel_stage_duration_seconds_sum{stage=\"%s\"} %.6f\n"
+              "wheel_stage_duration_seconds_count{stage=\"%s\"} %lld\n",
+              stage_names[stage], p_histogram->count,
+              stage_names[stage], p_histogram->sum / 1000000.0,
+              stage_names[stage], p_histogram->count);
    }
 
-   clear_screen(); /* Clear ONCE at the start                         */
-   
-   /* Draw the wheel FRAME once (doesn't change)                      */
-   mvprintw(start_row,      start_col, "               .-------.");
-   mvprintw(start_row + 2,  start_col, "   ____________|_______|____________");
-   mvprintw(start_row + 3,  start_col, "  |  _      _     _____ _____ _     |");
-   mvprintw(start_row + 4,  start_col, "  | / \\  /|/ \\ /|/  __//  __// \\    |");
-   mvprintw(start_row + 5,  start_col, "  | | |  ||| |_|||  \\  |  \\  | |    |");
-   mvprintw(start_row + 6,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |    |");
-   mvprintw(start_row + 7,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |_/\\ |");
-   mvprintw(start_row + 8,  start_col, "  | \\_/  \\|\\_/ \\|\\_____\\_____\\____/ |");
-   mvprintw(start_row + 9,  start_col, "  |===_______===_______===_______===|");
-   mvprintw(start_row + 10, start_col, "  ||*|                           |*||");
-   mvprintw(start_row + 11, start_col, "  ||*|                           |*||");  /* Game 1 here */
-   mvprintw(start_row + 12, start_col, "  ||*|___________________________|*||");
-   mvprintw(start_row + 13, start_col, "  |===_______===_______===_______===|");
-   mvprintw(start_row + 14, start_col, "  ||*|\\                          |*||");
-   mvprintw(start_row + 15, start_col, "  ||*| >                         |*||");  /* Game 2 (selected) */
-   mvprintw(start_row + 16, start_col, "  ||*|/__________________________|*||_");
-   mvprintw(start_row + 17, start_col, "  |===_______===_______===_______===|_\\");
-   mvprintw(start_row + 18, start_col, "  ||*|                           |*|| \\\\");
-   mvprintw(start_row + 19, start_col, "  ||*|                           |*||  ||");  /* Game 3 here */
-   mvprintw(start_row + 20, start_col, "  ||*|___________________________|*||  ||");
-   mvprintw(start_row + 21, start_col, "  |===___________________________===|  ||");
-   mvprintw(start_row + 22, start_col, "  |  /___________________________\\  | (__)");
-   mvprintw(start_row + 23, start_col, "  |   |                         |   |");
-   mvprintw(start_row + 24, start_col, " _|    \\_______________________/    |_");
-   mvprintw(start_row + 25, start_col, "(_____________________________________)");
-   
-   /* Now animate by ONLY updating the changing parts                 */
-   for (spin_counter = 0; spin_counter < spin_amount; spin_counter++)
-   { 
-      (*p_current_game) = (*p_current_game)->p_next_game;
-      
-      /* Update ONLY the counter (top of wheel)                       */
-      move(start_row + 1, start_col + 15);
-      clrtoeol();  /* Clear old number                                */
-      printw("|  %3d  |", spin_counter);
-      
-      /* Update ONLY game 1 name (previous game)                      */
-      move(start_row + 11, start_col + 10);
-      clrtoeol();
-      printw("%20s   |*||", (*p_current_game)->game_name);
-      
-      /* Update ONLY game 2 name (current/selected game with arrow)   */
-      move(start_row + 15, start_col + 10);
-      clrtoeol();
-      printw("  %20s |*||", (*p_current_game)->p_next_game->game_name);
-      
-      /* Update ONLY game 3 name (next game)                          */
-      move(start_row + 19, start_col + 10);
-      clrtoeol();
-      printw("%20s   |*||  ||", 
-             (*p_current_game)->p_next_game->p_next_game->game_name);
-      
-      refresh();       /* Show the updates                             */
-      napms(50);       /* 50ms delay = smoother (adjust to taste)      */
+   fprintf(p_metrics_file,
+           "# HELP wheel_stage_duration_max_seconds Slowest run of each "
+           "stage.\n"
+           "# TYPE wheel_stage_duration_max_seconds gauge\n");
+   for (stage = 0; stage < STAGE_COUNT; stage++)
+      fprintf(p_metrics_file,
+              "wheel_stage_duration_max_seconds{stage=\"%s\"} %.6f\n",
+              stage_names[stage], metrics.stages[stage].max / 1000000.0);
+
+   for (counter = 0; counter < COUNTER_COUNT; counter++)
+      fprintf(p_metrics_file, "# HELP %s %s\n# TYPE %s counter\n%s %lld\n",
+              counter_names[counter], counter_helps[counter],
+              counter_names[counter], counter_names[counter],
+              metrics.counters[counter]);
+
+   fprintf(p_metrics_file,
+           "# HELP wheel_session_peak_bytes Most memory one session's "
+           "arena handed out.\n"
+           "# TYPE wheel_session_peak_bytes gauge\n"
+           "wheel_session_peak_bytes %lld\n"
+           "# HELP wheel_session_allocations_total Allocations made from "
+           "session arenas.\n"
+           "# TYPE wheel_session_allocations_total counter\n"
+           "wheel_session_allocations_total %lld\n",
+           metrics.arena_peak_bytes, metrics.arena_allocations);
+   pthread_mutex_unlock(&metrics.lock);
+
+   if (fclose(p_metrics_file) != 0)
+   {
+      remove(temp_name);
+      return;
    }
-   
+#ifdef _WIN32
+   MoveFileExA(temp_name, metrics.p_file_name, MOVEFILE_REPLACE_EXISTING);
+#else
+   rename(temp_name, metrics.p_file_name);
+#endif
+
+   return;
+}
+
+/**********************************************************************/
+/*           Write the metrics one last time and stop recording       */
+/**********************************************************************/
+void metrics_close()
+{
+   if (!metrics.enabled)
+      return;
+
+   metrics_write();
+   metrics.enabled = 0;
+   pthread_mutex_destroy(&metrics.lock);
+
+   return;
+}
+
+/**********************************************************************/
+/*   Open the spin journal, checking only what follows its checkpoint */
+/**********************************************************************/
+void history_open(int argc, char *argv[])
+{
+   MAPPED_FILE       journal;    /* Journal mapped for checking        */
+   const SPIN_RECORD *p_records; /* Records in the journal             */
+   SPIN_RECORD       header;     /* First record, naming the format    */
+   long              length;     /* Bytes in the journal               */
+   long long         count,      /* Whole records in the journal       */
+                     record,     /* Count through each record          */
+                     start = 0;  /* Last good checkpoint, or header    */
+   int               arg_counter;/* Count through arguments            */
+
+   memset(&history, 0, sizeof(history));
+   history.block_hash = ROW_HASH_BASIS;
+
+   /* "--cooldown N" keeps a party's last N picks off its wheel       */
+   for (arg_counter = 1; arg_counter < argc; arg_counter++)
+      if (strcmp(argv[arg_counter], COOLDOWN_FLAG) == 0 &&
+          arg_counter + 1 < argc)
+         history.cooldown = atoi(argv[++arg_counter]);
+   if (history.cooldown < 0)
+      history.cooldown = 0;
+   if (history.cooldown > MAX_COOLDOWN)
+      history.cooldown = MAX_COOLDOWN;
+
+   /* A replay's spins already happened, so they are not written again*/
+   if (session.mode == SESSION_REPLAY)
+      return;
+
+   history.p_file = fopen(HISTORY_FILE, "r+b");
+   if (history.p_file == NULL)
+      history.p_file = fopen(HISTORY_FILE, "w+b");
+   if (history.p_file == NULL ||
+       fseek(history.p_file, 0, SEEK_END) != 0 ||
+       (length = ftell(history.p_file)) < 0)
+   {
+      history_close();
+      return;
+   }
+
+   /* A new journal starts with a header record naming its format     */
+   if ((size_t) length < sizeof(SPIN_RECORD))
+   {
+      memset(&header, 0, sizeof(header));
+      header.type      = RECORD_HEADER;
+      header.party     = sizeof(SPIN_RECORD);
+      strcpy(header.game_name, HISTORY_MAGIC);
+      history_append(&header);
+      return;
+   }
+
+   if (!map_file(HISTORY_FILE, &journal))
+   {
+      history_close();
+      return;
+   }
+   p_records = (const SPIN_RECORD *) journal.p_data;
+   count     = (long long) (journal.length / sizeof(SPIN_RECORD));
+   /* A full name field has no zero at the end, so the magic is only  */
+   /* compared as far as the field goes                               */
+   if (count == 0 || p_records[0].type != RECORD_HEADER ||
+       p_records[0].party != sizeof(SPIN_RECORD) ||
+       strncmp(p_records[0].game_name, HISTORY_MAGIC,
+               sizeof(p_records[0].game_name)) != 0)
+   {
+      unmap_file(&journal);
+      history_close(); /* Not a journal this program wrote            */
+      return;
+   }
+
+   /* Everything before a good checkpoint was checked when it was     */
+   /* written, so opening years of spins only reads the last few      */
+   for (record = count - 1; record > 0; record--)
+      if (p_records[record].type == RECORD_CHECKPOINT &&
+          history_block_ok(p_records, record))
+      {
+         start = record;
+         break;
+      }
+
+   /* A crash can only have left a torn or empty record at the end,   */
+   /* which the next spin writes over                                 */
+   for (record = start + 1;
+        record < count && p_records[record].type == RECORD_SPIN &&
+        history.block_count < HISTORY_CHECKPOINT;
+        record++)
+   {
+      history.block_hash = hash_bytes(history.block_hash, &p_records[record],
+                                      sizeof(SPIN_RECORD));
+      history.block_count++;
+   }
+   history.record_count = record;
+   unmap_file(&journal);
+
+   if (history.block_count == HISTORY_CHECKPOINT)
+      history_checkpoint();
+
+   return;
+}
+
+/**********************************************************************/
+/*                       Close the spin journal                       */
+/**********************************************************************/
+void history_close()
+{
+   if (history.p_file != NULL)
+      fclose(history.p_file);
+   history.p_file = NULL;
+
+   return;
+}
+
+/**********************************************************************/
+/*                      Append a spin to the journal                  */
+/**********************************************************************/
+void history_record_spin(ROSTER     *p_roster,
+                         int        eligible_count,
+                         const char *p_game_name,
+                         int        rerolled)
+{
+   SPIN_RECORD record;     /* Spin being written                      */
+   int         party_size; /* Players in the party                    */
+
+   if (history.p_file == NULL)
+      return;
+
+   memset(&record, 0, sizeof(record));
+   record.spin_time      = (long long) time(NULL);
+   record.party          = history_party(p_roster, &party_size);
+   record.game           = hash_bytes(ROW_HASH_BASIS, p_game_name,
+                                      strlen(p_game_name));
+   record.eligible_count = eligible_count;
+   record.party_size     = (unsigned short) party_size;
+   record.type           = RECORD_SPIN;
+   record.rerolled       = (unsigned char) rerolled;
+   strncpy(record.game_name, p_game_name, sizeof(record.game_name));
+   if (!history_append(&record))
+      return;
+
+   history.block_hash = hash_bytes(history.block_hash, &record,
+                                   sizeof(record));
+   if (++history.block_count == HISTORY_CHECKPOINT)
+      history_checkpoint();
+
+   return;
+}
+
+/**********************************************************************/
+/*      Close a block of spins with their count and checksum          */
+/**********************************************************************/
+void history_checkpoint()
+{
+   SPIN_RECORD record; /* Checkpoint being written                    */
+
+   memset(&record, 0, sizeof(record));
+   record.spin_time      = (long long) time(NULL);
+   record.party          = (unsigned long long) history.record_count;
+   record.game           = history.block_hash;
+   record.eligible_count = HISTORY_CHECKPOINT;
+   record.type           = RECORD_CHECKPOINT;
+   if (history_append(&record))
+   {
+      history.block_hash  = ROW_HASH_BASIS;
+      history.block_count = 0;
+   }
+
+   return;
+}
+
+/**********************************************************************/
+/*               Write a record at the end of the journal             */
+/**********************************************************************/
+int history_append(SPIN_RECORD *p_record)
+{
+   /* Writes go to the last good record, not the end of the file,     */
+   /* so anything a crash left behind is overwritten                  */
+   if (fseek(history.p_file,
+             (long) (history.record_count * sizeof(SPIN_RECORD)),
+             SEEK_SET) != 0 ||
+       fwrite(p_record, sizeof(SPIN_RECORD), 1, history.p_file) != 1 ||
+       fflush(history.p_file) != 0)
+   {
+      post_status("Error: Cannot write to %s", HISTORY_FILE);
+      history_close();
+      return 0;
+   }
+   history.record_count++;
+
+   return 1;
+}
+
+/**********************************************************************/
+/*            Check a checkpoint against the spins it closes          */
+/**********************************************************************/
+int history_block_ok(const SPIN_RECORD *p_records, long long checkpoint)
+{
+   unsigned long long hash = ROW_HASH_BASIS; /* Checksum of the block */
+   long long          record;                /* Count through spins   */
+
+   if (checkpoint <= HISTORY_CHECKPOINT ||
+       p_records[checkpoint].party != (unsigned long long) checkpoint)
+      return 0;
+
+   for (record = checkpoint - HISTORY_CHECKPOINT;
+        record < checkpoint;
+        record++)
+   {
+      if (p_records[record].type != RECORD_SPIN)
+         return 0;
+      hash = hash_bytes(hash, &p_records[record], sizeof(SPIN_RECORD));
+   }
+
+   return hash == p_records[checkpoint].game;
+}
+
+/**********************************************************************/
+/*          Hash the party's names, the same in any order             */
+/**********************************************************************/
+unsigned long long history_party(ROSTER *p_roster, int *p_party_size)
+{
+   unsigned long long party = 0; /* Sum of each member's name hash    */
+   int                player_counter; /* Count through players        */
+
+   *p_party_size = 0;
+   for (player_counter = 0;
+        player_counter < p_roster->amount_of_players;
+        player_counter++)
+      if (p_roster->player_list[player_counter].party_status == 1)
+      {
+         party += hash_bytes(ROW_HASH_BASIS,
+                     p_roster->player_list[player_counter].player_name,
+                     strlen(p_roster->player_list[player_counter].player_name));
+         (*p_party_size)++;
+      }
+
+   return party;
+}
+
+/**********************************************************************/
+/*         Find the games picked most since a point in time           */
+/**********************************************************************/
+int history_top_games(long long since, HISTORY_TOP top[], int max_top)
+{
+   MAPPED_FILE       journal;     /* Journal mapped for the query      */
+   const SPIN_RECORD *p_records;  /* Records in the journal            */
+   struct
+   {
+      unsigned long long game;    /* Hash of the game's name           */
+      int                picks,   /* Times it was kept                 */
+                         record;  /* Last spin that picked it          */
+   }                 *p_counts;   /* Picks of each game, by hash       */
+   unsigned int      table_mask,  /* Table size less one               */
+                     slot;        /* Slot being checked                */
+   long long         low,         /* First record that may be in range */
+                     high,        /* One past the last it may be       */
+                     middle,      /* Record being compared             */
+                     count,       /* Good records in the journal       */
+                     record;      /* Count through each record         */
+   int               top_count = 0, /* Games found so far              */
+                     best;        /* Slot with the most picks left     */
+   long long         start = trace_begin(); /* When the query started  */
+
+   if (history.p_file == NULL || !map_file(HISTORY_FILE, &journal))
+      return 0;
+   p_records = (const SPIN_RECORD *) journal.p_data;
+   count     = (long long) (journal.length / sizeof(SPIN_RECORD));
+   if (count > history.record_count)
+      count = history.record_count;
+
+   /* Records are written in time order, so the first one in range    */
+   /* is found by binary search and only the range itself is read     */
+   low  = 1;
+   high = count;
+   while (low < high)
+   {
+      middle = low + (high - low) / 2;
+      if (p_records[middle].spin_time < since)
+         low = middle + 1;
+      else
+         high = middle;
+   }
+
+   for (table_mask = 15; table_mask < 2 * (count - low); table_mask =
+        table_mask * 2 + 1)
+      ;
+   p_counts = calloc(table_mask + 1, sizeof(*p_counts));
+   if (p_counts == NULL)
+   {
+      unmap_file(&journal);
+      return 0;
+   }
+
+   /* Rerolled games were sent back, so only kept picks count         */
+   for (record = low; record < count; record++)
+      if (p_records[record].type == RECORD_SPIN &&
+          !p_records[record].rerolled)
+      {
+         slot = (unsigned int) p_records[record].game & table_mask;
+         while (p_counts[slot].picks > 0 &&
+                p_counts[slot].game != p_records[record].game)
+            slot = (slot + 1) & table_mask;
+         p_counts[slot].game   = p_records[record].game;
+         p_counts[slot].record = (int) record;
+         p_counts[slot].picks++;
+      }
+
+   /* Take the most picked game out of the table until there are      */
+   /* enough of them                                                  */
+   while (top_count < max_top)
+   {
+      best = -1;
+      for (slot = 0; slot <= table_mask; slot++)
+         if (p_counts[slot].picks > 0 &&
+             (best < 0 || p_counts[slot].picks > p_counts[best].picks))
+            best = (int) slot;
+      if (best < 0)
+         break;
+      snprintf(top[top_count].game_name, MAX_GAME_NAME, "%.*s",
+               (int) sizeof(p_records->game_name),
+               p_records[p_counts[best].record].game_name);
+      top[top_count++].picks = p_counts[best].picks;
+      p_counts[best].picks = 0;
+   }
+
+   free(p_counts);
+   unmap_file(&journal);
+   trace_end("history_top_games", "history", start);
+
+   return top_count;
+}
+
+/**********************************************************************/
+/*     Find when a party, or anyone when party is 0, last kept a game */
+/**********************************************************************/
+long long history_last_played(unsigned long long party,
+                              const char         *p_game_name)
+{
+   MAPPED_FILE        journal;    /* Journal mapped for the query      */
+   const SPIN_RECORD  *p_records; /* Records in the journal            */
+   unsigned long long game;       /* Hash of the game's name           */
+   long long          record,     /* Count back through each record    */
+                      last_played = 0; /* When it was last kept        */
+   long long          start = trace_begin(); /* When the query started */
+
+   if (history.p_file == NULL || !map_file(HISTORY_FILE, &journal))
+      return 0;
+   p_records = (const SPIN_RECORD *) journal.p_data;
+   record    = (long long) (journal.length / sizeof(SPIN_RECORD));
+   if (record > history.record_count)
+      record = history.record_count;
+   game = hash_bytes(ROW_HASH_BASIS, p_game_name, strlen(p_game_name));
+
+   /* Newest first, comparing two hashes a record, stops at the most  */
+   /* recent match                                                    */
+   while (--record > 0)
+      if (p_records[record].game == game &&
+          p_records[record].type == RECORD_SPIN &&
+          !p_records[record].rerolled &&
+          (party == 0 || p_records[record].party == party))
+      {
+         last_played = p_records[record].spin_time;
+         break;
+      }
+
+   unmap_file(&journal);
+   trace_end("history_last_played", "history", start);
+
+   return last_played;
+}
+
+/**********************************************************************/
+/*       Find the games a party kept in its last few sessions         */
+/**********************************************************************/
+void history_recent_picks(unsigned long long party,
+                          RECENT_PICKS       *p_recent)
+{
+   MAPPED_FILE        journal;    /* Journal mapped for the query      */
+   const SPIN_RECORD  *p_records; /* Records in the journal            */
+   unsigned int       slot;       /* Slot being checked                */
+   long long          record;     /* Count back through each record    */
+   long long          start = trace_begin(); /* When the query started */
+
+   memset(p_recent, 0, sizeof(*p_recent));
+   if (history.cooldown == 0 || history.p_file == NULL ||
+       !map_file(HISTORY_FILE, &journal))
+      return;
+   p_records = (const SPIN_RECORD *) journal.p_data;
+   record    = (long long) (journal.length / sizeof(SPIN_RECORD));
+   if (record > history.record_count)
+      record = history.record_count;
+
+   /* A session ends on the one game the party kept, so its last few  */
+   /* kept games are its last few sessions                            */
+   while (--record > 0 && p_recent->session_count < history.cooldown)
+      if (p_records[record].party == party &&
+          p_records[record].type == RECORD_SPIN &&
+          !p_records[record].rerolled)
+      {
+         slot = (unsigned int) p_records[record].game &
+                (COOLDOWN_SLOTS - 1);
+         while (p_recent->games[slot] != 0 &&
+                p_recent->games[slot] != p_records[record].game)
+            slot = (slot + 1) & (COOLDOWN_SLOTS - 1);
+         p_recent->games[slot] = p_records[record].game;
+         p_recent->session_count++;
+      }
+
+   unmap_file(&journal);
+   trace_end("history_recent_picks", "history", start);
+
    return;
 }
 
 /**********************************************************************/
-/*               Print the selected game from the wheel               */
+/*      Check if the party kept a game in its last few sessions       */
+/**********************************************************************/
+int recently_picked(RECENT_PICKS *p_recent, const char *p_game_name)
+{
+   unsigned long long game; /* Hash of the game's name                */
+   unsigned int       slot; /* Slot being checked                     */
+
+   game = hash_bytes(ROW_HASH_BASIS, p_game_name, strlen(p_game_name));
+   for (slot = (unsigned int) game & (COOLDOWN_SLOTS - 1);
+        p_recent->games[slot] != 0;
+        slot = (slot + 1) & (COOLDOWN_SLOTS - 1))
+      if (p_recent->games[slot] == game)
+         return 1;
+
+   return 0;
+}
+
+/**********************************************************************/
+/*             When the current month started, in seconds            */
 /**********************************************************************/
-void selected_game(char previous_game[MAX_GAME_NAME],
-                   char selected_game[MAX_GAME_NAME],
-                   char next_game[MAX_GAME_NAME],
-                   int  game_count)
+long long month_start()
 {
-   int start_row = HEADER_ROWS + 4;  /* Where wheel starts on screen  */
-   int start_col = 8;  /* Left margin                                 */
-   
-   clear_screen();  /* Clear screen for final display                 */
-   
-   /* Draw the complete wheel with final selection                    */
-   mvprintw(start_row,      start_col, "               .-------.");
-   mvprintw(start_row + 1,  start_col, "               |  %3d  |", game_count);
-   mvprintw(start_row + 2,  start_col, "   ____________|_______|____________");
-   mvprintw(start_row + 3,  start_col, "  |  _      _     _____ _____ _     |");
-   mvprintw(start_row + 4,  start_col, "  | / \\  /|/ \\ /|/  __//  __// \\    |");
-   mvprintw(start_row + 5,  start_col, "  | | |  ||| |_|||  \\  |  \\  | |    |");
-   mvprintw(start_row + 6,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |    |");
-   mvprintw(start_row + 7,  start_col, "  | | |/\\||| | |||  /_ |  /_ | |_/\\ |");
-   mvprintw(start_row + 8,  start_col, "  | \\_/  \\|\\_/ \\|\\_____\\_____\\____/ |");
-   mvprintw(start_row + 9,  start_col, "  |===_______===_______===_______===|");
-   mvprintw(start_row + 10, start_col, "  ||*|                           |*||");
-   mvprintw(start_row + 11, start_col, "  ||*|       %20s|*||  __", previous_game);
-   mvprintw(start_row + 12, start_col, "  ||*|___________________________|*|| (  )");
-   mvprintw(start_row + 13, start_col, "  |===_______===_______===_______===|  ||");
-   mvprintw(start_row + 14, start_col, "  ||*|\\                          |*||  ||");
-   mvprintw(start_row + 15, start_col, "  ||*| >     %20s|*||  ||", selected_game);
-   mvprintw(start_row + 16, start_col, "  ||*|/__________________________|*||_//");
-   mvprintw(start_row + 17, start_col, "  |===_______===_______===_______===|_/");
-   mvprintw(start_row + 18, start_col, "  ||*|                           |*||");
-   mvprintw(start_row + 19, start_col, "  ||*|       %20s|*||", next_game);
-   mvprintw(start_row + 20, start_col, "  ||*|___________________________|*||");
-   mvprintw(start_row + 21, start_col, "  |===___________________________===|");
-   mvprintw(start_row + 22, start_col, "  |  /___________________________\\  |");
-   mvprintw(start_row + 23, start_col, "  |   |     %20s|   |", selected_game);
-   mvprintw(start_row + 24, start_col, " _|    \\_______________________/    |_");
-   mvprintw(start_row + 25, start_col, "(_____________________________________)");
-   
-   refresh();  /* Display it all                                      */
+   time_t    now = time(NULL); /* Current time                        */
+   struct tm *p_date;          /* Today's date                        */
 
-   return;
+   p_date = localtime(&now);
+   p_date->tm_mday  = 1;
+   p_date->tm_hour  = 0;
+   p_date->tm_min   = 0;
+   p_date->tm_sec   = 0;
+   p_date->tm_isdst = -1;
+
+   return (long long) mktime(p_date);
 }
 
 /**********************************************************************/
-/*                     Clear screen below header                      */
+/*                 Print this month's most picked games               */
 /**********************************************************************/
-void clear_screen()
+void print_top_games(HISTORY_TOP top[], int top_count, int row)
 {
-   int row = HEADER_ROWS;
+   int top_counter; /* Count through each game                        */
+
+   move(row, 0);
+   clrtoeol();
+   if (top_count == 0)
+      return;
 
-   while (row < 67)
+   /* Stop at the edge of the window instead of wrapping              */
+   printw("Most picked this month:");
+   for (top_counter = 0; top_counter < top_count; top_counter++)
    {
-      move(row, 0);
-      clrtoeol();
-      row++;
+      if (getcurx(stdscr) + (int) strlen(top[top_counter].game_name) + 12 >=
+          COLS)
+      {
+         printw(" ...");
+         break;
+      }
+      printw("%s %s (%d)", top_counter > 0 ? "," : "",
+             top[top_counter].game_name, top[top_counter].picks);
    }
 
    return;
 }
 
 /**********************************************************************/
-/*                        Load data from file                         */
+/*                 Map a whole file into memory to read               */
 /**********************************************************************/
-void remove_game(WHEEL *p_game)
+int map_file(const char *file_name, MAPPED_FILE *p_map)
 {
-   WHEEL *p_temp_game; /* Temporary placeholder for freeing           */
+#ifdef _WIN32
+   LARGE_INTEGER size; /* Bytes in the file                           */
 
-   if (p_game != NULL && p_game != p_game->p_next_game) 
+   memset(p_map, 0, sizeof(*p_map));
+   p_map->file = CreateFileA(file_name, GENERIC_READ,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+   if (p_map->file == INVALID_HANDLE_VALUE)
+      return 0;
+   if (!GetFileSizeEx(p_map->file, &size) || size.QuadPart == 0 ||
+       (p_map->mapping = CreateFileMappingA(p_map->file, NULL, PAGE_READONLY,
+                                            0, 0, NULL)) == NULL)
    {
-      p_temp_game         = p_game->p_next_game;
-      p_game->p_next_game = p_game->p_next_game->p_next_game;
-      free(p_temp_game);
+      CloseHandle(p_map->file);
+      return 0;
+   }
+   p_map->p_data = MapViewOfFile(p_map->mapping, FILE_MAP_READ, 0, 0, 0);
+   if (p_map->p_data == NULL)
+   {
+      CloseHandle(p_map->mapping);
+      CloseHandle(p_map->file);
+      return 0;
    }
+   p_map->length = (size_t) size.QuadPart;
+#else
+   struct stat status; /* Size of the file                            */
 
-   return;
+   memset(p_map, 0, sizeof(*p_map));
+   p_map->file = open(file_name, O_RDONLY);
+   if (p_map->file < 0)
+      return 0;
+   if (fstat(p_map->file, &status) != 0 || status.st_size == 0 ||
+       (p_map->p_data = mmap(NULL, (size_t) status.st_size, PROT_READ,
+                             MAP_PRIVATE, p_map->file, 0)) == MAP_FAILED)
+   {
+      close(p_map->file);
+      return 0;
+   }
+   p_map->length = (size_t) status.st_size;
+#endif
+
+   return 1;
 }
 
 /**********************************************************************/
-/*                        Load data from file                         */
+/*                     Unmap a file mapped to read                    */
 /**********************************************************************/
-void reset(PLAYER player_list[MAX_PLAYERS], 
-           WHEEL  **p_wheel_list, 
-           int    amount_of_games, 
-           int    amount_of_players, 
-           int    *p_party_count,
-           char   *p_remove_game_check)
+void unmap_file(MAPPED_FILE *p_map)
 {
-   int player_counter;  /* Count through each player in it's list      */
- WHEEL *p_current_game, /* Point to each game in the list              */
-       *p_temp_game;    /* Temporary placeholder for freeing           */
+#ifdef _WIN32
+   UnmapViewOfFile(p_map->p_data);
+   CloseHandle(p_map->mapping);
+   CloseHandle(p_map->file);
+#else
+   munmap((void *) p_map->p_data, p_map->length);
+   close(p_map->file);
+#endif
+   memset(p_map, 0, sizeof(*p_map));
 
-   for (player_counter =  0; 
-        player_counter < amount_of_players; 
-        player_counter++)
-      player_list[player_counter].party_status = 0;
+   return;
+}
 
-   if (p_wheel_list != NULL && *p_wheel_list != NULL)
-   {
-      p_current_game = (*p_wheel_list)->p_next_game;
+/**********************************************************************/
+/*     Start recording or replaying a session if a flag asks for it   */
+/**********************************************************************/
+void session_init(int argc, char *argv[])
+{
+   char magic[FORMAT_LEN]; /* First word of a session file            */
+   int  arg_counter;       /* Count through arguments                 */
 
-      while (p_current_game != (*p_wheel_list)) 
+   memset(&session, 0, sizeof(session));
+   for (arg_counter = 1; arg_counter + 1 < argc; arg_counter++)
+      if (strcmp(argv[arg_counter], RECORD_FLAG) == 0)
       {
-         p_temp_game    = p_current_game;
-         p_current_game = p_current_game->p_next_game;
-         free(p_temp_game);
+         session.p_file_name = argv[++arg_counter];
+         session.mode        = SESSION_RECORD;
       }
-      free((*p_wheel_list));
-      (*p_wheel_list) = NULL; 
-   }
+      else if (strcmp(argv[arg_counter], REPLAY_FLAG) == 0)
+      {
+         session.p_file_name = argv[++arg_counter];
+         session.mode        = SESSION_REPLAY;
+      }
+   if (session.mode == SESSION_OFF)
+      return;
 
-   *p_party_count       = 0;
-   *p_remove_game_check = 'y';
+   session.p_file = fopen(session.p_file_name,
+                          session.mode == SESSION_RECORD ? "w" : "r");
+   if (session.p_file == NULL ||
+       (session.mode == SESSION_RECORD &&
+        fprintf(session.p_file, "%s\n", SESSION_MAGIC) < 0) ||
+       (session.mode == SESSION_REPLAY &&
+        (fscanf(session.p_file, "%31s", magic) != 1 ||
+         strcmp(magic, SESSION_MAGIC) != 0)))
+   {
+      printf("\nError #%d occurred in session_init.", SESSION_ERR);
+      printf("\n%s is not a session that can be %s.", session.p_file_name,
+             session.mode == SESSION_RECORD ? "written" : "replayed");
+      printf("\nThe program is aborting\n\n");
+      exit  (SESSION_ERR);
+   }
+   session.start = monotonic_us();
 
    return;
 }
 
 /**********************************************************************/
-/*                         Load data manually                         */
+/*      Finish the session, returning the program's exit code         */
 /**********************************************************************/
-void load_data_manual(GAME   game_list[MAX_GAMES],
-                      PLAYER player_list[MAX_PLAYERS],
-                      int    *p_amount_of_games, 
-                      int    *p_amount_of_players)
+int session_close()
 {
-   int  player_counter, /* Count through each player                  */
-        game_counter;   /* Count through each game                    */
-   char *token,         /* Pointer for tokenized strings              */
-        line1[7],
-        line2[MAX_PLAYER_NAME * MAX_PLAYERS],
-        line3[(5 + MAX_GAME_NAME + MAX_PLAYERS) * MAX_GAMES];
+   int exit_code = 0; /* Code the program ends with                   */
 
-   /* Initialize hardcoded lines                                      */
-   strcpy(line1, "6 47");
-   strcpy(line2, "Cavey Deeswa Goater Dudwen Deft Zyn             ");
-   strcpy(line3, "0 Abort ynndnn 0 Among_Us nnnynn 4 Apex dnnynn 0 Ark dnnynn 4 Astroneer ynnynn 0 Bluestacks ynnynn 4 Brawlhalla nnnynn 0 Business_Tour ynnynn 0 Crab_Gey ynnynn 0 Cuminme ynnynn 0 Darza ynnynn 0 Destiny_2 nnndnn 0 Diep ynnynn 0 Drunk_Wrest_2 ynnynn 0 E_Od_Oder ynndnn 2 FPS_Chess ynnynn 0 Garrys_Mod ynnynn 4 Godspeed ynnynn 4 Grabity ynnynn 5 Ight dnnynn 0 Itchi ynnynn 5 Leg ynnynn 0 Lethal nnnynn 6 Marvel_Rivals ynnynn 0 Maunt ynnynn 0 Meager ynnynn 0 Mince ynnynn 0 Moomoo ynnnnn 0 Mope ynnnnn 8 Muck ynnynn 0 One_Arm_Robber ynnynn 0 Osu ynnynn 6 Overwatch dnnnnn 0 Party_Games ynnynn 0 Pixel_Gun ynnynn 4 PP ynnynn 5 R6 ynnynn 4 Rain_world ynnynn 5 Ranch ynnynn 0 Roblox ynnynn 0 Rounds ynnynn 0 Shellshock ynnynn 0 Spacewar ynndnn 0 Splitgate ynnynn 0 Terererer ynnynn 4 UCH ynnynn 0 Wargey ynnnnn                                                                                                                     ");
-
-   /* Parse line 1 for number of games and players                    */
-   sscanf(line1, "%d %d", p_amount_of_players, p_amount_of_games);
+   if (session.mode == SESSION_OFF)
+      return 0;
 
-   /* Parse line 2 for player names                                   */
-   token = strtok(line2, " ");
-   for (player_counter = 0; 
-        player_counter < *p_amount_of_players && token != NULL; 
-        player_counter++) 
+   if (session.mode == SESSION_REPLAY)
    {
-      strcpy(player_list[player_counter].player_name, token);
-      token = strtok(NULL, " ");
+      printf("\nReplayed %d pick%s from %s in %lld ms, %d differed\n",
+             session.pick_count, session.pick_count == 1 ? "" : "s",
+             session.p_file_name,
+             (monotonic_us() - session.start) / 1000,
+             session.mismatch_count);
+      if (session.mismatch_count > 0)
+         exit_code = REPLAY_DIFF_ERR;
    }
+   fclose(session.p_file);
+   if (session.p_screen != NULL)
+      fclose(session.p_screen);
+   session.mode = SESSION_OFF;
 
-   /* Parse line 3 for game data                                      */
-   token = strtok(line3, " ");
-   for (game_counter = 0; 
-        game_counter < *p_amount_of_games && token != NULL; 
-        game_counter++) 
-   {
-      /* Get the player_limit for the game                            */
-      game_list[game_counter].player_limit = atoi(token);
+   return exit_code;
+}
 
-      /* Get the name of the game                                     */
-      token = strtok(NULL, " ");
-      strcpy(game_list[game_counter].game_name, token);
+/**********************************************************************/
+/*         Stop a replay that no longer follows its recording         */
+/**********************************************************************/
+void session_fail(const char *p_reason)
+{
+   endwin();  /* End ncurses before error message                     */
+   printf("\nError #%d occurred replaying %s.", SESSION_ERR,
+          session.p_file_name);
+   printf("\n%s after %d pick%s.", p_reason, session.pick_count,
+          session.pick_count == 1 ? "" : "s");
+   printf("\nThe program is aborting\n\n");
+   exit  (SESSION_ERR);
+}
 
-      /* Get the players' game status for that game                   */
-      token = strtok(NULL, " ");
-      strcpy(game_list[game_counter].game_status, token);
+/**********************************************************************/
+/*     Read the kind of the next entry of a replay, which must match  */
+/**********************************************************************/
+void session_expect(char type)
+{
+   char found; /* Kind of entry read                                  */
 
-      /* Move to the next game                                        */
-      token = strtok(NULL, " ");
-   }
-   
-   /* Display completion message                                      */
-   mvprintw(3, 0, "Manual data loaded successfully!");
-   refresh();
+   if (fscanf(session.p_file, " %c", &found) != 1)
+      session_fail("The recording ended early");
+   if (found != type)
+      session_fail("The replay went off course");
 
    return;
 }
 
 /**********************************************************************/
-/*                    Clear the data in CSV file                      */
+/*    Save the screen size, or bring back the one saved, for a replay */
 /**********************************************************************/
-void clear_csv()
+void session_screen()
 {
-   FILE *p_csv_file;   /* Pointer to CSV file                        */
-   
-   /* Open file in write mode (truncates/empties the file)            */
-   p_csv_file = fopen(CSV_FILE, "w");
-   fclose(p_csv_file);
-   
+   int lines,   /* Rows the recording had                             */
+       columns; /* Columns the recording had                          */
+
+   if (session.mode == SESSION_RECORD)
+   {
+      fprintf(session.p_file, "W %d %d\n", LINES, COLS);
+      fflush(session.p_file);
+   }
+   else if (session.mode == SESSION_REPLAY)
+   {
+      /* Lists scroll by the screen's height, so the replay needs the */
+      /* same one for the same keys to land on the same rows          */
+      session_expect('W');
+      if (fscanf(session.p_file, "%d %d", &lines, &columns) != 2)
+         session_fail("A screen size could not be read");
+      resizeterm(lines, columns);
+   }
+
    return;
 }
 
 /**********************************************************************/
-/*                  Clear the data in game file                       */
+/*     Save the lists in use, or load the ones saved, for a replay    */
 /**********************************************************************/
-void clear_game_file()
+void session_roster(ROSTER *p_roster)
 {
-   FILE *p_game_file;  /* Pointer to game file                       */
-   
-   /* Open file in write mode (truncates/empties the file)            */
-   p_game_file = fopen(GAME_FILE, "w");
-   fclose(p_game_file);
-   
+   char found; /* Kind of entry after the lists                       */
+
+   if (session.mode == SESSION_RECORD)
+   {
+      /* Saved just like the game file                                */
+      fprintf(session.p_file, "R ");
+      write_lists(session.p_file, p_roster);
+
+      /* Extra columns follow only when the sheet has them, so older  */
+      /* recordings still replay                                      */
+      if (p_roster->attributes.count > 0)
+      {
+         fprintf(session.p_file, "A\n");
+         write_attributes(session.p_file, p_roster->game_list,
+                          p_roster->amount_of_games,
+                          &p_roster->attributes);
+      }
+      fflush(session.p_file);
+   }
+   else if (session.mode == SESSION_REPLAY)
+   {
+      session_expect('R');
+      free_roster(p_roster);
+      memset(p_roster, 0, sizeof(*p_roster));
+      if (!read_lists(session.p_file, p_roster))
+         session_fail("The game list could not be read");
+      if (fscanf(session.p_file, " %c", &found) == 1)
+      {
+         if (found != 'A')
+            ungetc(found, session.p_file);
+         else if (!read_attributes(session.p_file, p_roster->game_list,
+                                   p_roster->amount_of_games,
+                                   &p_roster->attributes))
+            session_fail("The extra columns could not be read");
+      }
+      hash_roster(p_roster);
+      build_postings(p_roster);
+      build_search_index(&p_roster->game_index,
+                         (const char *) p_roster->game_list +
+                            offsetof(GAME, game_name),
+                         sizeof(GAME), p_roster->amount_of_games,
+                         MAX_GAME_NAME);
+      build_search_index(&p_roster->player_index,
+                         (const char *) p_roster->player_list +
+                            offsetof(PLAYER, player_name),
+                         sizeof(PLAYER), p_roster->amount_of_players,
+                         MAX_PLAYER_NAME);
+   }
+
    return;
 }
 
 /**********************************************************************/
-/*                    Initializes ncurses settings                    */
+/*              Seed for a spin, saved or played back                 */
 /**********************************************************************/
-void ncurses_setup()
+unsigned int session_seed()
 {
-    /* Initializes ncurses mode and settings                          */
-    initscr();
-    cbreak();
-    noecho();
-    keypad(stdscr, TRUE);
-    curs_set(0);
+   unsigned int seed = (unsigned int) time(NULL); /* Seed of the spin */
 
-    /* Configures color pairs if terminal supports colors             */
-    if (has_colors())
-    {
-        start_color();
+   if (session.mode == SESSION_RECORD)
+   {
+      fprintf(session.p_file, "S %u\n", seed);
+      fflush(session.p_file);
+   }
+   else if (session.mode == SESSION_REPLAY)
+   {
+      session_expect('S');
+      if (fscanf(session.p_file, "%u", &seed) != 1)
+         session_fail("A seed could not be read");
+   }
 
-        /* Checks if terminal supports custom color definitions       */
-        if (can_change_color())
-        {
-            /* Defines custom orange color (color index 8)             */
-            /* RGB values are 0-1000 in ncurses                        */
-            init_color(8, 1000, 647, 0);  
-        }
+   return seed;
+}
 
-        /* Defines color pairs for UI elements                         */
-        init_pair(CP_BG,           COLOR_WHITE,  COLOR_BLACK);
-        init_pair(CP_HEADER,       8,            COLOR_BLACK);
-        init_pair(CP_NORMAL,       COLOR_WHITE,  COLOR_BLACK);
-        init_pair(CP_A,            COLOR_GREEN,  COLOR_BLACK);
-        init_pair(CP_B,            COLOR_BLUE,   COLOR_BLACK);
-        init_pair(CP_C,            COLOR_WHITE,  COLOR_BLACK);
-        init_pair(CP_D,            COLOR_YELLOW, COLOR_BLACK);
-        init_pair(CP_F,            COLOR_RED,    COLOR_BLACK);
-        init_pair(CP_BORDER,       COLOR_WHITE,  COLOR_BLACK);
-        init_pair(CP_FOOTER,       COLOR_WHITE,  COLOR_BLACK);
-        init_pair(CP_DANGER,       COLOR_WHITE,  COLOR_RED);
-        init_pair(CP_TITLE,        COLOR_WHITE,  COLOR_BLUE);
-        init_pair(CP_HIGHLIGHT_BG, COLOR_WHITE,  8);
-        init_pair(CP_SCROLL,       8,            COLOR_BLACK);
-    }
+/**********************************************************************/
+/*                 Save a key press, for a replay                     */
+/**********************************************************************/
+int session_key(int key)
+{
+   if (session.mode == SESSION_RECORD)
+   {
+      if (key == KEY_RESIZE)
+         session_screen();
+      fprintf(session.p_file, "K %d\n", key);
+      fflush(session.p_file);
+   }
 
-    /* Sets background color and refreshes screen                     */
-    bkgd(COLOR_PAIR(CP_BG));
-    refresh();
+   return key;
 }
 
 /**********************************************************************/
-/*                      Check the terminal size                       */
+/*                    Next key press of a replay                      */
 /**********************************************************************/
-void check_term_size()
+int session_replay_key()
 {
-   
-   int term_rows,                  /* Terminal rows                   */
-       term_cols;                  /* Terminal columns                */
-   /* Check minimum terminal size - should pass now!                  */
-   getmaxyx(stdscr, term_rows, term_cols);
-   
-   if (term_cols < 50 || term_rows < 50)
+   char found; /* Kind of entry read                                  */
+   int  key;   /* Key pressed in the recording                        */
+
+   /* A resize comes with the size the screen was changed to          */
+   if (fscanf(session.p_file, " %c", &found) != 1)
+      session_fail("The recording ended early");
+   if (found == 'W')
    {
-      clear();
-      mvprintw(5, 0, "========================================================");
-      mvprintw(6, 0, "            ERROR: Terminal Wrong Size");
-      mvprintw(7, 0, "========================================================");
-      mvprintw(9, 0,  "Current size: %d columns x %d rows", term_cols, term_rows);
-      mvprintw(10, 0, "Required:     50 columns x 45 rows (minimum)");
-      mvprintw(12, 0, "The window should have auto-resized.");
-      mvprintw(13, 0, "If you see this message, please report the issue.");
-      mvprintw(15, 0, "Press any key to continue anyway...");
-      mvprintw(16, 0, "========================================================");
-      refresh();
-      getch();
-      clear_screen();
+      ungetc('W', session.p_file);
+      session_screen();
+      session_expect('K');
    }
+   else if (found != 'K')
+      session_fail("The replay went off course");
+   if (fscanf(session.p_file, "%d", &key) != 1)
+      session_fail("A key could not be read");
+
+   return key;
 }
 
 /**********************************************************************/
-/*             Handles keyboard input for menu navigation             */
+/*        Save the games resting, or play back the ones saved         */
 /**********************************************************************/
-int get_menu_input(int *highlighted_choice, int option_count)
+void session_recent_picks(RECENT_PICKS *p_recent)
 {
-    int key;    /* Key pressed by user                                */
+   int slot,       /* Count through the hash slots                    */
+       game_count; /* Games resting                                   */
+   unsigned long long game; /* Hash of a resting game                 */
 
-    /* Gets keyboard input                                             */
-    key = getch();
+   /* The journal keeps growing, so a replay uses the games that were */
+   /* resting when it was recorded instead of asking it again         */
+   if (session.mode == SESSION_RECORD)
+   {
+      for (game_count = 0, slot = 0; slot < COOLDOWN_SLOTS; slot++)
+         if (p_recent->games[slot] != 0)
+            game_count++;
+      fprintf(session.p_file, "C %d %d", p_recent->session_count,
+              game_count);
+      for (slot = 0; slot < COOLDOWN_SLOTS; slot++)
+         if (p_recent->games[slot] != 0)
+            fprintf(session.p_file, " %llx", p_recent->games[slot]);
+      fprintf(session.p_file, "\n");
+      fflush(session.p_file);
+   }
+   else if (session.mode == SESSION_REPLAY)
+   {
+      session_expect('C');
+      memset(p_recent, 0, sizeof(*p_recent));
+      if (fscanf(session.p_file, "%d %d", &p_recent->session_count,
+                 &game_count) != 2 ||
+          game_count < 0 || game_count > MAX_COOLDOWN)
+         session_fail("The resting games could not be read");
+      while (game_count-- > 0)
+      {
+         if (fscanf(session.p_file, "%llx", &game) != 1 || game == 0)
+            session_fail("The resting games could not be read");
+         for (slot = (int) (game & (COOLDOWN_SLOTS - 1));
+              p_recent->games[slot] != 0;
+              slot = (slot + 1) & (COOLDOWN_SLOTS - 1))
+            ;
+         p_recent->games[slot] = game;
+      }
+   }
 
-    /* Processes navigation keys                                       */
-    switch (key)
-    {
-        case KEY_LEFT:
-            *highlighted_choice = (*highlighted_choice - 1 + option_count) 
-                                  % option_count;
-            break;
-        case KEY_RIGHT:
-            *highlighted_choice = (*highlighted_choice + 1) % option_count;
-            break;
-        case '\n':
-            return key;
-    }
+   return;
+}
 
-    return key;
+/**********************************************************************/
+/*                  Save or check a game picked                       */
+/**********************************************************************/
+void session_pick(const char *p_game_name)
+{
+   char name_format[FORMAT_LEN], /* Reads a game name safely          */
+        game_name[MAX_GAME_NAME];/* Game the recording picked         */
+
+   if (session.mode == SESSION_RECORD)
+   {
+      fprintf(session.p_file, "P %s\n", p_game_name);
+      fflush(session.p_file);
+   }
+   else if (session.mode == SESSION_REPLAY)
+   {
+      session_expect('P');
+      snprintf(name_format, sizeof(name_format), "%%%ds",
+               MAX_GAME_NAME - 1);
+      if (fscanf(session.p_file, name_format, game_name) != 1)
+         session_fail("A pick could not be read");
+
+      /* The screen is going nowhere, so differences go to stderr     */
+      if (strcmp(game_name, p_game_name) != 0)
+      {
+         fprintf(stderr, "Pick %d: recorded %s, replayed %s\n",
+                 session.pick_count + 1, game_name, p_game_name);
+         session.mismatch_count++;
+      }
+   }
+   session.pick_count++;
+
+   return;
 }
\ No newline at end of file